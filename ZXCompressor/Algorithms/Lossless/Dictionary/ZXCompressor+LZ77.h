@@ -23,6 +23,7 @@
 //
 
 #import "ZXCompressor.h"
+#import "ZXCDictionary.h"
 
 /**
  ZXCompressor (LZ77)
@@ -35,13 +36,15 @@
  @param windowSize The sliding window size, affect the 'offset' size in bytes and matching speed,
  eg. 256(window size) -> 1 byte (offset size), 4096(window size) -> 2 bytes (offset size)
  @param bufferSize The lookAheadBuffer size, affect the 'length' size in bytes and matching speed.
+ @param dictionary The pre-trained dictionary, primes the sliding window, nil for none
  @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
  @param writeBuffer The output block
  @param completion The completion block
  */
 + (void)compressUsingLZ77:(const unsigned int)windowSize
                bufferSize:(const unsigned int)bufferSize
-               readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+               dictionary:(ZXCDictionary *)dictionary
+               readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
               writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
                completion:(void (^)(void))completion;
 
@@ -51,14 +54,16 @@
  @param windowSize The sliding window size, affect the 'offset' size in bytes and matching speed,
  eg. 256(window size) -> 1 byte (offset size), 4096(window size) -> 2 bytes (offset size)
  @param bufferSize The lookAheadBuffer size, affect the 'length' size in bytes and matching speed.
+ @param dictionary The pre-trained dictionary, primes the sliding window, nil for none
  @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
  @param writeBuffer The output block,
- @param completion The completion block
+ @param completion The completion block, error is kZXCErrorNone if succeeded
  */
 + (void)decompressUsingLZ77:(const unsigned int)windowSize
                  bufferSize:(const unsigned int)bufferSize
-                 readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                 dictionary:(ZXCDictionary *)dictionary
+                 readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                 writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
-                 completion:(void (^)(void))completion;
+                 completion:(void (^)(ZXCError error))completion;
 
 @end
@@ -29,7 +29,8 @@
 
 + (void)compressUsingLZ77:(const unsigned int)windowSize
                bufferSize:(const unsigned int)bufferSize
-               readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+               dictionary:(ZXCDictionary *)dictionary
+               readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
               writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
                completion:(void (^)(void))completion {
     // 偏移字节数, 根据滑动窗口的大小(windowSize)决定
@@ -45,20 +46,25 @@
     unsigned char *buffer = malloc(bufferSize);
     unsigned char *phrase = malloc(phraseSize);
     memset(window, 0, windowSize);
+    // 预置字典: 字典末尾的内容放在滑动窗口的末尾
+    unsigned int primed = (unsigned int)MIN(dictionary.data.length, windowSize);
+    if (primed > 0) {
+        memcpy(&window[windowSize - primed], (const unsigned char *)dictionary.data.bytes + dictionary.data.length - primed, primed);
+    }
     memset(buffer, 0, bufferSize);
     memset(phrase, 0, phraseSize);
     // 开始处理数据
     unsigned char symbol;
     unsigned int offset, length;
     unsigned int offset_n, length_n; // 网络字节序
-    for (unsigned int cursor = 0; ; ) {
+    for (unsigned long long cursor = 0; ; ) {
         // 填充前向缓冲区
         unsigned int bufSize = readBuffer ? readBuffer(buffer, bufferSize, cursor) : 0;
         if (bufSize == 0) {
             break;
         }
         // 查找短语
-        offset = windowSize > cursor ? windowSize - cursor : 0;
+        offset = windowSize > cursor + primed ? (unsigned int)(windowSize - cursor - primed) : 0;
         unsigned int winSize = windowSize - offset;
         symbol = search_bytes(&window[offset], winSize, buffer, bufSize, &offset, &length);
         // 转换偏移量相对于前向缓冲区反向
@@ -100,9 +106,10 @@
 
 + (void)decompressUsingLZ77:(const unsigned int)windowSize
                  bufferSize:(const unsigned int)bufferSize
-                 readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                 dictionary:(ZXCDictionary *)dictionary
+                 readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                 writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
-                 completion:(void (^)(void))completion {
+                 completion:(void (^)(ZXCError error))completion {
     // 偏移字节数, 根据滑动窗口的大小(windowSize)决定
     unsigned int offsetSize = size_in_bytes(windowSize);
     // 长度字节数, 根据前向缓冲区的大小(bufferSize)决定
@@ -116,16 +123,26 @@
     unsigned char *buffer = malloc(bufferSize);
     unsigned char *phrase = malloc(phraseSize);
     memset(window, 0, windowSize);
+    // 预置字典: 字典末尾的内容放在滑动窗口的末尾
+    unsigned int primed = (unsigned int)MIN(dictionary.data.length, windowSize);
+    if (primed > 0) {
+        memcpy(&window[windowSize - primed], (const unsigned char *)dictionary.data.bytes + dictionary.data.length - primed, primed);
+    }
     memset(buffer, 0, bufferSize);
     memset(phrase, 0, phraseSize);
     // 开始处理数据
     unsigned char symbol;
     unsigned int offset, length;
     unsigned int offset_n, length_n; // 网络字节序
-    for (unsigned int cursor = 0; ; cursor += phraseSize) {
+    ZXCError error = kZXCErrorNone;
+    for (unsigned long long cursor = 0; ; cursor += phraseSize) {
         // 读取短语
         unsigned int bufSize = readBuffer ? readBuffer(phrase, phraseSize, cursor) : 0;
         if (bufSize != phraseSize) {
+            // 不完整的短语
+            if (bufSize > 0) {
+                error = kZXCErrorTruncated;
+            }
             break;
         }
         // 重置
@@ -139,6 +156,12 @@
         // 主机字节序
         network_to_host_byte_order(&offset, &offset_n, offsetSize);
         network_to_host_byte_order(&length, &length_n, lengthSize);
+        // 校验短语: 偏移量须在 [length, windowSize) 内, 长度+符号不超出前向缓冲区
+        // 条件按位合并为一个几乎不会发生的分支, 保持正常路径的分支预测
+        if (unlikely((length > 0) & ((offset - 1 >= windowSize - 1) | (length > offset) | (length + symbolSize > bufferSize)))) {
+            error = kZXCErrorCorrupted;
+            break;
+        }
         // 复制短语到缓冲区
         memset(buffer, 0, bufferSize);
         if (length > 0) {
@@ -166,7 +189,7 @@
     free(window);
     // 完成
     if (completion) {
-        completion();
+        completion(error);
     }
 }
 
@@ -23,6 +23,7 @@
 //
 
 #import "ZXCompressor.h"
+#import "ZXCDictionary.h"
 
 /**
  ZXCompressor (LZ78)
@@ -30,29 +31,127 @@
 @interface ZXCompressor (LZ78)
 
 /**
- Compress the data/file using by LZ78 algorithm
+ Compress the data/file using by LZ78 algorithm, the full code dictionary is cleared (kZXCDictionaryPolicyReset)
  
  @param tableSize The code dictionary size
+ @param dictionary The pre-trained dictionary, primes the code dictionary, nil for none
  @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
  @param writeBuffer The output block
  @param completion The completion block
  */
 + (void)compressUsingLZ78:(const unsigned int)tableSize
-               readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+               dictionary:(ZXCDictionary *)dictionary
+               readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
               writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
                completion:(void (^)(void))completion;
 
 /**
- Decompress the data/file using by LZ78 algorithm
+ Decompress the data/file using by LZ78 algorithm, the full code dictionary is cleared (kZXCDictionaryPolicyReset)
  
  @param tableSize The code dictionary size
+ @param dictionary The pre-trained dictionary, primes the code dictionary, nil for none
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block
+ @param completion The completion block, error is kZXCErrorNone if succeeded
+ */
++ (void)decompressUsingLZ78:(const unsigned int)tableSize
+                 dictionary:(ZXCDictionary *)dictionary
+                 readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+                writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                 completion:(void (^)(ZXCError error))completion;
+
+/**
+ Compress the data/file using by LZ78 algorithm with a policy for the full code dictionary
+ The code dictionary has a fixed capacity, clearing it allocates and rebuilds nothing
+ 
+ @param tableSize The code dictionary size
+ @param dictionary The pre-trained dictionary, primes the code dictionary, nil for none
+ @param policy What to do when the code dictionary is full, the decompressor must use the same policy, see ZXCDictionaryPolicy
  @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
  @param writeBuffer The output block
  @param completion The completion block
  */
++ (void)compressUsingLZ78:(const unsigned int)tableSize
+               dictionary:(ZXCDictionary *)dictionary
+                   policy:(ZXCDictionaryPolicy)policy
+               readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+              writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+               completion:(void (^)(void))completion;
+
+/**
+ Decompress the data/file using by LZ78 algorithm with a policy for the full code dictionary
+ 
+ @param tableSize The code dictionary size
+ @param dictionary The pre-trained dictionary, primes the code dictionary, nil for none
+ @param policy The policy used by the compressor
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block
+ @param completion The completion block, error is kZXCErrorNone if succeeded
+ */
 + (void)decompressUsingLZ78:(const unsigned int)tableSize
-                 readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                 dictionary:(ZXCDictionary *)dictionary
+                     policy:(ZXCDictionaryPolicy)policy
+                 readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                 writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
-                 completion:(void (^)(void))completion;
+                 completion:(void (^)(ZXCError error))completion;
+
+/**
+ Compress the data/file using by LZ78 algorithm in segments coded in parallel, see ZXCompressor (Segment)
+ Every segment starts from a fresh (or pre-trained) dictionary, a little lower ratio than one stream,
+ the full dictionary is kept until the compression ratio drops (kZXCDictionaryPolicyMonitor)
+ 
+ @param tableSize The code dictionary size
+ @param dictionary The pre-trained dictionary, primes the code dictionary of every segment, nil for none
+ @param segmentSize The uncompressed size of a segment, in [4 KB, 256 MB], 0 for the default (1 MB)
+ @param threads The segments compressed at the same time, 0 for the active processors
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block
+ @param completion The completion block, error is kZXCErrorNone if succeeded
+ */
++ (void)compressUsingLZ78:(const unsigned int)tableSize
+               dictionary:(ZXCDictionary *)dictionary
+              segmentSize:(const unsigned int)segmentSize
+                  threads:(const unsigned int)threads
+               readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+              writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+               completion:(void (^)(ZXCError error))completion;
+
+/**
+ Decompress the data/file made by compressUsingLZ78:dictionary:segmentSize:threads:readBuffer:writeBuffer:completion:
+ 
+ @param tableSize The code dictionary size
+ @param dictionary The pre-trained dictionary, primes the code dictionary of every segment, nil for none
+ @param threads The segments decompressed at the same time, 0 for the active processors
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block
+ @param completion The completion block, error is kZXCErrorNone if succeeded
+ */
++ (void)decompressUsingLZ78:(const unsigned int)tableSize
+                 dictionary:(ZXCDictionary *)dictionary
+                    threads:(const unsigned int)threads
+                 readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+                writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                 completion:(void (^)(ZXCError error))completion;
+
+/**
+ Build the LZ78 code table (string -> code) primed with the dictionary content,
+ the phrases of the content fill at most half of the table
+
+ @param tableSize The code dictionary size
+ @param dictionary The dictionary content
+ @return The code table, free it by hashtable_free()
+ */
++ (struct hash_table *)tableUsingLZ78:(const unsigned int)tableSize dictionary:(NSData *)dictionary;
+
+/**
+ Build the LZ78 code dictionary: the empty string (code 0) and the phrases of the dictionary content, sealed,
+ ZXCDictionary keeps one per table size and policy, the coders copy it (code_table_copy)
+
+ @param tableSize The code dictionary size
+ @param dictionary The pre-trained dictionary, nil for the empty string (code 0) only
+ @param policy What to do when the code dictionary is full
+ @return The code dictionary, free it by code_table_free()
+ */
++ (struct code_table *)codeTableUsingLZ78:(const unsigned int)tableSize dictionary:(ZXCDictionary *)dictionary policy:(ZXCDictionaryPolicy)policy;
 
 @end
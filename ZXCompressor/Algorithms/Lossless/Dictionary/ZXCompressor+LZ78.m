@@ -23,99 +23,107 @@
 //
 
 #import "ZXCompressor+LZ78.h"
+#import "ZXCompressor+Segment.h"
 #import "bitbyte.h"
+#import "hash.h"
 #import "hashtable.h"
+#import "codetable.h"
 
 @implementation ZXCompressor (LZ78)
 
+// 每次编码/解码的词典: 有预置字典时复制字典中建好的词典(memcpy), 不再逐个加入预置的编码
+static code_table * LZ78CodeTable(unsigned int tableSize, ZXCDictionary *dictionary, ZXCDictionaryPolicy policy) {
+    code_table *sealed = dictionary ? [dictionary codeTableForAlgorithm:kZXCAlgorithmLZ78 tableSize:tableSize policy:policy] : NULL;
+    return sealed ? code_table_copy(sealed) : [ZXCompressor codeTableUsingLZ78:tableSize dictionary:nil policy:policy];
+}
+
 + (void)compressUsingLZ78:(const unsigned int)tableSize
-               readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+               dictionary:(ZXCDictionary *)dictionary
+               readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+              writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+               completion:(void (^)(void))completion {
+    [self compressUsingLZ78:tableSize dictionary:dictionary policy:kZXCDictionaryPolicyReset readBuffer:readBuffer writeBuffer:writeBuffer completion:completion];
+}
+
++ (void)decompressUsingLZ78:(const unsigned int)tableSize
+                 dictionary:(ZXCDictionary *)dictionary
+                 readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+                writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                 completion:(void (^)(ZXCError error))completion {
+    [self decompressUsingLZ78:tableSize dictionary:dictionary policy:kZXCDictionaryPolicyReset readBuffer:readBuffer writeBuffer:writeBuffer completion:completion];
+}
+
++ (void)compressUsingLZ78:(const unsigned int)tableSize
+               dictionary:(ZXCDictionary *)dictionary
+                   policy:(ZXCDictionaryPolicy)policy
+               readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
               writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
                completion:(void (^)(void))completion {
     // 编码字节数, 根据词典的大小(tableSize)决定
     unsigned int codeSize = size_in_bytes(tableSize);
+    // 编码字节数能表示的编码上限, 超出的编码不使用
+    unsigned int codeLimit = codeSize < sizeof(unsigned int) ? 1U << (codeSize * 8) : CODE_TABLE_NONE;
     // 符号字节数
     unsigned int symbolSize = sizeof(unsigned char);
     // 短语字节数
     unsigned int phraseSize = codeSize + symbolSize;
-    // 前缀缓冲区大小(动态分配)
-    unsigned int prefixSize = 2;
-    // 前缀缓冲区+短语缓冲区
-    unsigned char *prefix = malloc(prefixSize);
+    // 短语缓冲区
     unsigned char *phrase = malloc(phraseSize);
-    memset(prefix, 0, prefixSize);
     memset(phrase, 0, phraseSize);
     // 符号缓冲区
     unsigned char symbol = 0;
-    // 前缀缓冲区当前长度
-    unsigned int length = 0; // for prefix
-    // 初始化字典
-    hashtable * table = hashtable_new(tableSize);
+    // 前缀的编码, 0 为空字符串, 前缀加一个符号查找一次, 不用保存前缀的字符串
+    unsigned int prefix = 0;
+    // 初始化词典(空字符串 + 预置字典)
+    code_table *table = LZ78CodeTable(tableSize, dictionary, policy);
     // 字典编码
     unsigned int code;
     unsigned int code_nbo = 0; // 网络字节序
-    unsigned int code_next = 1; // 下个编码
     // 开始处理数据
-    for (unsigned int offset = 0; ; offset++) {
+    for (unsigned long long offset = 0; ; offset++) {
         // 读入数据
         unsigned int read = readBuffer ? readBuffer(&symbol, symbolSize, offset) : 0;
         if (read == 0) {
             // 输出最后的编码
-            if (length > 0) {
+            if (prefix > 0) {
+                code_nbo = 0;
+                host_to_network_byte_order(&code_nbo, &prefix, codeSize);
                 if (writeBuffer) {
                     writeBuffer((unsigned char *)&code_nbo, codeSize);
                 }
             }
             break;
         }
-        // 扩展前缀缓冲区
-        if (length + symbolSize >= prefixSize) {
-            prefixSize *= 2;
-            prefix = realloc(prefix, prefixSize);
-        }
-        // 复制符号到前缀缓冲区，组成新的前缀
-        memcpy(&prefix[length++], &symbol, symbolSize);
         // 查找编码
-        code = 0;
-        hashnode * node = hashtable_get_node(table, prefix, length);
-        if (node) {
-            memcpy(&code, node->value->data, node->value->length);
-        }
-        // 找到编码
-        if (code > 0) {
-            // 网络字节序
-            code_nbo = 0;
-            host_to_network_byte_order(&code_nbo, &code, codeSize);
-            // 查找最长匹配
+        code = code_table_find(table, prefix, symbol);
+        // 找到编码, 查找最长匹配
+        if (code < codeLimit) {
+            prefix = code;
             continue;
-        } else if (table->used < table->size) {
-            // 没找到，加入词典
-            hashtable_set_node(table, prefix, length, &code_next, codeSize);
-            code_next++;
-        } else {
-            // 超出范围，清空词典
-            hashtable_free(table);
-            table = hashtable_new(tableSize);
-            code_next = 1;
         }
         // 设置编码
+        code_nbo = 0;
+        host_to_network_byte_order(&code_nbo, &prefix, codeSize);
         memcpy(&phrase[0], &code_nbo, codeSize);
         // 设置符号
         memcpy(&phrase[codeSize], &symbol, symbolSize);
-        // 重置编码
-        code_nbo = 0;
+        code_table_count(table, table->length[prefix] + symbolSize, phraseSize);
+        // 没找到，加入词典, 词典满了按策略清空
+        if (table->next < table->capacity) {
+            code_table_add(table, prefix, symbol);
+        } else if (code_table_full(table)) {
+            code_table_reset(table);
+        }
         // 重置前缀
-        memset(prefix, 0, prefixSize);
-        length = 0;
+        prefix = 0;
         // 输出短语
         if (writeBuffer) {
             writeBuffer(phrase, phraseSize);
         }
     }
     // 释放资源
-    hashtable_free(table);
+    code_table_free(table);
     free(phrase);
-    free(prefix);
     // 完成
     if (completion) {
         completion();
@@ -123,9 +131,11 @@
 }
 
 + (void)decompressUsingLZ78:(const unsigned int)tableSize
-                 readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                 dictionary:(ZXCDictionary *)dictionary
+                     policy:(ZXCDictionaryPolicy)policy
+                 readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                 writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
-                 completion:(void (^)(void))completion {
+                 completion:(void (^)(ZXCError error))completion {
     // 编码字节数, 根据词典的大小(tableSize)决定
     unsigned int codeSize = size_in_bytes(tableSize);
     // 符号字节数
@@ -138,22 +148,25 @@
     unsigned char *phrase = malloc(phraseSize);
     unsigned char *output = malloc(outputSize);
     memset(phrase, 0, phraseSize);
-    memset(output, 0, outputSize);
     // 符号缓冲区
     unsigned char symbol = 0;
     // 输出缓冲区当前长度
     unsigned int length = 0; // for output
-    // 初始化字典
-    hashtable * table = hashtable_new(tableSize);
+    // 初始化词典(空字符串 + 预置字典)
+    code_table *table = LZ78CodeTable(tableSize, dictionary, policy);
     // 字典编码
     unsigned int code;
     unsigned int code_nbo = 0; // 网络字节序
-    unsigned int code_next = 1; // 下个编码
+    ZXCError error = kZXCErrorNone;
     // 开始处理数据
-    for (unsigned int offset = 0; ; offset += phraseSize) {
+    for (unsigned long long offset = 0; ; offset += phraseSize) {
         // 读入数据
         unsigned int read = readBuffer ? readBuffer(phrase, phraseSize, offset) : 0;
         if (read < codeSize) {
+            // 不完整的编码
+            if (read > 0) {
+                error = kZXCErrorTruncated;
+            }
             break;
         }
         // 解析编码
@@ -164,36 +177,30 @@
         // 主机字节序
         code = 0;
         network_to_host_byte_order(&code, &code_nbo, codeSize);
-        // 重置输出缓冲区
-        memset(output, 0, outputSize);
-        length = 0;
-        // 查找编码
-        if (code > 0) {
-            hashnode * node = hashtable_get_node(table, &code, codeSize);
-            if (node) {
-                // 复制到解码区
-                memcpy(&output[length], node->value->data, node->value->length);
-                length += node->value->length;
-            }
+        // 校验编码: 须在词典中, 最后一个短语(只有编码)不能为空
+        if (unlikely((code >= table->next) | ((read < phraseSize) & (code == 0)))) {
+            error = kZXCErrorCorrupted;
+            break;
         }
-        // 扩展解码缓冲区
-        if (length + symbolSize >= outputSize) {
-            outputSize *= 2;
+        // 扩展解码缓冲区(预留符号)
+        length = table->length[code];
+        if (length + symbolSize > outputSize) {
+            outputSize = MAX(outputSize * 2, length + symbolSize);
             output = realloc(output, outputSize);
         }
-        // 复制符号
+        // 展开字符串
+        code_table_string(table, code, output);
         if (read == phraseSize) {
-            memcpy(&output[length++], &symbol, symbolSize);
-        }
-        // 加入词典
-        if (table->used < table->size) {
-            hashtable_set_node(table, &code_next, codeSize, output, length);
-            code_next++;
-        } else {
-            // 超出范围，清空词典
-            hashtable_free(table);
-            table = hashtable_new(tableSize);
-            code_next = 1;
+            // 复制符号
+            memcpy(&output[length], &symbol, symbolSize);
+            length += symbolSize;
+            code_table_count(table, length, phraseSize);
+            // 加入词典, 词典满了按策略清空
+            if (table->next < table->capacity) {
+                code_table_add(table, code, symbol);
+            } else if (code_table_full(table)) {
+                code_table_reset(table);
+            }
         }
         // 输出符号
         if (writeBuffer) {
@@ -205,13 +212,94 @@
         }
     }
     // 释放资源
-    hashtable_free(table);
+    code_table_free(table);
     free(output);
     free(phrase);
     // 完成
     if (completion) {
-        completion();
+        completion(error);
+    }
+}
+
++ (void)compressUsingLZ78:(const unsigned int)tableSize
+               dictionary:(ZXCDictionary *)dictionary
+              segmentSize:(const unsigned int)segmentSize
+                  threads:(const unsigned int)threads
+               readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+              writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+               completion:(void (^)(ZXCError error))completion {
+    // 每段独立编码, 词典满了按压缩率决定是否清空
+    [self compressSegmentsUsing:kZXCAlgorithmLZ78
+                    segmentSize:segmentSize
+                        threads:threads
+                     readBuffer:readBuffer
+                    writeBuffer:writeBuffer
+                          coder:^ZXCError(const unsigned int (^segmentRead)(void *, const unsigned int, const unsigned long long), void (^segmentWrite)(const void *, const unsigned int)) {
+                              [self compressUsingLZ78:tableSize dictionary:dictionary policy:kZXCDictionaryPolicyMonitor readBuffer:segmentRead writeBuffer:segmentWrite completion:nil];
+                              return kZXCErrorNone;
+                          } completion:completion];
+}
+
++ (void)decompressUsingLZ78:(const unsigned int)tableSize
+                 dictionary:(ZXCDictionary *)dictionary
+                    threads:(const unsigned int)threads
+                 readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+                writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                 completion:(void (^)(ZXCError error))completion {
+    // 每段独立解码
+    [self decompressSegmentsUsing:kZXCAlgorithmLZ78
+                          threads:threads
+                       readBuffer:readBuffer
+                      writeBuffer:writeBuffer
+                            coder:^ZXCError(const unsigned int (^segmentRead)(void *, const unsigned int, const unsigned long long), void (^segmentWrite)(const void *, const unsigned int)) {
+                                __block ZXCError error = kZXCErrorNone;
+                                [self decompressUsingLZ78:tableSize dictionary:dictionary policy:kZXCDictionaryPolicyMonitor readBuffer:segmentRead writeBuffer:segmentWrite completion:^(ZXCError errorCode) {
+                                    error = errorCode;
+                                }];
+                                return error;
+                            } completion:completion];
+}
+
++ (hashtable *)tableUsingLZ78:(const unsigned int)tableSize dictionary:(NSData *)dictionary {
+    // 编码字节数, 根据词典的大小(tableSize)决定
+    unsigned int codeSize = size_in_bytes(tableSize);
+    // 按编码的方式把字典内容加入词典, 最多占用一半, 其余留给待压缩的数据
+    hashtable *table = hashtable_new(tableSize);
+    const unsigned char *bytes = dictionary.bytes;
+    unsigned int prefixSize = 2;
+    unsigned char *prefix = malloc(prefixSize);
+    unsigned int length = 0;
+    unsigned int code_next = 1;
+    unsigned int prefixHash = 0;
+    for (NSUInteger i = 0; i < dictionary.length && table->used < table->size / 2; i++) {
+        // 扩展前缀缓冲区
+        if (length + 1 >= prefixSize) {
+            prefixSize *= 2;
+            prefix = realloc(prefix, prefixSize);
+        }
+        prefix[length++] = bytes[i];
+        prefixHash = hash_roll(prefixHash, bytes[i]);
+        if (hashtable_get_node_hash(table, prefix, length, prefixHash) == NULL) {
+            hashtable_set_node_hash(table, prefix, length, prefixHash, &code_next, codeSize);
+            code_next++;
+            length = 0;
+            prefixHash = 0;
+        }
+    }
+    free(prefix);
+    return table;
+}
+
+// 编码词典: 空字符串(编码 0), 预置字典的编码 1...used, 新的编码到 tableSize 为止, 固定容量, 清空时不重建
++ (code_table *)codeTableUsingLZ78:(const unsigned int)tableSize dictionary:(ZXCDictionary *)dictionary policy:(ZXCDictionaryPolicy)policy {
+    code_table *table = code_table_new(tableSize + 1, (code_table_policy)policy);
+    code_table_set(table, 0, CODE_TABLE_NONE, 0, 0);
+    hashtable *snapshot = dictionary ? [dictionary tableForAlgorithm:kZXCAlgorithmLZ78 tableSize:tableSize inverse:NO] : NULL;
+    if (snapshot) {
+        code_table_prime(table, snapshot, 0);
     }
+    code_table_seal(table, snapshot ? (unsigned int)snapshot->used + 1 : 1);
+    return table;
 }
 
 @end
@@ -0,0 +1,93 @@
+//
+// ZXCompressor+LZH.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#import "ZXCompressor.h"
+
+@interface ZXCompressor (LZH)
+
+/**
+ Compress the data/file using by LZSS + Huffman/FSE (two stages, deflate-class), the general-purpose mode
+ The LZSS matches of each block are split into the literal, literal run, match length and offset streams,
+ each stream is coded with its own Huffman or FSE table, the last Huffman table of the stream or stored raw, whichever is smaller,
+ the end of the stream carries the CRC-32C of the data
+ Each block is sampled (4 KB) before the match search, a block with few repeats skips the search and is coded as literals alone
+ (Huffman, FSE, one repeated byte or stored), so the incompressible and the skewed data are coded several times faster
+ 
+ @param blockSize The block size, 64 KB ~ 1 MB is recommended, the memory is bounded by it, in [kZXCBlockSizeMin, kZXCBlockSizeMax] (1 KB ~ 64 MB), nothing is written out of it
+ @param windowSize The sliding window size (max match offset + 1), rounded up to a power of two in [1 KB, 1 GB], written to the stream
+ The nearest 64 KB are searched with a hash chain, a larger window is searched for long repeats (64 bytes at least)
+ with a sampled rolling hash (long-distance matching), the compressor and decompressor hold the whole window in memory
+ @param depth The max candidates compared per match search, 4 ~ 64 is recommended, larger is slower and smaller
+ @param threads The threads searching the matches of a block, 0 for the active processors
+ The block is split into segments searched in parallel against the shared window, the output does not depend on it
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block
+ @param completion The completion block
+ */
++ (void)compressUsingLZH:(const unsigned int)blockSize
+              windowSize:(const unsigned int)windowSize
+                   depth:(const unsigned int)depth
+                 threads:(const unsigned int)threads
+              readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+             writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+              completion:(void (^)(void))completion;
+
+/**
+ Compress the data/file using by LZSS + Huffman/FSE with the parse of the matches,
+ see compressUsingLZH:windowSize:depth:threads:readBuffer:writeBuffer:completion: (the greedy parse)
+ 
+ @param blockSize The block size, 64 KB ~ 1 MB is recommended, the memory is bounded by it, in [kZXCBlockSizeMin, kZXCBlockSizeMax] (1 KB ~ 64 MB), nothing is written out of it
+ @param windowSize The sliding window size (max match offset + 1), rounded up to a power of two in [1 KB, 1 GB], written to the stream
+ @param depth The max candidates compared per match search, 4 ~ 64 is recommended, larger is slower and smaller
+ @param parse The parse, kZXCParseLazy is slower and smaller (about 2% on text and binaries), the decompressor does not depend on it
+ @param threads The threads searching the matches of a block, 0 for the active processors
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block
+ @param completion The completion block
+ */
++ (void)compressUsingLZH:(const unsigned int)blockSize
+              windowSize:(const unsigned int)windowSize
+                   depth:(const unsigned int)depth
+                   parse:(const ZXCParse)parse
+                 threads:(const unsigned int)threads
+              readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+             writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+              completion:(void (^)(void))completion;
+
+/**
+ Decompress the data/file using by LZSS + Huffman/FSE, the window size is read from the stream
+ 
+ @param blockSize The max block size, must be the same as the compressor, kZXCErrorCorrupted out of [kZXCBlockSizeMin, kZXCBlockSizeMax]
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block
+ @param completion The completion block, error is kZXCErrorNone if succeeded,
+ kZXCErrorChecksum if the data written does not match the checksum (checked at the end of the stream)
+ */
++ (void)decompressUsingLZH:(const unsigned int)blockSize
+                readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+               writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                completion:(void (^)(ZXCError error))completion;
+
+@end
@@ -0,0 +1,164 @@
+//
+// ZXCompressor+LZH.m
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#import "ZXCompressor+LZH.h"
+#import "lzh.h"
+
+@implementation ZXCompressor (LZH)
+
++ (void)compressUsingLZH:(const unsigned int)blockSize
+              windowSize:(const unsigned int)windowSize
+                   depth:(const unsigned int)depth
+                 threads:(const unsigned int)threads
+              readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+             writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+              completion:(void (^)(void))completion {
+    [self compressUsingLZH:blockSize windowSize:windowSize depth:depth parse:kZXCParseGreedy threads:threads readBuffer:readBuffer writeBuffer:writeBuffer completion:completion];
+}
+
++ (void)compressUsingLZH:(const unsigned int)blockSize
+              windowSize:(const unsigned int)windowSize
+                   depth:(const unsigned int)depth
+                   parse:(const ZXCParse)parse
+                 threads:(const unsigned int)threads
+              readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+             writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+              completion:(void (^)(void))completion {
+    // a block size out of range is rejected, nothing is written, so the decompressor reports the missing stream
+    if (blockSize < kZXCBlockSizeMin || blockSize > kZXCBlockSizeMax) {
+        if (completion) {
+            completion();
+        }
+        return;
+    }
+    // the window and the hash chains carry over between the blocks
+    unsigned int workers = threads > 0 ? threads : (unsigned int)[NSProcessInfo processInfo].activeProcessorCount;
+    lzh_encoder *encoder = lzh_encoder_new(blockSize, windowSize, depth, parse == kZXCParseLazy ? LZH_PARSE_LAZY : LZH_PARSE_GREEDY, workers);
+    // header, end block
+    unsigned char header[LZH_END_SIZE];
+    // output block
+    const unsigned char *output;
+    // read length in bytes
+    unsigned int readed;
+    // output length in bytes
+    unsigned int length;
+    // format + window log
+    length = lzh_encoder_header(encoder, header);
+    if (writeBuffer) {
+        writeBuffer(header, length);
+    }
+    for (unsigned long long offset = 0; ; offset += readed) {
+        readed = readBuffer ? readBuffer(lzh_encoder_buffer(encoder), blockSize, offset) : 0;
+        if (readed == 0) {
+            break;
+        }
+        length = lzh_encoder_compress(encoder, readed, &output);
+        if (writeBuffer) {
+            writeBuffer(output, length);
+        }
+        if (readed < blockSize) {
+            break;
+        }
+    }
+    // end of stream
+    length = lzh_encoder_end(encoder, header);
+    if (writeBuffer) {
+        writeBuffer(header, length);
+    }
+    // free
+    lzh_encoder_free(encoder);
+    // completion
+    if (completion) {
+        completion();
+    }
+}
+
++ (void)decompressUsingLZH:(const unsigned int)blockSize
+                readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+               writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                completion:(void (^)(ZXCError error))completion {
+    // no stream is made with a block size out of range
+    if (blockSize < kZXCBlockSizeMin || blockSize > kZXCBlockSizeMax) {
+        if (completion) {
+            completion(kZXCErrorCorrupted);
+        }
+        return;
+    }
+    lzh_decoder *decoder = lzh_decoder_new(blockSize);
+    // the next unit: the header or a block
+    unsigned char *input = malloc(lzh_block_bound(blockSize));
+    // input offset in bytes
+    unsigned long long offset = 0;
+    // decoded block
+    const unsigned char *output;
+    // temp
+    unsigned int available, need, readed, length;
+    // error
+    ZXCError error = kZXCErrorNone;
+    for (;;) {
+        // read the unit as its length is known: type, origin length, payload length, payload
+        available = 0;
+        while ((need = lzh_decoder_need(decoder, input, available)) > available) {
+            readed = readBuffer ? readBuffer(&input[available], need - available, offset) : 0;
+            offset += readed;
+            available += readed;
+            if (readed == 0) {
+                break;
+            }
+        }
+        if (need == 0) {
+            error = kZXCErrorCorrupted;
+            break;
+        }
+        if (available < need) {
+            error = kZXCErrorTruncated;
+            break;
+        }
+        lzh_status status = lzh_decoder_decode(decoder, input, available, &output, &length);
+        if (status == LZH_STATUS_CORRUPTED) {
+            error = kZXCErrorCorrupted;
+            break;
+        }
+        if (status == LZH_STATUS_CHECKSUM) {
+            error = kZXCErrorChecksum;
+            break;
+        }
+        if (status == LZH_STATUS_END) {
+            break;
+        }
+        if (status == LZH_STATUS_BLOCK && writeBuffer) {
+            writeBuffer(output, length);
+        }
+    }
+    // free
+    free(input);
+    lzh_decoder_free(decoder);
+    // completion
+    if (completion) {
+        completion(error);
+    }
+}
+
+@end
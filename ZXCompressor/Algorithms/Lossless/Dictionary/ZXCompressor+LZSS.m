@@ -29,7 +29,8 @@
 
 + (void)compressUsingLZSS:(const unsigned int)windowSize
                bufferSize:(const unsigned int)bufferSize
-               readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+               dictionary:(ZXCDictionary *)dictionary
+               readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
               writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
                completion:(void (^)(void))completion {
     // 标记字节数
@@ -47,6 +48,11 @@
     unsigned char *buffer = malloc(bufferSize);
     unsigned char *phrase = malloc(phraseSize);
     memset(window, 0, windowSize);
+    // 预置字典: 字典末尾的内容放在滑动窗口的末尾
+    unsigned int primed = (unsigned int)MIN(dictionary.data.length, windowSize);
+    if (primed > 0) {
+        memcpy(&window[windowSize - primed], (const unsigned char *)dictionary.data.bytes + dictionary.data.length - primed, primed);
+    }
     memset(buffer, 0, bufferSize);
     memset(phrase, 0, phraseSize);
     // 开始处理数据
@@ -54,7 +60,7 @@
     unsigned int offset, length;
     unsigned int offset_n, length_n; // 网络字节序
     unsigned int phraseCursor = flagsSize;
-    for (unsigned int cursor = 0; ;) {
+    for (unsigned long long cursor = 0; ;) {
         // 填充前向缓冲区
         unsigned int bufSize = readBuffer ? readBuffer(buffer, bufferSize, cursor) : 0;
         if (bufSize == 0) {
@@ -67,7 +73,7 @@
             break;
         }
         // 查找短语
-        unsigned int winCursor = windowSize > cursor ? windowSize - cursor : 0;
+        unsigned int winCursor = windowSize > cursor + primed ? (unsigned int)(windowSize - cursor - primed) : 0;
         unsigned int winSize = windowSize - winCursor;
         search_bytes(&window[winCursor], winSize, buffer, bufSize, &offset, &length);
         // 设置短语数据
@@ -121,9 +127,10 @@
 
 + (void)decompressUsingLZSS:(const unsigned int)windowSize
                  bufferSize:(const unsigned int)bufferSize
-                 readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                 dictionary:(ZXCDictionary *)dictionary
+                 readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                 writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
-                 completion:(void (^)(void))completion {
+                 completion:(void (^)(ZXCError error))completion {
     // 标记字节数
     unsigned int flagsSize = sizeof(unsigned char);
     // 偏移字节数, 根据滑动窗口的大小(windowSize)决定
@@ -139,6 +146,11 @@
     unsigned char *buffer = malloc(bufferSize);
     unsigned char *phrase = malloc(phraseSize);
     memset(window, 0, windowSize);
+    // 预置字典: 字典末尾的内容放在滑动窗口的末尾
+    unsigned int primed = (unsigned int)MIN(dictionary.data.length, windowSize);
+    if (primed > 0) {
+        memcpy(&window[windowSize - primed], (const unsigned char *)dictionary.data.bytes + dictionary.data.length - primed, primed);
+    }
     memset(buffer, 0, bufferSize);
     memset(phrase, 0, phraseSize);
     // 开始处理数据
@@ -146,7 +158,8 @@
     unsigned int offset, length;
     unsigned int offset_n, length_n; // 网络字节序
     unsigned int phraseCursor, phraseLength;
-    for (unsigned int cursor = 0; ; ) {
+    ZXCError error = kZXCErrorNone;
+    for (unsigned long long cursor = 0; error == kZXCErrorNone; ) {
         // 复制短语
         phraseLength = readBuffer ? readBuffer(phrase, phraseSize, cursor) : 0;
         if (phraseLength < 1) {
@@ -168,6 +181,11 @@
                 phraseCursor += symbolSize;
                 length = symbolSize;
             } else {
+                // 不完整的短语
+                if (unlikely(phraseCursor + offsetSize + lengthSize > phraseLength)) {
+                    error = kZXCErrorTruncated;
+                    break;
+                }
                 // 重置
                 offset = length = 0;
                 offset_n = length_n = 0;
@@ -180,6 +198,12 @@
                 // 主机字节序
                 network_to_host_byte_order(&offset, &offset_n, offsetSize);
                 network_to_host_byte_order(&length, &length_n, lengthSize);
+                // 校验短语: 偏移量须在 [length, windowSize) 内, 长度须在 [1, bufferSize] 内
+                // 条件按位合并为一个几乎不会发生的分支, 保持正常路径的分支预测
+                if (unlikely((offset - 1 >= windowSize - 1) | (length > offset) | (length - 1 >= bufferSize))) {
+                    error = kZXCErrorCorrupted;
+                    break;
+                }
                 // 转换偏移量相对于滑动窗口正向
                 offset = windowSize - offset;
                 // 从滑动窗口复制数据到缓冲区
@@ -207,7 +231,7 @@
     free(window);
     // 完成
     if (completion) {
-        completion();
+        completion(error);
     }
 }
 
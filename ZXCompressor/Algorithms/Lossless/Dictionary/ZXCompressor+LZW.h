@@ -23,33 +23,132 @@
 //
 
 #import "ZXCompressor.h"
+#import "ZXCDictionary.h"
 
 @interface ZXCompressor (LZW)
 
 /**
- Compress the data/file using by LZW algorithm
+ Compress the data/file using by LZW algorithm, the full code dictionary is cleared (kZXCDictionaryPolicyReset)
  
  @param dictionarySize The code dictionary size
+ @param dictionary The pre-trained dictionary, primes the code dictionary, nil for none
  @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
  @param writeBuffer The output block
  @param completion The completion block
  */
 + (void)compressUsingLZW:(const unsigned int)dictionarySize
-              readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+              dictionary:(ZXCDictionary *)dictionary
+              readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
              writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
               completion:(void (^)(void))completion;
 
 /**
- Decompress the data/file using by LZW algorithm
+ Decompress the data/file using by LZW algorithm, the full code dictionary is cleared (kZXCDictionaryPolicyReset)
  
  @param dictionarySize The code dictionary size
+ @param dictionary The pre-trained dictionary, primes the code dictionary, nil for none
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block
+ @param completion The completion block, error is kZXCErrorNone if succeeded
+ */
++ (void)decompressUsingLZW:(const unsigned int)dictionarySize
+                dictionary:(ZXCDictionary *)dictionary
+                readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+               writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                completion:(void (^)(ZXCError error))completion;
+
+/**
+ Compress the data/file using by LZW algorithm with a policy for the full code dictionary
+ The code dictionary has a fixed capacity, clearing it allocates and rebuilds nothing
+ 
+ @param dictionarySize The code dictionary size
+ @param dictionary The pre-trained dictionary, primes the code dictionary, nil for none
+ @param policy What to do when the code dictionary is full, the decompressor must use the same policy, see ZXCDictionaryPolicy
  @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
  @param writeBuffer The output block
  @param completion The completion block
  */
++ (void)compressUsingLZW:(const unsigned int)dictionarySize
+              dictionary:(ZXCDictionary *)dictionary
+                  policy:(ZXCDictionaryPolicy)policy
+              readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+             writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+              completion:(void (^)(void))completion;
+
+/**
+ Decompress the data/file using by LZW algorithm with a policy for the full code dictionary
+ 
+ @param dictionarySize The code dictionary size
+ @param dictionary The pre-trained dictionary, primes the code dictionary, nil for none
+ @param policy The policy used by the compressor
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block
+ @param completion The completion block, error is kZXCErrorNone if succeeded
+ */
++ (void)decompressUsingLZW:(const unsigned int)dictionarySize
+                dictionary:(ZXCDictionary *)dictionary
+                    policy:(ZXCDictionaryPolicy)policy
+                readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+               writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                completion:(void (^)(ZXCError error))completion;
+
+/**
+ Compress the data/file using by LZW algorithm in segments coded in parallel, see ZXCompressor (Segment)
+ Every segment starts from a fresh (or pre-trained) dictionary, a little lower ratio than one stream,
+ the full dictionary is kept until the compression ratio drops (kZXCDictionaryPolicyMonitor)
+ 
+ @param dictionarySize The code dictionary size
+ @param dictionary The pre-trained dictionary, primes the code dictionary of every segment, nil for none
+ @param segmentSize The uncompressed size of a segment, in [4 KB, 256 MB], 0 for the default (1 MB)
+ @param threads The segments compressed at the same time, 0 for the active processors
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block
+ @param completion The completion block, error is kZXCErrorNone if succeeded
+ */
++ (void)compressUsingLZW:(const unsigned int)dictionarySize
+              dictionary:(ZXCDictionary *)dictionary
+             segmentSize:(const unsigned int)segmentSize
+                 threads:(const unsigned int)threads
+              readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+             writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+              completion:(void (^)(ZXCError error))completion;
+
+/**
+ Decompress the data/file made by compressUsingLZW:dictionary:segmentSize:threads:readBuffer:writeBuffer:completion:
+ 
+ @param dictionarySize The code dictionary size
+ @param dictionary The pre-trained dictionary, primes the code dictionary of every segment, nil for none
+ @param threads The segments decompressed at the same time, 0 for the active processors
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block
+ @param completion The completion block, error is kZXCErrorNone if succeeded
+ */
 + (void)decompressUsingLZW:(const unsigned int)dictionarySize
-                readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                dictionary:(ZXCDictionary *)dictionary
+                   threads:(const unsigned int)threads
+                readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
-                completion:(void (^)(void))completion;
+                completion:(void (^)(ZXCError error))completion;
+
+/**
+ Build the LZW code table (string -> code) primed with the dictionary content,
+ the phrases of the content fill at most half of the table
+
+ @param dictionarySize The code dictionary size
+ @param dictionary The dictionary content, nil for the 256 single byte codes only
+ @return The code table, free it by hashtable_free()
+ */
++ (struct hash_table *)tableUsingLZW:(const unsigned int)dictionarySize dictionary:(NSData *)dictionary;
+
+/**
+ Build the LZW code dictionary: the 256 single byte codes and the phrases of the dictionary content, sealed,
+ ZXCDictionary keeps one per table size and policy, the coders copy it (code_table_copy)
+
+ @param tableSize The code dictionary size
+ @param dictionary The pre-trained dictionary, nil for the 256 single byte codes only
+ @param policy What to do when the code dictionary is full
+ @return The code dictionary, free it by code_table_free()
+ */
++ (struct code_table *)codeTableUsingLZW:(const unsigned int)tableSize dictionary:(ZXCDictionary *)dictionary policy:(ZXCDictionaryPolicy)policy;
 
 @end
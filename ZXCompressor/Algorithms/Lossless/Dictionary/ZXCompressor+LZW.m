@@ -23,103 +23,109 @@
 //
 
 #import "ZXCompressor+LZW.h"
+#import "ZXCompressor+Segment.h"
 #import "bitbyte.h"
+#import "hash.h"
 #import "hashtable.h"
+#import "codetable.h"
 
 @implementation ZXCompressor (LZW)
 
 const int kLZWCodeBase = 256;
 const int kLZWDictSize = 4096;
 
+// 每次编码/解码的词典: 有预置字典时复制字典中建好的词典(memcpy), 不再逐个加入预置的编码
+static code_table * LZWCodeTable(unsigned int tableSize, ZXCDictionary *dictionary, ZXCDictionaryPolicy policy) {
+    code_table *sealed = dictionary ? [dictionary codeTableForAlgorithm:kZXCAlgorithmLZW tableSize:tableSize policy:policy] : NULL;
+    return sealed ? code_table_copy(sealed) : [ZXCompressor codeTableUsingLZW:tableSize dictionary:nil policy:policy];
+}
+
++ (void)compressUsingLZW:(const unsigned int)dictionarySize
+              dictionary:(ZXCDictionary *)dictionary
+              readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+             writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+              completion:(void (^)(void))completion {
+    [self compressUsingLZW:dictionarySize dictionary:dictionary policy:kZXCDictionaryPolicyReset readBuffer:readBuffer writeBuffer:writeBuffer completion:completion];
+}
+
++ (void)decompressUsingLZW:(const unsigned int)dictionarySize
+                dictionary:(ZXCDictionary *)dictionary
+                readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+               writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                completion:(void (^)(ZXCError error))completion {
+    [self decompressUsingLZW:dictionarySize dictionary:dictionary policy:kZXCDictionaryPolicyReset readBuffer:readBuffer writeBuffer:writeBuffer completion:completion];
+}
+
 + (void)compressUsingLZW:(const unsigned int)dictionarySize
-              readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+              dictionary:(ZXCDictionary *)dictionary
+                  policy:(ZXCDictionaryPolicy)policy
+              readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
              writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
               completion:(void (^)(void))completion {
     // 调整词典大小
     unsigned int tableSize = dictionarySize < kLZWDictSize ? kLZWDictSize : dictionarySize;
     // 编码字节数, 根据词典的大小(tableSize)决定
     unsigned int codeSize = size_in_bytes(tableSize);
-    // 前缀缓冲区大小(动态分配)
-    unsigned int prefixSize = kLZWCodeBase;
-    // 前缀缓冲区
-    unsigned char *prefix = malloc(prefixSize);
-    memset(prefix, 0, prefixSize);
-    // 前缀缓冲区当前长度
-    unsigned int length = 0; // for prefix
+    // 编码字节数能表示的编码上限, 超出的编码不使用
+    unsigned int codeLimit = codeSize < sizeof(unsigned int) ? 1U << (codeSize * 8) : CODE_TABLE_NONE;
     // 符号字节数
     unsigned int symbolSize = sizeof(unsigned char);
     // 符号缓冲区
     unsigned char symbol = 0;
+    // 前缀的编码, 没有前缀为 CODE_TABLE_NONE, 前缀加一个符号查找一次, 不用保存前缀的字符串
+    unsigned int prefix = CODE_TABLE_NONE;
     // 字典编码
     unsigned int code;
     unsigned int code_nbo = 0; // 网络字节序
-    unsigned int output_len = 0;
-    unsigned int i,j,k;
-    // 初始化字典
-    hashtable *table = hashtable_new(tableSize);
-    for (k = 0; k < kLZWCodeBase; k++) {
-        hashtable_set_node(table, &k, symbolSize, &k, codeSize);
-    }
+    unsigned long long i;
+    unsigned int j;
+    // 初始化词典(单字节编码 + 预置字典)
+    code_table *table = LZWCodeTable(tableSize, dictionary, policy);
     // 开始处理数据
     for (i = 0; ; i++) {
         // 读入数据
         j = readBuffer ? readBuffer(&symbol, symbolSize, i) : 0;
         if (j == 0) {
             // 输出最后的编码
-            if (length > 0) {
+            if (prefix != CODE_TABLE_NONE) {
+                code_nbo = 0;
+                host_to_network_byte_order(&code_nbo, &prefix, codeSize);
                 if (writeBuffer) {
                     writeBuffer((unsigned char *)&code_nbo, codeSize);
                 }
             }
             break;
         }
-        // 扩展前缀缓冲区
-        if (length + symbolSize >= prefixSize) {
-            prefixSize *= 2;
-            prefix = realloc(prefix, prefixSize);
+        // 第一个符号, 单字节的编码就是符号
+        if (prefix == CODE_TABLE_NONE) {
+            prefix = symbol;
+            continue;
         }
-        // 复制符号到前缀缓冲区，组成新的前缀
-        memcpy(&prefix[length++], &symbol, symbolSize);
         // 查找编码
-        hashnode *node = hashtable_get_node(table, prefix, length);
+        code = code_table_find(table, prefix, symbol);
         // 找到编码
-        if (node) {
-            code = 0;
-            memcpy(&code, node->value->data, node->value->length);
-            // 网络字节序
-            code_nbo = 0;
-            host_to_network_byte_order(&code_nbo, &code, codeSize);
-        } else {
-            // 输出编码
-            if (writeBuffer) {
-                writeBuffer((unsigned char *)&code_nbo, codeSize);
-                output_len += codeSize;
-            }
-            // 没找到，加入词典
-            if (table->used < table->size) {
-                hashtable_set_node(table, prefix, length, &table->used, codeSize);
-            } else {
-                // 清空词典
-                hashtable_free(table);
-                table = hashtable_new(tableSize);
-                for (k = 0; k < kLZWCodeBase; k++) {
-                    hashtable_set_node(table, &k, symbolSize, &k, codeSize);
-                }
-            }
-            // 重置前缀缓冲区
-            memset(prefix, 0, prefixSize);
-            // 复制符号到前缀缓冲区
-            length = 0;
-            memcpy(&prefix[length++], &symbol, symbolSize);
-            // 网络字节序
-            code = symbol;
-            code_nbo = 0;
-            host_to_network_byte_order(&code_nbo, &code, codeSize);
+        if (code < codeLimit) {
+            prefix = code;
+            continue;
         }
+        // 输出前缀的编码
+        code_nbo = 0;
+        host_to_network_byte_order(&code_nbo, &prefix, codeSize);
+        if (writeBuffer) {
+            writeBuffer((unsigned char *)&code_nbo, codeSize);
+        }
+        code_table_count(table, table->length[prefix], codeSize);
+        // 没找到，加入词典, 词典满了按策略清空
+        if (table->next < table->capacity) {
+            code_table_add(table, prefix, symbol);
+        } else if (code_table_full(table)) {
+            code_table_reset(table);
+        }
+        // 新的前缀从当前符号开始
+        prefix = symbol;
     }
     // 释放资源
-    hashtable_free(table);
-    free(prefix);
+    code_table_free(table);
     // 完成
     if (completion) {
         completion();
@@ -127,98 +133,193 @@ const int kLZWDictSize = 4096;
 }
 
 + (void)decompressUsingLZW:(const unsigned int)dictionarySize
-                readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                dictionary:(ZXCDictionary *)dictionary
+                    policy:(ZXCDictionaryPolicy)policy
+                readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
-                completion:(void (^)(void))completion {
+                completion:(void (^)(ZXCError error))completion {
     // 调整词典大小
     unsigned int tableSize = dictionarySize < kLZWDictSize ? kLZWDictSize : dictionarySize;
     // 编码字节数, 根据词典的大小(tableSize)决定
     unsigned int codeSize = size_in_bytes(tableSize);
-    // 前缀缓冲区大小(动态分配)
-    unsigned int prefixSize = kLZWCodeBase;
-    // 前缀缓冲区
-    unsigned char *prefix = malloc(prefixSize);
-    memset(prefix, 0, prefixSize);
-    // 前缀缓冲区当前长度
-    unsigned int length = 0; // for prefix
-    // 字符字节数
-    unsigned int symbolSize = sizeof(unsigned char);
+    // 输出缓冲区大小(动态分配)
+    unsigned int outputSize = kLZWCodeBase;
+    // 输出缓冲区, 编码的字符串
+    unsigned char *output = malloc(outputSize);
+    // 字符串长度
+    unsigned int length = 0;
+    // 上个编码, 和它的第一个符号
+    unsigned int previous = CODE_TABLE_NONE;
+    unsigned char first = 0;
     // 字典编码
     unsigned int code;
     unsigned int code_nbo = 0; // 网络字节序
-    unsigned int output_len = 0;
-    unsigned int i,j,k;
-    bool reset = false;
-    // 初始化字典
-    hashtable * table = hashtable_new(tableSize);
-    for (k = 0; k < kLZWCodeBase; k++) {
-        hashtable_set_node(table, &k, codeSize, &k, symbolSize);
-    }
+    unsigned long long i;
+    unsigned int j;
+    bool pending;
+    ZXCError error = kZXCErrorNone;
+    // 初始化词典(单字节编码 + 预置字典)
+    code_table *table = LZWCodeTable(tableSize, dictionary, policy);
     // 开始处理数据
     for (i = 0; ; i += codeSize) {
         // 读入数据
         code_nbo = 0;
         j = readBuffer ? readBuffer(&code_nbo, codeSize, i) : 0;
         if (j < codeSize) {
+            // 不完整的编码
+            if (j > 0) {
+                error = kZXCErrorTruncated;
+            }
             break;
         }
         // 主机字节序
         code = 0;
         network_to_host_byte_order(&code, &code_nbo, codeSize);
-        // 查找编码
-        hashnode *node = hashtable_get_node(table, &code, codeSize);
-        // 跳过第一个编码
-        if (length > 0) {
-            // 复制到前缀缓冲区
-            if (node) {
-                memcpy(&prefix[length++], node->value->data, symbolSize);
-            } else {
-                memcpy(&prefix[length++], &prefix[0], symbolSize);
+        // 校验编码: 须在词典中, 或者是下一个加入词典的编码(KwKwK, 不能是第一个编码, 词典不能是满的)
+        pending = code == table->next;
+        if (unlikely((code > table->next) | (pending & ((previous == CODE_TABLE_NONE) | (table->next == table->capacity))))) {
+            error = kZXCErrorCorrupted;
+            break;
+        }
+        // 展开字符串
+        if (!pending) {
+            length = table->length[code];
+            if (length > outputSize) {
+                outputSize = MAX(outputSize * 2, length);
+                output = realloc(output, outputSize);
             }
-            // 加入词典
-            if (table->used < table->size) {
-                hashtable_set_node(table, &table->used, codeSize, prefix, length);
-            } else {
-                reset = true;
+            code_table_string(table, code, output);
+        }
+        // 跳过第一个编码
+        if (previous != CODE_TABLE_NONE) {
+            // 加入词典: 上个编码 + 这个编码的第一个符号(KwKwK 是上个编码的第一个符号)
+            if (table->next < table->capacity) {
+                code_table_add(table, previous, pending ? first : output[0]);
+            } else if (code_table_full(table)) {
+                // 清空词典(字符串已展开), 编码端清空后重新查找, 只能找到初始编码
+                code_table_reset(table);
+                if (unlikely(code >= table->base)) {
+                    error = kZXCErrorCorrupted;
+                    break;
+                }
             }
-            // 重新查找
-            if (node == NULL) {
-                node = hashtable_get_node(table, &code, codeSize);
+        }
+        // KwKwK, 加入词典后展开
+        if (pending) {
+            length = table->length[code];
+            if (length > outputSize) {
+                outputSize = MAX(outputSize * 2, length);
+                output = realloc(output, outputSize);
             }
+            code_table_string(table, code, output);
         }
+        code_table_count(table, length, codeSize);
         // 输出数据
         if (writeBuffer) {
-            writeBuffer(node->value->data, node->value->length);
-            output_len += node->value->length;
-        }
-        // 超出范围，清空词典
-        if (reset) {
-            reset = false;
-            hashtable_free(table);
-            table = hashtable_new(tableSize);
-            for (k = 0; k < kLZWCodeBase; k++) {
-                hashtable_set_node(table, &k, codeSize, &k, symbolSize);
-            }
+            writeBuffer(output, length);
         }
+        previous = code;
+        first = output[0];
+    }
+    // 释放资源
+    code_table_free(table);
+    free(output);
+    // 完成
+    if (completion) {
+        completion(error);
+    }
+}
+
++ (void)compressUsingLZW:(const unsigned int)dictionarySize
+              dictionary:(ZXCDictionary *)dictionary
+             segmentSize:(const unsigned int)segmentSize
+                 threads:(const unsigned int)threads
+              readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+             writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+              completion:(void (^)(ZXCError error))completion {
+    // 每段独立编码, 词典满了按压缩率决定是否清空
+    [self compressSegmentsUsing:kZXCAlgorithmLZW
+                    segmentSize:segmentSize
+                        threads:threads
+                     readBuffer:readBuffer
+                    writeBuffer:writeBuffer
+                          coder:^ZXCError(const unsigned int (^segmentRead)(void *, const unsigned int, const unsigned long long), void (^segmentWrite)(const void *, const unsigned int)) {
+                              [self compressUsingLZW:dictionarySize dictionary:dictionary policy:kZXCDictionaryPolicyMonitor readBuffer:segmentRead writeBuffer:segmentWrite completion:nil];
+                              return kZXCErrorNone;
+                          } completion:completion];
+}
+
++ (void)decompressUsingLZW:(const unsigned int)dictionarySize
+                dictionary:(ZXCDictionary *)dictionary
+                   threads:(const unsigned int)threads
+                readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+               writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                completion:(void (^)(ZXCError error))completion {
+    // 每段独立解码
+    [self decompressSegmentsUsing:kZXCAlgorithmLZW
+                          threads:threads
+                       readBuffer:readBuffer
+                      writeBuffer:writeBuffer
+                            coder:^ZXCError(const unsigned int (^segmentRead)(void *, const unsigned int, const unsigned long long), void (^segmentWrite)(const void *, const unsigned int)) {
+                                __block ZXCError error = kZXCErrorNone;
+                                [self decompressUsingLZW:dictionarySize dictionary:dictionary policy:kZXCDictionaryPolicyMonitor readBuffer:segmentRead writeBuffer:segmentWrite completion:^(ZXCError errorCode) {
+                                    error = errorCode;
+                                }];
+                                return error;
+                            } completion:completion];
+}
+
++ (hashtable *)tableUsingLZW:(const unsigned int)dictionarySize dictionary:(NSData *)dictionary {
+    // 调整词典大小
+    unsigned int tableSize = dictionarySize < kLZWDictSize ? kLZWDictSize : dictionarySize;
+    // 编码字节数, 根据词典的大小(tableSize)决定
+    unsigned int codeSize = size_in_bytes(tableSize);
+    // 符号字节数
+    unsigned int symbolSize = sizeof(unsigned char);
+    unsigned int k;
+    // 单字节编码
+    hashtable *table = hashtable_new(tableSize);
+    for (k = 0; k < kLZWCodeBase; k++) {
+        hashtable_set_node(table, &k, symbolSize, &k, codeSize);
+    }
+    // 按编码的方式把字典内容加入词典, 最多占用一半, 其余留给待压缩的数据
+    const unsigned char *bytes = dictionary.bytes;
+    unsigned int prefixSize = kLZWCodeBase;
+    unsigned char *prefix = malloc(prefixSize);
+    unsigned int length = 0;
+    unsigned int prefixHash = 0;
+    for (NSUInteger i = 0; i < dictionary.length && table->used < table->size / 2; i++) {
         // 扩展前缀缓冲区
-        if (node->value->length > prefixSize) {
-            prefixSize = MAX(prefixSize * 2, node->value->length);
+        if (length + symbolSize >= prefixSize) {
+            prefixSize *= 2;
             prefix = realloc(prefix, prefixSize);
         }
-        // 重置前缀缓冲区
-        memset(prefix, 0, prefixSize);
-        length = 0;
-        // 复制到前缀缓冲区
-        memcpy(&prefix[length], node->value->data, node->value->length);
-        length += node->value->length;
+        prefix[length++] = bytes[i];
+        prefixHash = hash_roll(prefixHash, bytes[i]);
+        if (hashtable_get_node_hash(table, prefix, length, prefixHash) == NULL) {
+            hashtable_set_node_hash(table, prefix, length, prefixHash, &table->used, codeSize);
+            // 新的前缀从当前符号开始
+            length = 0;
+            prefix[length++] = bytes[i];
+            prefixHash = hash_roll(0, bytes[i]);
+        }
     }
-    // 释放资源
-    hashtable_free(table);
     free(prefix);
-    // 完成
-    if (completion) {
-        completion();
+    return table;
+}
+
+// 编码词典: 单字节编码(前缀 CODE_TABLE_NONE), 预置字典的编码, 固定容量, 清空时不重建
++ (code_table *)codeTableUsingLZW:(const unsigned int)tableSize dictionary:(ZXCDictionary *)dictionary policy:(ZXCDictionaryPolicy)policy {
+    code_table *table = code_table_new(tableSize, (code_table_policy)policy);
+    for (unsigned int k = 0; k < kLZWCodeBase; k++) {
+        code_table_set(table, k, CODE_TABLE_NONE, (unsigned char)k, 1);
+    }
+    hashtable *snapshot = dictionary ? [dictionary tableForAlgorithm:kZXCAlgorithmLZW tableSize:tableSize inverse:NO] : NULL;
+    if (snapshot) {
+        code_table_prime(table, snapshot, CODE_TABLE_NONE);
     }
+    code_table_seal(table, snapshot ? (unsigned int)snapshot->used : kLZWCodeBase);
+    return table;
 }
 
 @end
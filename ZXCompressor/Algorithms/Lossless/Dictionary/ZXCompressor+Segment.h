@@ -0,0 +1,81 @@
+//
+// ZXCompressor+Segment.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#import "ZXCompressor.h"
+
+/**
+ Codes one segment: reads the segment by 'readBuffer' and writes the output by 'writeBuffer'
+ The segments are coded concurrently, the coder must not share the mutable state between the calls
+ */
+typedef ZXCError (^ZXCSegmentCoder)(const unsigned int (^readBuffer)(void *buffer, const unsigned int length, const unsigned long long offset),
+                                    void (^writeBuffer)(const void *buffer, const unsigned int length));
+
+/**
+ ZXCompressor (Segment)
+ The segmented container of the serial dictionary coders (LZ78/LZW):
+ the input is cut into segments coded independently, each from a fresh (or pre-trained) dictionary,
+ so the segments are compressed and decompressed in parallel, the output does not depend on the threads
+ Header: format (1 byte), algorithm (1 byte), segment size (4 bytes),
+ every segment is prefixed by its compressed size (4 bytes), so the next segment is located without decoding,
+ a compressed size of 0 ends the stream
+ */
+@interface ZXCompressor (Segment)
+
+/**
+ Compress the data/file into segments
+
+ @param algorithm The algorithm written to the header, checked by the decompressor
+ @param segmentSize The uncompressed size of a segment, in [4 KB, 256 MB], 0 for the default (1 MB)
+ @param threads The segments coded at the same time, 0 for the active processors, the memory is bounded by threads * segment size
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block
+ @param coder The segment compressor
+ @param completion The completion block, error is the first error of the segment compressor, the batch of the failed segment and the end mark are not written
+ */
++ (void)compressSegmentsUsing:(ZXCAlgorithm)algorithm
+                  segmentSize:(const unsigned int)segmentSize
+                      threads:(const unsigned int)threads
+                   readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+                  writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                        coder:(ZXCSegmentCoder)coder
+                   completion:(void (^)(ZXCError error))completion;
+
+/**
+ Decompress the data/file made of segments
+
+ @param algorithm The algorithm of the segments, the header must match it
+ @param threads The segments decoded at the same time, 0 for the active processors
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block, the segments are written in order
+ @param coder The segment decompressor
+ @param completion The completion block, error is kZXCErrorNone if succeeded
+ */
++ (void)decompressSegmentsUsing:(ZXCAlgorithm)algorithm
+                        threads:(const unsigned int)threads
+                     readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+                    writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                          coder:(ZXCSegmentCoder)coder
+                     completion:(void (^)(ZXCError error))completion;
+
+@end
@@ -0,0 +1,215 @@
+//
+// ZXCompressor+Segment.m
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#import "ZXCompressor+Segment.h"
+
+@implementation ZXCompressor (Segment)
+
+// 格式版本
+static const unsigned char kSegmentFormat = 1;
+// 头部字节数: 格式, 算法, 段大小
+static const unsigned int kSegmentHeaderSize = 6;
+// 段大小的范围
+static const unsigned int kSegmentDefaultSize = 1 << 20;
+static const unsigned int kSegmentMinSize = 1 << 12;
+static const unsigned int kSegmentMaxSize = 1 << 28;
+// 压缩后每个字节最多 8 字节(编码 + 符号), 超出视为损坏
+static const unsigned int kSegmentMaxExpansion = 8;
+
+// 读满 length 字节, 除非输入结束
+static unsigned int SegmentRead(const unsigned int (^readBuffer)(void *buffer, const unsigned int length, const unsigned long long offset),
+                                void *buffer, const unsigned int length, const unsigned long long offset) {
+    unsigned int total = 0, readed;
+    while (total < length) {
+        readed = readBuffer ? readBuffer((unsigned char *)buffer + total, length - total, offset + total) : 0;
+        if (readed == 0) {
+            break;
+        }
+        total += readed;
+    }
+    return total;
+}
+
+// 按段编码, 段的输入和输出都在内存中
+static ZXCError SegmentCode(ZXCSegmentCoder coder, NSData *input, NSMutableData *output) {
+    return coder(^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+        unsigned int bufSize = offset < input.length ? (unsigned int)MIN(length, input.length - offset) : 0;
+        memcpy(buffer, (const unsigned char *)input.bytes + offset, bufSize);
+        return bufSize;
+    }, ^(const void *buffer, const unsigned int length) {
+        [output appendBytes:buffer length:length];
+    });
+}
+
++ (void)compressSegmentsUsing:(ZXCAlgorithm)algorithm
+                  segmentSize:(const unsigned int)segmentSize
+                      threads:(const unsigned int)threads
+                   readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+                  writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                        coder:(ZXCSegmentCoder)coder
+                   completion:(void (^)(ZXCError error))completion {
+    // 调整段大小
+    unsigned int size = segmentSize == 0 ? kSegmentDefaultSize : MIN(MAX(segmentSize, kSegmentMinSize), kSegmentMaxSize);
+    // 每批并行编码的段数
+    unsigned int workers = threads > 0 ? threads : (unsigned int)[NSProcessInfo processInfo].activeProcessorCount;
+    // 头部
+    unsigned char header[kSegmentHeaderSize];
+    unsigned int size_nbo = NSSwapHostIntToBig(size); // 网络字节序
+    header[0] = kSegmentFormat;
+    header[1] = (unsigned char)algorithm;
+    memcpy(&header[2], &size_nbo, sizeof(size_nbo));
+    if (writeBuffer) {
+        writeBuffer(header, sizeof(header));
+    }
+    unsigned long long offset = 0;
+    BOOL end = NO;
+    ZXCError error = kZXCErrorNone;
+    while (!end && !error) {
+        @autoreleasepool {
+            // 读入一批段
+            NSMutableArray<NSData *> *inputs = [NSMutableArray arrayWithCapacity:workers];
+            NSMutableArray<NSMutableData *> *outputs = [NSMutableArray arrayWithCapacity:workers];
+            while (inputs.count < workers && !end) {
+                NSMutableData *input = [NSMutableData dataWithLength:size];
+                unsigned int length = SegmentRead(readBuffer, input.mutableBytes, size, offset);
+                offset += length;
+                end = length < size;
+                if (length > 0) {
+                    input.length = length;
+                    [inputs addObject:input];
+                    [outputs addObject:[NSMutableData data]];
+                }
+            }
+            // 并行编码, 每段从新的(或预置的)词典开始
+            NSUInteger count = inputs.count;
+            ZXCError *errors = calloc(MAX(count, 1), sizeof(ZXCError));
+            dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+                errors[i] = SegmentCode(coder, inputs[i], outputs[i]);
+            });
+            // 有一段编码失败, 整批都不输出, 也不再写结束标记
+            for (NSUInteger i = 0; i < count && !error; i++) {
+                error = errors[i];
+            }
+            free(errors);
+            // 按顺序输出: 压缩后的大小 + 数据
+            for (NSUInteger i = 0; i < count && !error; i++) {
+                unsigned int length_nbo = NSSwapHostIntToBig((unsigned int)outputs[i].length);
+                if (writeBuffer) {
+                    writeBuffer(&length_nbo, sizeof(length_nbo));
+                    writeBuffer(outputs[i].bytes, (unsigned int)outputs[i].length);
+                }
+            }
+        }
+    }
+    // 结束标记
+    unsigned int zero = 0;
+    if (writeBuffer && !error) {
+        writeBuffer(&zero, sizeof(zero));
+    }
+    // 完成
+    if (completion) {
+        completion(error);
+    }
+}
+
++ (void)decompressSegmentsUsing:(ZXCAlgorithm)algorithm
+                        threads:(const unsigned int)threads
+                     readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+                    writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                          coder:(ZXCSegmentCoder)coder
+                     completion:(void (^)(ZXCError error))completion {
+    // 每批并行解码的段数
+    unsigned int workers = threads > 0 ? threads : (unsigned int)[NSProcessInfo processInfo].activeProcessorCount;
+    ZXCError error = kZXCErrorNone;
+    // 头部
+    unsigned char header[kSegmentHeaderSize];
+    unsigned long long offset = SegmentRead(readBuffer, header, sizeof(header), 0);
+    unsigned int size = 0;
+    if (offset < sizeof(header)) {
+        error = kZXCErrorTruncated;
+    } else {
+        memcpy(&size, &header[2], sizeof(size));
+        size = NSSwapBigIntToHost(size);
+        if (header[0] != kSegmentFormat || header[1] != (unsigned char)algorithm || size < kSegmentMinSize || size > kSegmentMaxSize) {
+            error = kZXCErrorCorrupted;
+        }
+    }
+    BOOL end = NO;
+    while (!end && !error) {
+        @autoreleasepool {
+            // 按压缩后的大小读入一批段
+            NSMutableArray<NSData *> *inputs = [NSMutableArray arrayWithCapacity:workers];
+            NSMutableArray<NSMutableData *> *outputs = [NSMutableArray arrayWithCapacity:workers];
+            while (inputs.count < workers && !end && !error) {
+                unsigned int length = 0;
+                if (SegmentRead(readBuffer, &length, sizeof(length), offset) < sizeof(length)) {
+                    error = kZXCErrorTruncated;
+                    break;
+                }
+                offset += sizeof(length);
+                length = NSSwapBigIntToHost(length);
+                if (length == 0) {
+                    end = YES;
+                    break;
+                }
+                if (length > (unsigned long long)size * kSegmentMaxExpansion) {
+                    error = kZXCErrorCorrupted;
+                    break;
+                }
+                NSMutableData *input = [NSMutableData dataWithLength:length];
+                if (SegmentRead(readBuffer, input.mutableBytes, length, offset) < length) {
+                    error = kZXCErrorTruncated;
+                    break;
+                }
+                offset += length;
+                [inputs addObject:input];
+                [outputs addObject:[NSMutableData dataWithCapacity:size]];
+            }
+            // 并行解码
+            NSUInteger count = inputs.count;
+            ZXCError *errors = calloc(MAX(count, 1), sizeof(ZXCError));
+            dispatch_apply(error ? 0 : count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+                errors[i] = SegmentCode(coder, inputs[i], outputs[i]);
+            });
+            // 按顺序输出, 除了最后一段, 每段都是完整的段大小
+            for (NSUInteger i = 0; i < count && !error; i++) {
+                NSUInteger expected = end && i + 1 == count ? outputs[i].length : size;
+                if (errors[i] != kZXCErrorNone) {
+                    error = errors[i];
+                } else if (outputs[i].length != expected || expected == 0 || expected > size) {
+                    error = kZXCErrorCorrupted;
+                } else if (writeBuffer) {
+                    writeBuffer(outputs[i].bytes, (unsigned int)outputs[i].length);
+                }
+            }
+            free(errors);
+        }
+    }
+    // 完成
+    if (completion) {
+        completion(error);
+    }
+}
+
+@end
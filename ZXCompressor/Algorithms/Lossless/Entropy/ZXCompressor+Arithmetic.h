@@ -36,8 +36,8 @@
  @param completion The completion block
  */
 + (void)compressUsingArithmetic:(const unsigned int)bufferSize
-                      inputSize:(const unsigned int)inputSize
-                     readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                      inputSize:(const unsigned long long)inputSize
+                     readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                     writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
                      completion:(void (^)(void))completion;
 
@@ -47,11 +47,11 @@
  @param bufferSize The input buffer size
  @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
  @param writeBuffer The output block,
- @param completion The completion block
+ @param completion The completion block, error is kZXCErrorNone if succeeded
  */
 + (void)decompressUsingArithmetic:(const unsigned int)bufferSize
-                       readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                       readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                       writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
-                       completion:(void (^)(void))completion;
+                       completion:(void (^)(ZXCError error))completion;
 
 @end
@@ -27,8 +27,8 @@
 @implementation ZXCompressor (Arithmetic)
 
 + (void)compressUsingArithmetic:(const unsigned int)bufferSize
-                      inputSize:(const unsigned int)inputSize
-                     readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                      inputSize:(const unsigned long long)inputSize
+                     readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                     writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
                      completion:(void (^)(void))completion {
     if (completion) {
@@ -37,11 +37,11 @@
 }
 
 + (void)decompressUsingArithmetic:(const unsigned int)bufferSize
-                       readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                       readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                       writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
-                       completion:(void (^)(void))completion {
+                       completion:(void (^)(ZXCError error))completion {
     if (completion) {
-        completion();
+        completion(kZXCErrorNone);
     }
 }
 
@@ -0,0 +1,59 @@
+//
+// ZXCompressor+FSE.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#import "ZXCompressor.h"
+
+@interface ZXCompressor (FSE)
+
+/**
+ Compress the data/file using by Finite State Entropy (tabled asymmetric numeral systems), reads the input once
+ Each block has its own normalized counts (or is stored raw, or as a run of one byte)
+ 
+ @param blockSize The block size, 64 KB ~ 256 KB is recommended, the memory is bounded by it, in [kZXCBlockSizeMin, kZXCBlockSizeMax] (1 KB ~ 64 MB), nothing is written out of it
+ @param tableLog The log2 of the states, 5 ~ 12, 11 is recommended
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block
+ @param completion The completion block
+ */
++ (void)compressUsingFSE:(const unsigned int)blockSize
+                tableLog:(const unsigned int)tableLog
+              readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+             writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+              completion:(void (^)(void))completion;
+
+/**
+ Decompress the data/file using by Finite State Entropy
+ 
+ @param blockSize The max block size, must be the same as the compressor, kZXCErrorCorrupted out of [kZXCBlockSizeMin, kZXCBlockSizeMax]
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block,
+ @param completion The completion block, error is kZXCErrorNone if succeeded
+ */
++ (void)decompressUsingFSE:(const unsigned int)blockSize
+                readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+               writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                completion:(void (^)(ZXCError error))completion;
+
+@end
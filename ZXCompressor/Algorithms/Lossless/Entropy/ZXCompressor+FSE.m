@@ -0,0 +1,253 @@
+//
+// ZXCompressor+FSE.m
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#import "ZXCompressor+FSE.h"
+#import "fse.h"
+#import "histogram.h"
+#import "bitbyte.h"
+
+@implementation ZXCompressor (FSE)
+
+// block format, the first byte of the stream
+const unsigned char kFSEBlockFormat = 1;
+
+// block types
+typedef enum {
+    kFSEBlockEnd = 0, // end of stream
+    kFSEBlockRaw, // stored bytes
+    kFSEBlockCompressed, // normalized counts + bits
+    kFSEBlockRun, // one byte repeated
+} FSEBlockType;
+
+// block header: type (1 byte) + origin length (4 bytes, big endian)
+const unsigned int kFSEBlockHeaderSize = 5;
+
++ (void)compressUsingFSE:(const unsigned int)blockSize
+                tableLog:(const unsigned int)tableLog
+              readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+             writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+              completion:(void (^)(void))completion {
+    // a block size out of range is rejected, nothing is written, so the decompressor reports the missing stream
+    if (blockSize < kZXCBlockSizeMin || blockSize > kZXCBlockSizeMax) {
+        if (completion) {
+            completion();
+        }
+        return;
+    }
+    // read buffer
+    unsigned char *buffer = malloc(blockSize);
+    // output: header + counts + payload length + payload
+    unsigned int outputSize = kFSEBlockHeaderSize + FSE_MAX_HEADER_SIZE + 4 + FSE_ENCODE_BOUND(blockSize, FSE_MAX_TABLE_LOG);
+    unsigned char *output = malloc(outputSize);
+    // tables
+    fse_ctable *ctable = malloc(sizeof(fse_ctable));
+    unsigned int counts[HISTOGRAM_SIZE];
+    short norm[HISTOGRAM_SIZE];
+    // read length in bytes
+    unsigned int readed;
+    // output length in bytes
+    unsigned int length;
+    // format
+    if (writeBuffer) {
+        writeBuffer(&kFSEBlockFormat, sizeof(kFSEBlockFormat));
+    }
+    for (unsigned long long offset = 0; ; offset += readed) {
+        readed = readBuffer ? readBuffer(buffer, blockSize, offset) : 0;
+        if (readed == 0) {
+            break;
+        }
+        histogram_count(buffer, readed, counts);
+        int log = fse_normalize(counts, readed, norm, tableLog);
+        // header
+        output[1] = (unsigned char)(readed >> 24);
+        output[2] = (unsigned char)(readed >> 16);
+        output[3] = (unsigned char)(readed >> 8);
+        output[4] = (unsigned char)readed;
+        length = kFSEBlockHeaderSize;
+        if (log == 0) {
+            // a single byte value
+            output[0] = kFSEBlockRun;
+            output[length++] = buffer[0];
+        } else {
+            output[0] = kFSEBlockCompressed;
+            length += fse_write_norm(norm, log, &output[length]);
+            fse_build_ctable(norm, log, ctable);
+            unsigned int payload = fse_encode(buffer, readed, ctable, &output[length + 4]);
+            output[length++] = (unsigned char)(payload >> 24);
+            output[length++] = (unsigned char)(payload >> 16);
+            output[length++] = (unsigned char)(payload >> 8);
+            output[length++] = (unsigned char)payload;
+            length += payload;
+            // not smaller than the raw bytes
+            if (length >= kFSEBlockHeaderSize + readed) {
+                output[0] = kFSEBlockRaw;
+                memcpy(&output[kFSEBlockHeaderSize], buffer, readed);
+                length = kFSEBlockHeaderSize + readed;
+            }
+        }
+        if (writeBuffer) {
+            writeBuffer(output, length);
+        }
+        if (readed < blockSize) {
+            break;
+        }
+    }
+    // end of stream
+    output[0] = kFSEBlockEnd;
+    if (writeBuffer) {
+        writeBuffer(output, 1);
+    }
+    // free
+    free(ctable);
+    free(output);
+    free(buffer);
+    // completion
+    if (completion) {
+        completion();
+    }
+}
+
++ (void)decompressUsingFSE:(const unsigned int)blockSize
+                readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+               writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                completion:(void (^)(ZXCError error))completion {
+    // no stream is made with a block size out of range
+    if (blockSize < kZXCBlockSizeMin || blockSize > kZXCBlockSizeMax) {
+        if (completion) {
+            completion(kZXCErrorCorrupted);
+        }
+        return;
+    }
+    // payload buffer
+    unsigned int inputSize = FSE_ENCODE_BOUND(blockSize, FSE_MAX_TABLE_LOG);
+    unsigned char *input = malloc(MAX(inputSize, FSE_MAX_HEADER_SIZE));
+    unsigned char *output = malloc(blockSize);
+    // tables
+    fse_dtable *dtable = malloc(sizeof(fse_dtable));
+    short norm[HISTOGRAM_SIZE];
+    int log;
+    // header
+    unsigned char header[kFSEBlockHeaderSize];
+    unsigned char format = 0;
+    // input offset in bytes
+    unsigned long long offset = 0;
+    // read length in bytes
+    unsigned int readed = readBuffer ? readBuffer(&format, sizeof(format), offset) : 0;
+    offset += readed;
+    // temp
+    unsigned int length, payload;
+    // error
+    ZXCError error = kZXCErrorNone;
+    if (readed != sizeof(format)) {
+        error = kZXCErrorTruncated;
+    } else if (format != kFSEBlockFormat) {
+        error = kZXCErrorCorrupted;
+    }
+    while (error == kZXCErrorNone) {
+        // type
+        readed = readBuffer ? readBuffer(header, 1, offset) : 0;
+        offset += readed;
+        if (readed != 1) {
+            error = kZXCErrorTruncated;
+            break;
+        }
+        if (header[0] == kFSEBlockEnd) {
+            break;
+        }
+        // origin length
+        readed = readBuffer ? readBuffer(&header[1], kFSEBlockHeaderSize - 1, offset) : 0;
+        offset += readed;
+        if (readed != kFSEBlockHeaderSize - 1) {
+            error = kZXCErrorTruncated;
+            break;
+        }
+        length = (unsigned int)header[1] << 24 | header[2] << 16 | header[3] << 8 | header[4];
+        if (unlikely((header[0] > kFSEBlockRun) | (length - 1 >= blockSize))) {
+            error = kZXCErrorCorrupted;
+            break;
+        }
+        if (header[0] == kFSEBlockRaw) {
+            readed = readBuffer ? readBuffer(output, length, offset) : 0;
+            offset += readed;
+            if (readed != length) {
+                error = kZXCErrorTruncated;
+                break;
+            }
+        } else if (header[0] == kFSEBlockRun) {
+            readed = readBuffer ? readBuffer(output, 1, offset) : 0;
+            offset += readed;
+            if (readed != 1) {
+                error = kZXCErrorTruncated;
+                break;
+            }
+            memset(output, output[0], length);
+        } else {
+            // normalized counts, at most FSE_MAX_HEADER_SIZE bytes
+            readed = readBuffer ? readBuffer(input, FSE_MAX_HEADER_SIZE, offset) : 0;
+            int size = fse_read_norm(input, readed, norm, &log);
+            if (unlikely(size < 0)) {
+                error = readed < FSE_MAX_HEADER_SIZE ? kZXCErrorTruncated : kZXCErrorCorrupted;
+                break;
+            }
+            offset += size;
+            fse_build_dtable(norm, log, dtable);
+            // payload
+            readed = readBuffer ? readBuffer(input, 4, offset) : 0;
+            offset += readed;
+            if (readed != 4) {
+                error = kZXCErrorTruncated;
+                break;
+            }
+            payload = (unsigned int)input[0] << 24 | input[1] << 16 | input[2] << 8 | input[3];
+            if (unlikely(payload > inputSize)) {
+                error = kZXCErrorCorrupted;
+                break;
+            }
+            readed = readBuffer ? readBuffer(input, payload, offset) : 0;
+            offset += readed;
+            if (readed != payload) {
+                error = kZXCErrorTruncated;
+                break;
+            }
+            if (unlikely(fse_decode(input, payload, dtable, output, length) != 0)) {
+                error = kZXCErrorCorrupted;
+                break;
+            }
+        }
+        if (writeBuffer) {
+            writeBuffer(output, length);
+        }
+    }
+    // free
+    free(dtable);
+    free(output);
+    free(input);
+    // completion
+    if (completion) {
+        completion(error);
+    }
+}
+
+@end
@@ -36,8 +36,8 @@
  @param completion The completion block
  */
 + (void)compressUsingHuffman:(const unsigned int)bufferSize
-                   inputSize:(const unsigned int)inputSize
-                  readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                   inputSize:(const unsigned long long)inputSize
+                  readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                  writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
                   completion:(void (^)(void))completion;
 
@@ -47,11 +47,43 @@
  @param bufferSize The input buffer size
  @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
  @param writeBuffer The output block,
- @param completion The completion block
+ @param completion The completion block, error is kZXCErrorNone if succeeded
  */
 + (void)decompressUsingHuffman:(const unsigned int)bufferSize
-                    readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                    readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                    writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
-                    completion:(void (^)(void))completion;
+                    completion:(void (^)(ZXCError error))completion;
+
+/**
+ Compress the data/file using by block-adaptive Huffman coding, reads the input once
+ Each block has its own canonical code table (or reuses the previous one, or is stored raw)
+ The format version is 1 for a single bit stream per block, 2 for 4 streams per block (faster to decode)
+ 
+ @param blockSize The block size, 64 KB ~ 256 KB is recommended, the memory is bounded by it, in [kZXCBlockSizeMin, kZXCBlockSizeMax] (1 KB ~ 64 MB), nothing is written out of it
+ @param reuseTable Reuse the previous block's table when it codes the block in fewer bits than a new table
+ @param streams The bit streams per block, 1 or 4, 4 streams are decoded by 4 interleaved bit readers
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block
+ @param completion The completion block
+ */
++ (void)compressUsingHuffmanBlock:(const unsigned int)blockSize
+                       reuseTable:(const BOOL)reuseTable
+                          streams:(const unsigned int)streams
+                       readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+                      writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                       completion:(void (^)(void))completion;
+
+/**
+ Decompress the data/file using by block-adaptive Huffman coding
+ 
+ @param blockSize The max block size, must be the same as the compressor, kZXCErrorCorrupted out of [kZXCBlockSizeMin, kZXCBlockSizeMax]
+ @param readBuffer The input block, start at 'offset' in the input data, read 'length'(max) bytes to 'buffer'
+ @param writeBuffer The output block,
+ @param completion The completion block, error is kZXCErrorNone if succeeded
+ */
++ (void)decompressUsingHuffmanBlock:(const unsigned int)blockSize
+                         readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+                        writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                         completion:(void (^)(ZXCError error))completion;
 
 @end
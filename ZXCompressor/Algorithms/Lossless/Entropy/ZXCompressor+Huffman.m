@@ -24,15 +24,35 @@
 
 #import "ZXCompressor+Huffman.h"
 #import "huffman.h"
+#import "arena.h"
+#import "histogram.h"
 #import "bitbyte.h"
 
 @implementation ZXCompressor (Huffman)
 
 const int kHuffmanDataSize = 256;
 
+// block format versions, the first byte of the stream
+const unsigned char kHuffmanBlockFormat = 1; // 1 bit stream per block
+const unsigned char kHuffmanBlockFormat4 = 2; // 4 bit streams per block after a jump table
+
+// the payload can be a few bytes larger than the block before falling back to raw
+const unsigned int kHuffmanBlockSlack = HUFFMAN_JUMP_TABLE_SIZE + 32;
+
+// block types
+typedef enum {
+    kHuffmanBlockEnd = 0, // end of stream
+    kHuffmanBlockRaw, // stored bytes
+    kHuffmanBlockTable, // new code table + bits
+    kHuffmanBlockRepeat, // previous code table + bits
+} HuffmanBlockType;
+
+// block header: type (1 byte) + origin length (4 bytes, big endian)
+const unsigned int kHuffmanBlockHeaderSize = 5;
+
 + (void)compressUsingHuffman:(const unsigned int)bufferSize
-                   inputSize:(const unsigned int)inputSize
-                  readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                   inputSize:(const unsigned long long)inputSize
+                  readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                  writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
                   completion:(void (^)(void))completion {
     // read buffer
@@ -46,21 +66,20 @@ const int kHuffmanDataSize = 256;
     unsigned int readed;
     // output length in bits
     unsigned int length = 0;
+    // input offset in bytes
+    unsigned long long offset;
     // temp
     int i,j,k,l;
-    // data
-    unsigned int data_size = sizeof(huffman_data) * kHuffmanDataSize;
-    huffman_data *data = malloc(data_size);
-    memset(data, 0, data_size);
-    for (i = 0; ; i += bufferSize) {
-        readed = readBuffer ? readBuffer(buffer, bufferSize, i) : 0;
+    // counts, 64-bit for inputs larger than 4 GB
+    unsigned int counts_size = sizeof(unsigned long long) * kHuffmanDataSize;
+    unsigned long long *counts = malloc(counts_size);
+    memset(counts, 0, counts_size);
+    for (offset = 0; ; offset += bufferSize) {
+        readed = readBuffer ? readBuffer(buffer, bufferSize, offset) : 0;
         if (readed == 0) {
             break;
         }
-        for (j = 0; j < readed; j++) {
-            k = buffer[j];
-            data[k].weight++;
-        }
+        histogram_accumulate(buffer, readed, counts);
         if (readed < bufferSize) {
             break;
         }
@@ -69,20 +88,27 @@ const int kHuffmanDataSize = 256;
     unsigned int freq_size = sizeof(unsigned int) * kHuffmanDataSize;
     unsigned int *freq = malloc(freq_size);
     memset(freq, 0, freq_size);
+    huffman_weights_from_counts(counts, freq, kHuffmanDataSize);
+    free(counts);
+    // data
+    unsigned int data_size = sizeof(huffman_data) * kHuffmanDataSize;
+    huffman_data *data = malloc(data_size);
+    memset(data, 0, data_size);
     for (i = 0; i < kHuffmanDataSize; i++) {
         data[i].symbol = i;
-        freq[i] = data[i].weight;
+        data[i].weight = freq[i];
     }
     // write input size and freq info
     if (writeBuffer) {
         writeBuffer(&inputSize, sizeof(inputSize));
         writeBuffer(freq, freq_size);
     }
-    // huffman tree
-    huffman_tree *tree = huffman_tree_new(data, kHuffmanDataSize);
+    // huffman tree, its nodes and codes are released with the arena at once
+    arena *pool = arena_new(0);
+    huffman_tree *tree = huffman_tree_new_arena(data, kHuffmanDataSize, pool);
     // encoding
-    for (i = 0; ; i += bufferSize) {
-        readed = readBuffer ? readBuffer(buffer, bufferSize, i) : 0;
+    for (offset = 0; ; offset += bufferSize) {
+        readed = readBuffer ? readBuffer(buffer, bufferSize, offset) : 0;
         if (readed == 0) {
             break;
         }
@@ -100,14 +126,15 @@ const int kHuffmanDataSize = 256;
                 bit_set(output, l + length, bit_get(node->code->bits, l));
             }
             length += node->code->used;
-            // write
-            if (length % 8 == 0) {
+            // write the whole bytes once the buffer is full, keep the last partial byte
+            if (length >= BYTES_TO_BITS(bufferSize)) {
                 if (writeBuffer) {
-                    writeBuffer(output, BITS_TO_BYTES(length));
+                    writeBuffer(output, length / 8);
                 }
                 // reset
-                memset(output, 0, outputSize);
-                length = 0;
+                output[0] = length % 8 ? output[length / 8] : 0;
+                memset(&output[1], 0, outputSize - 1);
+                length %= 8;
             }
         }
         if (readed < bufferSize) {
@@ -121,7 +148,7 @@ const int kHuffmanDataSize = 256;
         }
     }
     // free
-    huffman_tree_free(tree, kHuffmanDataSize);
+    arena_free(pool);
     free(freq);
     free(data);
     free(output);
@@ -133,9 +160,9 @@ const int kHuffmanDataSize = 256;
 }
 
 + (void)decompressUsingHuffman:(const unsigned int)bufferSize
-                    readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned int offset))readBuffer
+                    readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
                    writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
-                    completion:(void (^)(void))completion {
+                    completion:(void (^)(ZXCError error))completion {
     // read buffer
     unsigned char *buffer = malloc(bufferSize);
     memset(buffer, 0, bufferSize);
@@ -146,28 +173,46 @@ const int kHuffmanDataSize = 256;
     // symbol size
     unsigned int symbolSize = sizeof(unsigned char);
     // input offset in bytes
-    unsigned int offset = 0;
+    unsigned long long offset = 0;
     // output length in bits
     unsigned int length = 0;
     // read length in bytes
     unsigned int readed = 0;
     // writed length in bytes
-    unsigned int writed = 0;
+    unsigned long long writed = 0;
     // temp
     int i,j,k,l;
+    // error
+    ZXCError error = kZXCErrorNone;
     // origin input size
-    unsigned int originSize = 0;
+    unsigned long long originSize = 0;
     if (readBuffer) {
         readed = readBuffer(&originSize, sizeof(originSize), offset);
         offset += readed;
     }
+    if (readed != sizeof(originSize)) {
+        error = kZXCErrorTruncated;
+    }
     // freq
     unsigned int freq_size = sizeof(unsigned int) * kHuffmanDataSize;
     unsigned int *freq = malloc(freq_size);
     memset(freq, 0, freq_size);
-    if (readBuffer) {
+    if (readBuffer && error == kZXCErrorNone) {
         readed = readBuffer(freq, freq_size, offset);
         offset += readed;
+        if (readed != freq_size) {
+            error = kZXCErrorTruncated;
+        }
+    }
+    // the sum of freq must be the origin size, or the scaled weights of a larger input
+    unsigned long long freq_sum = 0;
+    for (i = 0; i < kHuffmanDataSize; i++) {
+        freq_sum += freq[i];
+    }
+    if (error == kZXCErrorNone) {
+        if (originSize <= HUFFMAN_WEIGHT_LIMIT ? freq_sum != originSize : (freq_sum == 0 || freq_sum > HUFFMAN_WEIGHT_LIMIT + kHuffmanDataSize)) {
+            error = kZXCErrorCorrupted;
+        }
     }
     // data
     unsigned int data_size = sizeof(huffman_data) * kHuffmanDataSize;
@@ -177,16 +222,17 @@ const int kHuffmanDataSize = 256;
         data[i].symbol = i;
         data[i].weight = freq[i];
     }
-    // huffman tree
-    huffman_tree *tree = huffman_tree_new(data, kHuffmanDataSize);
+    // huffman tree, its nodes and codes are released with the arena at once
+    arena *pool = arena_new(0);
+    huffman_tree *tree = huffman_tree_new_arena(data, kHuffmanDataSize, pool);
     huffman_node *node = huffman_tree_root(tree);
     // decoding
-    for (i = offset; ; ) {
-        readed = readBuffer ? readBuffer(buffer, bufferSize, i) : 0;
+    while (error == kZXCErrorNone && writed < originSize) {
+        readed = readBuffer ? readBuffer(buffer, bufferSize, offset) : 0;
         if (readed == 0) {
             break;
         }
-        i += readed;
+        offset += readed;
         // bits
         k = BYTES_TO_BITS(readed);
         for (j = 0; j < k; j++) {
@@ -199,6 +245,11 @@ const int kHuffmanDataSize = 256;
             }
             // leaf
             if (node->lchild == NULL && node->rchild == NULL) {
+                // the encoder never emits a symbol with zero weight
+                if (unlikely(node->data->weight == 0)) {
+                    error = kZXCErrorCorrupted;
+                    break;
+                }
                 memcpy(&output[length], &node->data->symbol, symbolSize);
                 length += symbolSize;
                 writed += symbolSize;
@@ -224,6 +275,10 @@ const int kHuffmanDataSize = 256;
             break;
         }
     }
+    // bits exhausted before the origin size
+    if (error == kZXCErrorNone && writed < originSize) {
+        error = kZXCErrorTruncated;
+    }
     // ended
     if (length > 0) {
         if (writeBuffer) {
@@ -231,15 +286,261 @@ const int kHuffmanDataSize = 256;
         }
     }
     // free
-    huffman_tree_free(tree, kHuffmanDataSize);
+    arena_free(pool);
     free(data);
     free(freq);
     free(output);
     free(buffer);
     // 完成
+    if (completion) {
+        completion(error);
+    }
+}
+
++ (void)compressUsingHuffmanBlock:(const unsigned int)blockSize
+                       reuseTable:(const BOOL)reuseTable
+                          streams:(const unsigned int)streams
+                       readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+                      writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                       completion:(void (^)(void))completion {
+    // a block size out of range is rejected, nothing is written, so the decompressor reports the missing stream
+    if (blockSize < kZXCBlockSizeMin || blockSize > kZXCBlockSizeMax) {
+        if (completion) {
+            completion();
+        }
+        return;
+    }
+    // read buffer
+    unsigned char *buffer = malloc(blockSize);
+    // output: header + table + payload length + payload, a payload larger than the block is stored raw
+    unsigned int outputSize = kHuffmanBlockHeaderSize + 1 + kHuffmanDataSize / 2 + 4 + blockSize + kHuffmanBlockSlack;
+    unsigned char *output = malloc(outputSize);
+    // counts and codes of the current block
+    unsigned int counts[kHuffmanDataSize];
+    unsigned char lengths[kHuffmanDataSize];
+    unsigned int codes[kHuffmanDataSize];
+    // the previous code table
+    unsigned char previousLengths[kHuffmanDataSize];
+    unsigned int previousCodes[kHuffmanDataSize];
+    BOOL hasPrevious = NO;
+    // read length in bytes
+    unsigned int readed;
+    // temp
+    unsigned int i, last, length;
+    // format
+    const unsigned char format = streams == 4 ? kHuffmanBlockFormat4 : kHuffmanBlockFormat;
+    const unsigned int overhead = format == kHuffmanBlockFormat4 ? HUFFMAN_JUMP_TABLE_SIZE + 3 : 0;
+    if (writeBuffer) {
+        writeBuffer(&format, sizeof(format));
+    }
+    for (unsigned long long offset = 0; ; offset += readed) {
+        readed = readBuffer ? readBuffer(buffer, blockSize, offset) : 0;
+        if (readed == 0) {
+            break;
+        }
+        // statistics of this block only
+        histogram_count(buffer, readed, counts);
+        huffman_code_lengths(counts, lengths, kHuffmanDataSize, HUFFMAN_MAX_BITS);
+        last = kHuffmanDataSize - 1;
+        while (last > 0 && lengths[last] == 0) {
+            last--;
+        }
+        // table: last symbol + 4-bit lengths of symbols [0, last]
+        unsigned long long tableBits = BYTES_TO_BITS(1 + (last + 2) / 2);
+        unsigned long long newBits = huffman_encoded_bits(counts, lengths, kHuffmanDataSize) + tableBits;
+        unsigned long long repeatBits = hasPrevious && reuseTable ? huffman_encoded_bits(counts, previousLengths, kHuffmanDataSize) : ~0ULL;
+        HuffmanBlockType type = repeatBits <= newBits ? kHuffmanBlockRepeat : kHuffmanBlockTable;
+        // not smaller than the raw bytes
+        if (BITS_TO_BYTES(MIN(newBits, repeatBits)) + 4 + overhead >= readed) {
+            type = kHuffmanBlockRaw;
+        }
+        // header
+        output[0] = type;
+        output[1] = (unsigned char)(readed >> 24);
+        output[2] = (unsigned char)(readed >> 16);
+        output[3] = (unsigned char)(readed >> 8);
+        output[4] = (unsigned char)readed;
+        length = kHuffmanBlockHeaderSize;
+        if (type == kHuffmanBlockRaw) {
+            memcpy(&output[length], buffer, readed);
+            length += readed;
+        } else {
+            if (type == kHuffmanBlockTable) {
+                output[length++] = (unsigned char)last;
+                for (i = 0; i <= last; i += 2) {
+                    output[length++] = (unsigned char)(lengths[i] << 4 | (i + 1 <= last ? lengths[i + 1] : 0));
+                }
+                huffman_canonical_codes(lengths, codes, kHuffmanDataSize);
+                memcpy(previousLengths, lengths, sizeof(lengths));
+                memcpy(previousCodes, codes, sizeof(codes));
+                hasPrevious = YES;
+            }
+            unsigned int payload;
+            if (format == kHuffmanBlockFormat4) {
+                payload = huffman_block_encode4(buffer, readed, previousLengths, previousCodes, &output[length + 4]);
+            } else {
+                payload = huffman_block_encode(buffer, readed, previousLengths, previousCodes, &output[length + 4]);
+            }
+            output[length++] = (unsigned char)(payload >> 24);
+            output[length++] = (unsigned char)(payload >> 16);
+            output[length++] = (unsigned char)(payload >> 8);
+            output[length++] = (unsigned char)payload;
+            length += payload;
+        }
+        if (writeBuffer) {
+            writeBuffer(output, length);
+        }
+        if (readed < blockSize) {
+            break;
+        }
+    }
+    // end of stream
+    output[0] = kHuffmanBlockEnd;
+    if (writeBuffer) {
+        writeBuffer(output, 1);
+    }
+    // free
+    free(output);
+    free(buffer);
+    // completion
     if (completion) {
         completion();
     }
 }
 
++ (void)decompressUsingHuffmanBlock:(const unsigned int)blockSize
+                         readBuffer:(const unsigned int (^)(void *buffer, const unsigned int length, const unsigned long long offset))readBuffer
+                        writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer
+                         completion:(void (^)(ZXCError error))completion {
+    // no stream is made with a block size out of range
+    if (blockSize < kZXCBlockSizeMin || blockSize > kZXCBlockSizeMax) {
+        if (completion) {
+            completion(kZXCErrorCorrupted);
+        }
+        return;
+    }
+    // payload buffer, a payload is never larger than the block
+    unsigned int inputSize = blockSize + kHuffmanBlockSlack;
+    unsigned char *input = malloc(inputSize);
+    unsigned char *output = malloc(blockSize);
+    // the current code table
+    unsigned char lengths[kHuffmanDataSize];
+    unsigned short *table = malloc(sizeof(unsigned short) << HUFFMAN_MAX_BITS);
+    BOOL hasTable = NO;
+    // header
+    unsigned char header[kHuffmanBlockHeaderSize];
+    unsigned char format = 0;
+    // input offset in bytes
+    unsigned long long offset = 0;
+    // read length in bytes
+    unsigned int readed = readBuffer ? readBuffer(&format, sizeof(format), offset) : 0;
+    offset += readed;
+    // temp
+    unsigned int i, last, length, payload;
+    // error
+    ZXCError error = kZXCErrorNone;
+    if (readed != sizeof(format)) {
+        error = kZXCErrorTruncated;
+    } else if (format != kHuffmanBlockFormat && format != kHuffmanBlockFormat4) {
+        error = kZXCErrorCorrupted;
+    }
+    while (error == kZXCErrorNone) {
+        // type
+        readed = readBuffer ? readBuffer(header, 1, offset) : 0;
+        offset += readed;
+        if (readed != 1) {
+            error = kZXCErrorTruncated;
+            break;
+        }
+        if (header[0] == kHuffmanBlockEnd) {
+            break;
+        }
+        // origin length
+        readed = readBuffer ? readBuffer(&header[1], kHuffmanBlockHeaderSize - 1, offset) : 0;
+        offset += readed;
+        if (readed != kHuffmanBlockHeaderSize - 1) {
+            error = kZXCErrorTruncated;
+            break;
+        }
+        length = (unsigned int)header[1] << 24 | header[2] << 16 | header[3] << 8 | header[4];
+        if (unlikely((header[0] > kHuffmanBlockRepeat) | (length - 1 >= blockSize) | ((header[0] == kHuffmanBlockRepeat) & !hasTable))) {
+            error = kZXCErrorCorrupted;
+            break;
+        }
+        if (header[0] == kHuffmanBlockRaw) {
+            readed = readBuffer ? readBuffer(output, length, offset) : 0;
+            offset += readed;
+            if (readed != length) {
+                error = kZXCErrorTruncated;
+                break;
+            }
+        } else {
+            // new table
+            if (header[0] == kHuffmanBlockTable) {
+                readed = readBuffer ? readBuffer(input, 1, offset) : 0;
+                offset += readed;
+                if (readed != 1) {
+                    error = kZXCErrorTruncated;
+                    break;
+                }
+                last = input[0];
+                readed = readBuffer(input, (last + 2) / 2, offset);
+                offset += readed;
+                if (readed != (last + 2) / 2) {
+                    error = kZXCErrorTruncated;
+                    break;
+                }
+                memset(lengths, 0, sizeof(lengths));
+                for (i = 0; i <= last; i++) {
+                    lengths[i] = i % 2 ? input[i / 2] & 0x0F : input[i / 2] >> 4;
+                }
+                if (unlikely(huffman_decode_table(lengths, table) != 0)) {
+                    error = kZXCErrorCorrupted;
+                    break;
+                }
+                hasTable = YES;
+            }
+            // payload
+            readed = readBuffer ? readBuffer(input, 4, offset) : 0;
+            offset += readed;
+            if (readed != 4) {
+                error = kZXCErrorTruncated;
+                break;
+            }
+            payload = (unsigned int)input[0] << 24 | input[1] << 16 | input[2] << 8 | input[3];
+            if (unlikely(payload > inputSize)) {
+                error = kZXCErrorCorrupted;
+                break;
+            }
+            readed = readBuffer ? readBuffer(input, payload, offset) : 0;
+            offset += readed;
+            if (readed != payload) {
+                error = kZXCErrorTruncated;
+                break;
+            }
+            int result;
+            if (format == kHuffmanBlockFormat4) {
+                result = huffman_block_decode4(input, payload, table, output, length);
+            } else {
+                result = huffman_block_decode(input, payload, table, output, length);
+            }
+            if (unlikely(result != 0)) {
+                error = kZXCErrorCorrupted;
+                break;
+            }
+        }
+        if (writeBuffer) {
+            writeBuffer(output, length);
+        }
+    }
+    // free
+    free(table);
+    free(output);
+    free(input);
+    // completion
+    if (completion) {
+        completion(error);
+    }
+}
+
 @end
@@ -0,0 +1,118 @@
+//
+// arena.c
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "arena.h"
+
+// 向上取整为 ARENA_ALIGNMENT 的倍数
+static inline size_t arena_align(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+// 块头和数据在一次分配中, 数据按 ARENA_ALIGNMENT 对齐
+static arena_chunk * arena_chunk_new(size_t size) {
+    arena_chunk *chunk = malloc(arena_align(sizeof(arena_chunk)) + size);
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    chunk->data = (unsigned char *)chunk + arena_align(sizeof(arena_chunk));
+    return chunk;
+}
+
+static void arena_chunk_free_all(arena_chunk *chunk) {
+    while (chunk) {
+        arena_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
+arena * arena_new(size_t chunk_size) {
+    arena *pool = malloc(sizeof(arena));
+    pool->chunk_size = chunk_size > 0 ? arena_align(chunk_size) : ARENA_CHUNK_SIZE;
+    pool->chunk = NULL;
+    pool->spare = NULL;
+    return pool;
+}
+
+void arena_free(arena *arena) {
+    if (arena) {
+        arena_chunk_free_all(arena->chunk);
+        arena_chunk_free_all(arena->spare);
+        free(arena);
+    }
+}
+
+void * arena_alloc(arena *arena, size_t size) {
+    size = arena_align(size > 0 ? size : 1);
+    arena_chunk *chunk = arena->chunk;
+    if (chunk == NULL || chunk->size - chunk->used < size) {
+        // 先用释放的块, 大小不够的留在原处
+        arena_chunk **link = &arena->spare;
+        while (*link && (*link)->size < size) {
+            link = &(*link)->next;
+        }
+        if (*link) {
+            chunk = *link;
+            *link = chunk->next;
+        } else {
+            chunk = arena_chunk_new(size > arena->chunk_size ? size : arena->chunk_size);
+        }
+        chunk->used = 0;
+        chunk->next = arena->chunk;
+        arena->chunk = chunk;
+    }
+    void *memory = &chunk->data[chunk->used];
+    chunk->used += size;
+    return memory;
+}
+
+void * arena_calloc(arena *arena, size_t size) {
+    void *memory = arena_alloc(arena, size);
+    memset(memory, 0, size);
+    return memory;
+}
+
+arena_mark arena_get_mark(const arena *arena) {
+    arena_mark mark = { arena->chunk, arena->chunk ? arena->chunk->used : 0 };
+    return mark;
+}
+
+void arena_release(arena *arena, arena_mark mark) {
+    // 标记之后的块移到释放的块中
+    while (arena->chunk && arena->chunk != mark.chunk) {
+        arena_chunk *chunk = arena->chunk;
+        arena->chunk = chunk->next;
+        chunk->next = arena->spare;
+        arena->spare = chunk;
+    }
+    if (arena->chunk) {
+        arena->chunk->used = mark.used;
+    }
+}
+
+void arena_reset(arena *arena) {
+    arena_mark mark = { NULL, 0 };
+    arena_release(arena, mark);
+}
@@ -0,0 +1,121 @@
+//
+// arena.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef arena_h
+#define arena_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 默认的块大小 */
+#define ARENA_CHUNK_SIZE 65536
+
+/* 分配的对齐字节数 */
+#define ARENA_ALIGNMENT 16
+
+/* 内存块, 从 data 开始顺序分配 */
+typedef struct arena_chunk {
+    struct arena_chunk *next; // 上一个块(链表头是最新的块)
+    size_t size; // data 的字节数
+    size_t used; // 已分配的字节数
+    unsigned char *data;
+} arena_chunk;
+
+/**
+ 区域(arena)分配器
+ 顺序分配(bump), 不单独释放, arena_release 一次释放标记之后的所有分配
+ 释放的块留给之后的分配, 不还给系统, 直到 arena_free
+ 一个区域只能在一个线程中使用, 多个线程各用各的区域, 不竞争 malloc 的锁
+ */
+typedef struct arena {
+    size_t chunk_size; // 新块的大小
+    arena_chunk *chunk; // 当前的块
+    arena_chunk *spare; // 释放的块
+} arena;
+
+/* 标记, 区域当前的位置 */
+typedef struct arena_mark {
+    arena_chunk *chunk;
+    size_t used;
+} arena_mark;
+
+/**
+ 创建区域
+ 
+ @param chunk_size 块大小, 0 为 ARENA_CHUNK_SIZE, 大于它的分配单独占用一个块
+ @return 区域
+ */
+extern arena * arena_new(size_t chunk_size);
+
+/**
+ 释放区域和所有分配的内存
+ 
+ @param arena 区域
+ */
+extern void arena_free(arena *arena);
+
+/**
+ 分配内存(ARENA_ALIGNMENT 字节对齐, 不清零)
+ 
+ @param arena 区域
+ @param size 字节数
+ @return 内存, 在区域释放或者 arena_release 到更早的标记之前有效
+ */
+extern void * arena_alloc(arena *arena, size_t size);
+
+/**
+ 分配内存并清零
+ 
+ @param arena 区域
+ @param size 字节数
+ @return 内存
+ */
+extern void * arena_calloc(arena *arena, size_t size);
+
+/**
+ 当前的位置
+ 
+ @param arena 区域
+ @return 标记
+ */
+extern arena_mark arena_get_mark(const arena *arena);
+
+/**
+ 释放标记之后的所有分配, O(块数), 与分配的次数无关
+ 
+ @param arena 区域
+ @param mark arena_get_mark 返回的标记, 标记之前的分配不变
+ */
+extern void arena_release(arena *arena, arena_mark mark);
+
+/**
+ 释放所有分配
+ 
+ @param arena 区域
+ */
+extern void arena_reset(arena *arena);
+
+#endif /* arena_h */
@@ -24,20 +24,23 @@
 
 
 #include "bitbyte.h"
+#include "cpu.h"
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITBYTE_X86 1
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define BITBYTE_NEON 1
+#endif
 
 int bit_get(const unsigned char *bits, int pos) {
-    unsigned char mask = 0x80;
-    for (int i = 0; i < (pos % 8); i++) {
-        mask = mask >> 1;
-    }
-    return (((mask & bits[(int)(pos / 8)]) == mask) ? 1 : 0);
+    return (bits[pos / 8] >> (7 - pos % 8)) & 1;
 }
 
 void bit_set(unsigned char *bits, int pos, int state) {
-    unsigned char mask = 0x80;
-    for (int i = 0; i < (pos % 8); i++) {
-        mask = mask >> 1;
-    }
+    unsigned char mask = 0x80 >> (pos % 8);
     if (state) {
         bits[pos/8] = bits[pos/8] | mask;
     } else {
@@ -80,33 +83,168 @@ void network_to_host_byte_order(void *target, const void *source, unsigned int l
     host_to_network_byte_order(target, source, length);
 }
 
+// 每次比较 8 字节, 第一个不同的字节由 XOR 结果的 0 位数决定
+static unsigned int match_length_word(const unsigned char *a, const unsigned char *b, const unsigned int limit) {
+    unsigned int length = 0;
+    while (length + sizeof(uint64_t) <= limit) {
+        uint64_t x, y;
+        memcpy(&x, &a[length], sizeof(x));
+        memcpy(&y, &b[length], sizeof(y));
+        uint64_t diff = x ^ y;
+        if (diff) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            return length + (__builtin_clzll(diff) >> 3);
+#else
+            return length + (__builtin_ctzll(diff) >> 3);
+#endif
+        }
+        length += sizeof(uint64_t);
+    }
+    while (length < limit && a[length] == b[length]) {
+        length++;
+    }
+    return length;
+}
+
+#if BITBYTE_X86
+// 每次比较 16 字节, movemask 取出每个字节的比较结果
+__attribute__((target("sse2")))
+static unsigned int match_length_sse2(const unsigned char *a, const unsigned char *b, const unsigned int limit) {
+    unsigned int length = 0;
+    while (length + sizeof(__m128i) <= limit) {
+        __m128i x = _mm_loadu_si128((const __m128i *)&a[length]);
+        __m128i y = _mm_loadu_si128((const __m128i *)&b[length]);
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) ^ 0xFFFFu;
+        if (mask) {
+            return length + __builtin_ctz(mask);
+        }
+        length += sizeof(__m128i);
+    }
+    return length + match_length_word(&a[length], &b[length], limit - length);
+}
+
+// 每次比较 32 字节
+__attribute__((target("avx2")))
+static unsigned int match_length_avx2(const unsigned char *a, const unsigned char *b, const unsigned int limit) {
+    unsigned int length = 0;
+    while (length + sizeof(__m256i) <= limit) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)&a[length]);
+        __m256i y = _mm256_loadu_si256((const __m256i *)&b[length]);
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)) ^ 0xFFFFFFFFu;
+        if (mask) {
+            return length + __builtin_ctz(mask);
+        }
+        length += sizeof(__m256i);
+    }
+    return length + match_length_sse2(&a[length], &b[length], limit - length);
+}
+
+// 每次比较 64 字节, 比较结果直接是 64 位掩码
+__attribute__((target("avx512f,avx512bw")))
+static unsigned int match_length_avx512(const unsigned char *a, const unsigned char *b, const unsigned int limit) {
+    unsigned int length = 0;
+    while (length + sizeof(__m512i) <= limit) {
+        __m512i x = _mm512_loadu_si512((const void *)&a[length]);
+        __m512i y = _mm512_loadu_si512((const void *)&b[length]);
+        unsigned long long mask = ~(unsigned long long)_mm512_cmpeq_epi8_mask(x, y);
+        if (mask) {
+            return length + __builtin_ctzll(mask);
+        }
+        length += sizeof(__m512i);
+    }
+    return length + match_length_avx2(&a[length], &b[length], limit - length);
+}
+#endif
+
+#if BITBYTE_NEON
+// 每次比较 16 字节, 比较结果右移 4 位窄化为 64 位, 每个字节对应 4 位
+static unsigned int match_length_neon(const unsigned char *a, const unsigned char *b, const unsigned int limit) {
+    unsigned int length = 0;
+    while (length + sizeof(uint8x16_t) <= limit) {
+        uint8x16_t eq = vceqq_u8(vld1q_u8(&a[length]), vld1q_u8(&b[length]));
+        uint64_t mask = ~vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        if (mask) {
+            return length + (__builtin_ctzll(mask) >> 2);
+        }
+        length += sizeof(uint8x16_t);
+    }
+    return length + match_length_word(&a[length], &b[length], limit - length);
+}
+#endif
+
+typedef unsigned int (*match_length_func)(const unsigned char *a, const unsigned char *b, const unsigned int limit);
+
+// 按优先级排列, 最后一个是可移植的实现
+static const cpu_kernel match_length_kernels[] = {
+#if BITBYTE_X86
+    {"avx512", CPU_AVX512, (cpu_func)match_length_avx512},
+    {"avx2", CPU_AVX2, (cpu_func)match_length_avx2},
+    {"sse2", CPU_SSE2, (cpu_func)match_length_sse2},
+#elif BITBYTE_NEON
+    {"neon", CPU_NEON, (cpu_func)match_length_neon},
+#endif
+    {"word", 0, (cpu_func)match_length_word},
+};
+
+// 自检: 在每个长度的每个位置放一个不同的字节, 结果必须与逐字节比较相同
+static int match_length_self_test(cpu_func func) {
+    static const unsigned int limits[] = {0, 1, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129, 200};
+    unsigned char a[256], b[256];
+    for (int i = 0; i < sizeof(a); i++) {
+        a[i] = b[i] = (unsigned char)(i * 131 + 7);
+    }
+    for (int i = 0; i < sizeof(limits) / sizeof(limits[0]); i++) {
+        unsigned int limit = limits[i];
+        for (unsigned int diff = 0; diff <= limit; diff++) {
+            b[diff] ^= 0x10;
+            unsigned int length = ((match_length_func)func)(a, b, limit);
+            b[diff] ^= 0x10;
+            if (length != (diff < limit ? diff : limit)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+static unsigned int match_length_init(const unsigned char *a, const unsigned char *b, const unsigned int limit);
+
+// 第一次调用时选择实现, 之后直接调用选中的实现(重复赋值的结果相同, 多线程下无害)
+static match_length_func match_length_impl = match_length_init;
+
+static unsigned int match_length_init(const unsigned char *a, const unsigned char *b, const unsigned int limit) {
+    const cpu_kernel *kernel = cpu_kernel_select(match_length_kernels, sizeof(match_length_kernels) / sizeof(match_length_kernels[0]), match_length_self_test);
+    match_length_func func = (match_length_func)kernel->func;
+    match_length_impl = func;
+    return func(a, b, limit);
+}
+
+unsigned int match_length(const unsigned char *a, const unsigned char *b, const unsigned int limit) {
+    return match_length_impl(a, b, limit);
+}
+
 char search_bytes(const unsigned char *buffer, const unsigned int buffer_len, const unsigned char *bytes, const unsigned int bytes_len, unsigned int *offset, unsigned int *length) {
     // 初始化
     char byte = bytes[0];
     *offset = 0;
     *length = 0;
     //
-    int i,j,k,l;
+    unsigned int i,l,limit;
     for (i = 1; i < buffer_len; i++) {
-        j = i;
-        k = 0;
-        l = 0;
-        // 开始匹配
-        while (j < buffer_len && k < bytes_len - 1) {
-            // 不匹配, 中断
-            if (buffer[j] != bytes[k]) {
-                break;
-            }
-            // 匹配, 继续
-            j++;
-            k++;
-            l++;
+        // 首字节不匹配, 跳过(memchr 按 CPU 选择向量实现)
+        const unsigned char *next = memchr(&buffer[i], bytes[0], buffer_len - i);
+        if (next == NULL) {
+            break;
         }
+        i = (unsigned int)(next - buffer);
+        // 开始匹配(不超出缓冲区, 留出下一个字节)
+        limit = buffer_len - i < bytes_len - 1 ? buffer_len - i : bytes_len - 1;
+        l = match_length(&buffer[i], bytes, limit);
         // 最长匹配
         if (l > *length) {
             *offset = i;
             *length = l;
-            byte = bytes[k];
+            byte = bytes[l];
         }
     }
     return byte;
@@ -28,13 +28,25 @@
 #include <math.h>
 #include <string.h>
 
+/**
+ Branch prediction hint for the rarely taken error paths
+
+ @param x Condition
+ @return Condition
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define unlikely(x) __builtin_expect(!!(x), 0)
+#else
+#define unlikely(x) (x)
+#endif
+
 /**
  Convert bits to (8-bit) bytes
 
  @param bits Number of bits
  @return Number of bytes
  */
-#define BITS_TO_BYTES(bits) (bits / 8 + (bits % 8 ? 1 : 0))
+#define BITS_TO_BYTES(bits) ((bits) / 8 + ((bits) % 8 ? 1 : 0))
 
 /**
  Convert (8-bit) bytes to bits
@@ -42,7 +54,7 @@
  @param bytes Number of bytes
  @return Number of bits
  */
-#define BYTES_TO_BITS(bytes) (bytes * 8)
+#define BYTES_TO_BITS(bytes) ((bytes) * 8)
 
 /**
  获取指定二进制位的值
@@ -103,6 +115,18 @@ extern void host_to_network_byte_order(void *target, const void *source, unsigne
  */
 extern void network_to_host_byte_order(void *target, const void *source, unsigned int length);
 
+/**
+ 比较两个字节流, 返回相同前缀的长度(匹配长度)
+ 第一次调用时按 cpu_features() 选择实现(通过自检才使用): AVX-512 每次 64 字节, AVX2 每次 32 字节,
+ SSE2/NEON 每次 16 字节, 其他平台每次 8 字节(XOR 后数尾部的 0 位)
+ 
+ @param a 字节流 a
+ @param b 字节流 b
+ @param limit 最大比较长度, a 和 b 都必须至少有 limit 个字节可读
+ @return 匹配长度, [0, limit]
+ */
+extern unsigned int match_length(const unsigned char *a, const unsigned char *b, const unsigned int limit);
+
 /**
  在缓冲区(buffer)中搜索与字节流(bytes)最长的匹配(longest match)
  
@@ -0,0 +1,72 @@
+//
+// chunker.c
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "chunker.h"
+
+// splitmix64 伪随机数
+static unsigned long long chunker_random(unsigned long long *state) {
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void chunker_init(chunker *chunker) {
+    unsigned long long state = 0x5A58432D43444331ULL;
+    for (int i = 0; i < 256; i++) {
+        chunker->gear[i] = chunker_random(&state);
+    }
+    // 哈希每次左移一位, 高位包含最近 64 个字节的信息, 掩码取高位
+    // 平均大小 8 KB(13 位), 之前多 2 位, 之后少 2 位(归一化分块, 大小更集中)
+    chunker->mask_small = ((1ULL << 15) - 1) << (64 - 15);
+    chunker->mask_large = ((1ULL << 11) - 1) << (64 - 11);
+}
+
+unsigned int chunker_next(const chunker *chunker, const unsigned char *bytes, const unsigned long long length) {
+    if (length <= CHUNK_MIN_SIZE) {
+        return (unsigned int)length;
+    }
+    unsigned int size = length < CHUNK_MAX_SIZE ? (unsigned int)length : CHUNK_MAX_SIZE;
+    unsigned int normal = size < CHUNK_AVG_SIZE ? size : CHUNK_AVG_SIZE;
+    unsigned long long hash = 0;
+    unsigned int i = CHUNK_MIN_SIZE;
+    // 最小分块之前的字节不影响切分, 从最小分块的前 64 个字节开始计算哈希
+    for (unsigned int j = CHUNK_MIN_SIZE - 64; j < CHUNK_MIN_SIZE; j++) {
+        hash = (hash << 1) + chunker->gear[bytes[j]];
+    }
+    for (; i < normal; i++) {
+        hash = (hash << 1) + chunker->gear[bytes[i]];
+        if ((hash & chunker->mask_small) == 0) {
+            return i + 1;
+        }
+    }
+    for (; i < size; i++) {
+        hash = (hash << 1) + chunker->gear[bytes[i]];
+        if ((hash & chunker->mask_large) == 0) {
+            return i + 1;
+        }
+    }
+    return size;
+}
@@ -0,0 +1,65 @@
+//
+// chunker.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef chunker_h
+#define chunker_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 分块大小(字节): 最小, 平均, 最大 */
+#define CHUNK_MIN_SIZE 2048
+#define CHUNK_AVG_SIZE 8192
+#define CHUNK_MAX_SIZE 65536
+
+/**
+ 按内容分块(content-defined chunking, FastCDC)
+ Gear 滚动哈希只看最近 64 个字节, 插入或删除数据只影响附近的分块边界, 其余分块不变
+ */
+typedef struct chunker {
+    unsigned long long gear[256]; // 每个字节值的随机数
+    unsigned long long mask_small; // 平均大小之前的掩码(位数多, 难切分)
+    unsigned long long mask_large; // 平均大小之后的掩码(位数少, 易切分)
+} chunker;
+
+/**
+ 初始化分块器(固定的随机数, 相同的内容总是得到相同的分块)
+ 
+ @param chunker 分块器
+ */
+extern void chunker_init(chunker *chunker);
+
+/**
+ 下一个分块的长度
+ 
+ @param chunker 分块器
+ @param bytes 剩余的字节流
+ @param length 剩余的字节数
+ @return 分块长度, [min(length, CHUNK_MIN_SIZE), min(length, CHUNK_MAX_SIZE)]
+ */
+extern unsigned int chunker_next(const chunker *chunker, const unsigned char *bytes, const unsigned long long length);
+
+#endif /* chunker_h */
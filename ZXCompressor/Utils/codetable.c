@@ -0,0 +1,216 @@
+//
+// codetable.c
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "codetable.h"
+#include "hash.h"
+
+// (前缀, 符号) 的哈希槽位置
+static inline unsigned int code_table_slot(const code_table *table, unsigned int prefix, unsigned char symbol) {
+    return hash_index(hash_roll(prefix, symbol), table->bits);
+}
+
+// 槽中是当前有效的编码: 初始编码(代 0)或者当前代的编码
+static inline int code_table_valid(const code_table *table, unsigned int slot) {
+    return table->slot_code[slot] != CODE_TABLE_NONE && (table->slot_generation[slot] == 0 || table->slot_generation[slot] == table->generation);
+}
+
+code_table * code_table_new(unsigned int capacity, code_table_policy policy) {
+    code_table *table = malloc(sizeof(code_table));
+    table->capacity = capacity;
+    table->base = 0;
+    table->next = 0;
+    table->generation = 0;
+    // 哈希槽不少于编码个数的 2 倍, 查找平均不到 2 次
+    table->bits = 1;
+    while (table->bits < 31 && (1U << table->bits) < capacity * 2ULL) {
+        table->bits++;
+    }
+    table->prefix = malloc(capacity * sizeof(unsigned int));
+    table->length = calloc(capacity, sizeof(unsigned int));
+    table->symbol = calloc(capacity, sizeof(unsigned char));
+    table->slot_code = malloc((1U << table->bits) * sizeof(unsigned int));
+    table->slot_generation = calloc(1U << table->bits, sizeof(unsigned int));
+    memset(table->prefix, 0xFF, capacity * sizeof(unsigned int));
+    memset(table->slot_code, 0xFF, (1U << table->bits) * sizeof(unsigned int));
+    table->policy = policy;
+    table->plain = 0;
+    table->coded = 0;
+    // 词典小的话填满得快, 检查也要勤一些
+    table->gap = capacity >> CODE_TABLE_CHECK_SHIFT;
+    if (table->gap < CODE_TABLE_CHECK_MIN) {
+        table->gap = CODE_TABLE_CHECK_MIN;
+    }
+    table->checkpoint = table->gap;
+    table->ratio = 0;
+    return table;
+}
+
+void code_table_free(code_table *table) {
+    if (table) {
+        free(table->prefix);
+        free(table->length);
+        free(table->symbol);
+        free(table->slot_code);
+        free(table->slot_generation);
+        free(table);
+    }
+}
+
+code_table * code_table_copy(const code_table *table) {
+    code_table *copy = malloc(sizeof(code_table));
+    unsigned int slots = 1U << table->bits;
+    *copy = *table;
+    copy->prefix = malloc(table->capacity * sizeof(unsigned int));
+    copy->length = malloc(table->capacity * sizeof(unsigned int));
+    copy->symbol = malloc(table->capacity * sizeof(unsigned char));
+    copy->slot_code = malloc(slots * sizeof(unsigned int));
+    copy->slot_generation = malloc(slots * sizeof(unsigned int));
+    memcpy(copy->prefix, table->prefix, table->capacity * sizeof(unsigned int));
+    memcpy(copy->length, table->length, table->capacity * sizeof(unsigned int));
+    memcpy(copy->symbol, table->symbol, table->capacity * sizeof(unsigned char));
+    memcpy(copy->slot_code, table->slot_code, slots * sizeof(unsigned int));
+    memcpy(copy->slot_generation, table->slot_generation, slots * sizeof(unsigned int));
+    return copy;
+}
+
+// 加入哈希槽, 线性探测, 过期的槽可以重用
+static void code_table_insert(code_table *table, unsigned int code) {
+    unsigned int mask = (1U << table->bits) - 1;
+    unsigned int slot = code_table_slot(table, table->prefix[code], table->symbol[code]);
+    while (code_table_valid(table, slot)) {
+        slot = (slot + 1) & mask;
+    }
+    table->slot_code[slot] = code;
+    table->slot_generation[slot] = table->generation;
+}
+
+void code_table_set(code_table *table, unsigned int code, unsigned int prefix, unsigned char symbol, unsigned int length) {
+    if (code >= table->capacity) {
+        return;
+    }
+    table->prefix[code] = prefix;
+    table->symbol[code] = symbol;
+    table->length[code] = length;
+    // 根编码不用查找
+    if (prefix != CODE_TABLE_NONE) {
+        code_table_insert(table, code);
+    }
+}
+
+void code_table_prime(code_table *table, hashtable *strings, unsigned int root) {
+    for (int i = 0; i < 1 << strings->bits; i++) {
+        for (hashnode *node = &strings->node[i]; node != NULL; node = node->next) {
+            if (node->key == NULL || node->value == NULL || node->key->length == 0) {
+                continue;
+            }
+            const unsigned char *string = node->key->data;
+            int length = node->key->length;
+            unsigned int code = 0, prefix = root;
+            memcpy(&code, node->value->data, node->value->length < (int)sizeof(code) ? node->value->length : sizeof(code));
+            // 单字节的 LZW 编码是根编码, 已在词典中
+            if (length == 1 && root == CODE_TABLE_NONE) {
+                continue;
+            }
+            // 前缀的编码
+            if (length > 1) {
+                hashnode *parent = hashtable_get_node(strings, string, length - 1);
+                if (parent == NULL) {
+                    continue;
+                }
+                prefix = 0;
+                memcpy(&prefix, parent->value->data, parent->value->length < (int)sizeof(prefix) ? parent->value->length : sizeof(prefix));
+            }
+            code_table_set(table, code, prefix, string[length - 1], length);
+        }
+    }
+}
+
+void code_table_seal(code_table *table, unsigned int next) {
+    table->base = next < table->capacity ? next : table->capacity;
+    table->next = table->base;
+    table->generation = 1;
+}
+
+void code_table_reset(code_table *table) {
+    table->next = table->base;
+    table->generation++;
+    // 代用完了(2^32 次清空), 清除所有非初始的槽
+    if (table->generation == 0) {
+        for (unsigned int slot = 0; slot < 1U << table->bits; slot++) {
+            if (table->slot_generation[slot] != 0) {
+                table->slot_code[slot] = CODE_TABLE_NONE;
+            }
+        }
+        table->generation = 1;
+    }
+    table->plain = 0;
+    table->coded = 0;
+    table->checkpoint = table->gap;
+    table->ratio = 0;
+}
+
+unsigned int code_table_find(const code_table *table, unsigned int prefix, unsigned char symbol) {
+    unsigned int mask = (1U << table->bits) - 1;
+    unsigned int slot = code_table_slot(table, prefix, symbol);
+    while (code_table_valid(table, slot)) {
+        unsigned int code = table->slot_code[slot];
+        if (table->prefix[code] == prefix && table->symbol[code] == symbol) {
+            return code;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return CODE_TABLE_NONE;
+}
+
+void code_table_add(code_table *table, unsigned int prefix, unsigned char symbol) {
+    unsigned int code = table->next++;
+    table->prefix[code] = prefix;
+    table->symbol[code] = symbol;
+    table->length[code] = table->length[prefix] + 1;
+    code_table_insert(table, code);
+}
+
+void code_table_string(const code_table *table, unsigned int code, unsigned char *output) {
+    for (unsigned int i = table->length[code]; i > 0; i--) {
+        output[i - 1] = table->symbol[code];
+        code = table->prefix[code];
+    }
+}
+
+int code_table_full(code_table *table) {
+    if (table->policy == CODE_TABLE_RESET) {
+        return 1;
+    }
+    if (table->plain < table->checkpoint) {
+        return 0;
+    }
+    table->checkpoint = table->plain + table->gap;
+    // 压缩率还在上升, 保留
+    unsigned long long ratio = table->coded > 0 ? (table->plain << 8) / table->coded : ~0ULL;
+    if (ratio > table->ratio) {
+        table->ratio = ratio;
+        return 0;
+    }
+    return 1;
+}
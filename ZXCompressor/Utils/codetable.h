@@ -0,0 +1,182 @@
+//
+// codetable.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef codetable_h
+#define codetable_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hashtable.h"
+
+/* 没有编码(根编码的前缀, 查找失败) */
+#define CODE_TABLE_NONE 0xFFFFFFFFU
+
+/* 词典满了以后, 每隔 capacity >> CODE_TABLE_CHECK_SHIFT 字节(原始数据)检查一次压缩率, 至少 CODE_TABLE_CHECK_MIN 字节 */
+#define CODE_TABLE_CHECK_SHIFT 3
+#define CODE_TABLE_CHECK_MIN 256
+
+/* 词典满了以后的策略 */
+typedef enum {
+    CODE_TABLE_RESET = 0, // 立即清空(原来的格式)
+    CODE_TABLE_MONITOR, // 保留, 压缩率下降时才清空(compress(1))
+} code_table_policy;
+
+/**
+ LZ78/LZW 的编码词典, 容量固定
+ 每个编码是 (前缀编码, 符号), 字符串是前缀的字符串加上符号, 编码端按 (前缀, 符号) 在哈希槽中查找, 解码端沿前缀倒着展开
+ 所有的数组在创建时一次分配, 清空时不释放也不重建: 哈希槽记录加入时的代, 清空只是换一代, 旧的槽视为空
+ 初始编码(单字节, 预置字典)的代是 0, 清空后保留
+ */
+typedef struct code_table {
+    unsigned int capacity; // 编码个数
+    unsigned int base; // 初始编码个数, 清空后从这里开始
+    unsigned int next; // 下个编码
+    unsigned int generation; // 当前的代
+    unsigned int bits; // 哈希槽有 1 << bits 个, 不少于编码个数的 2 倍
+    unsigned int *prefix; // 编码 -> 前缀编码
+    unsigned int *length; // 编码 -> 字符串长度
+    unsigned char *symbol; // 编码 -> 最后一个符号
+    unsigned int *slot_code; // 哈希槽 -> 编码
+    unsigned int *slot_generation; // 哈希槽 -> 代
+    code_table_policy policy;
+    unsigned long long plain; // 清空以来的原始字节数
+    unsigned long long coded; // 清空以来的编码字节数
+    unsigned int gap; // 检查压缩率的间隔(原始字节数)
+    unsigned long long checkpoint; // 下次检查压缩率的位置(原始字节数)
+    unsigned long long ratio; // 上次检查的压缩率(原始 / 编码, 8 位小数)
+} code_table;
+
+/**
+ 创建词典, 没有编码
+ 
+ @param capacity 编码个数
+ @param policy 词典满了以后的策略
+ @return 词典
+ */
+extern code_table * code_table_new(unsigned int capacity, code_table_policy policy);
+
+/**
+ 释放词典
+ 
+ @param table 词典
+ */
+extern void code_table_free(code_table *table);
+
+/**
+ 复制词典, 所有数组按块复制(memcpy), 不重新计算哈希
+ 预置字典的词典建好(code_table_seal)后保存起来, 每次编码/解码复制一份, 不用逐个加入预置的编码
+ 
+ @param table 词典
+ @return 新的词典, 容量, 策略和编码都相同
+ */
+extern code_table * code_table_copy(const code_table *table);
+
+/**
+ 设置初始编码, 在 code_table_seal 之前
+ 
+ @param table 词典
+ @param code 编码
+ @param prefix 前缀编码, 根编码(LZW 的单字节, LZ78 的空字符串)为 CODE_TABLE_NONE
+ @param symbol 最后一个符号
+ @param length 字符串长度
+ */
+extern void code_table_set(code_table *table, unsigned int code, unsigned int prefix, unsigned char symbol, unsigned int length);
+
+/**
+ 加入预置字典的编码(hashtable: 字符串 -> 编码), 字符串的前缀须在 hashtable 或词典中
+ 
+ @param table 词典
+ @param strings 预置字典的编码表
+ @param root 单字节字符串的前缀编码: LZW 为 CODE_TABLE_NONE(单字节就是根编码, 已在词典中), LZ78 为空字符串的编码 0
+ */
+extern void code_table_prime(code_table *table, hashtable *strings, unsigned int root);
+
+/**
+ 初始编码设置完成, 之后加入的编码在清空时丢弃
+ 
+ @param table 词典
+ @param next 下个编码
+ */
+extern void code_table_seal(code_table *table, unsigned int next);
+
+/**
+ 清空词典, 保留初始编码, O(1)
+ 
+ @param table 词典
+ */
+extern void code_table_reset(code_table *table);
+
+/**
+ 查找 (前缀, 符号) 的编码
+ 
+ @param table 词典
+ @param prefix 前缀编码
+ @param symbol 符号
+ @return 编码, 没有为 CODE_TABLE_NONE
+ */
+extern unsigned int code_table_find(const code_table *table, unsigned int prefix, unsigned char symbol);
+
+/**
+ 加入 (前缀, 符号), 编码为 table->next, 词典须未满
+ 
+ @param table 词典
+ @param prefix 前缀编码, 小于 table->next
+ @param symbol 符号
+ */
+extern void code_table_add(code_table *table, unsigned int prefix, unsigned char symbol);
+
+/**
+ 展开编码的字符串
+ 
+ @param table 词典
+ @param code 编码, 小于 table->next
+ @param output 输出, table->length[code] 字节
+ */
+extern void code_table_string(const code_table *table, unsigned int code, unsigned char *output);
+
+/**
+ 统计输出的一个编码(或 LZ78 的短语), 编码端和解码端在同一位置调用, 压缩率相同
+ 
+ @param table 词典
+ @param plain 原始字节数
+ @param coded 编码字节数
+ */
+static inline void code_table_count(code_table *table, unsigned int plain, unsigned int coded) {
+    table->plain += plain;
+    table->coded += coded;
+}
+
+/**
+ 词典满了(table->next == table->capacity)时是否清空, 按策略决定
+ CODE_TABLE_RESET 总是清空, CODE_TABLE_MONITOR 每 table->gap 字节比较一次压缩率, 比上次低才清空
+ 编码端和解码端在同一位置调用, 结果相同, 不用在数据中标记
+ 
+ @param table 词典
+ @return 1 为清空(调用者调用 code_table_reset), 0 为保留
+ */
+extern int code_table_full(code_table *table);
+
+#endif /* codetable_h */
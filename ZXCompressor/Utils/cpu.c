@@ -0,0 +1,149 @@
+//
+// cpu.c
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+
+#include "cpu.h"
+#include <ctype.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_X86 1
+#endif
+
+// 特性和名称, 解析时也接受 "sse42" 和 "avx512bw"
+static const struct {
+    cpu_feature feature;
+    const char *name;
+} cpu_names[] = {
+    {CPU_SSE2, "sse2"},
+    {CPU_SSSE3, "ssse3"},
+    {CPU_SSE42, "sse4.2"},
+    {CPU_AVX2, "avx2"},
+    {CPU_AVX512, "avx512"},
+    {CPU_BMI2, "bmi2"},
+    {CPU_NEON, "neon"},
+    {CPU_SSE42, "sse42"},
+    {CPU_AVX512, "avx512bw"},
+};
+
+// 检测的结果, 最高位表示已检测(重复检测的结果相同, 多线程下无害)
+#define CPU_DETECTED 0x80000000U
+static unsigned int cpu_detected = 0;
+
+static unsigned int cpu_detect(void) {
+    unsigned int features = 0;
+#if CPU_X86
+    // __builtin_cpu_supports 同时检查了操作系统是否保存 AVX/AVX-512 寄存器
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        features |= CPU_SSE2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        features |= CPU_SSSE3;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        features |= CPU_SSE42;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        features |= CPU_AVX2;
+    }
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        features |= CPU_AVX512;
+    }
+    if (__builtin_cpu_supports("bmi2")) {
+        features |= CPU_BMI2;
+    }
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+    // arm64 都有 NEON, 32 位 ARM 编译时启用了才能用
+    features |= CPU_NEON;
+#endif
+    // 环境变量只能屏蔽特性, 不能打开 CPU 不支持的特性
+    const char *names = getenv(CPU_ENV_NAME);
+    if (names && *names) {
+        features &= cpu_features_parse(names);
+    }
+    return features;
+}
+
+unsigned int cpu_features(void) {
+    unsigned int detected = cpu_detected;
+    if (detected == 0) {
+        detected = cpu_detect() | CPU_DETECTED;
+        cpu_detected = detected;
+    }
+    return detected & ~CPU_DETECTED;
+}
+
+int cpu_supports(unsigned int features) {
+    return (cpu_features() & features) == features;
+}
+
+unsigned int cpu_features_parse(const char *names) {
+    unsigned int features = 0;
+    char name[16];
+    while (names && *names) {
+        // 下一个名称
+        size_t length = 0;
+        while (*names == ',' || isspace((unsigned char)*names)) {
+            names++;
+        }
+        while (*names && *names != ',' && !isspace((unsigned char)*names)) {
+            if (length < sizeof(name) - 1) {
+                name[length++] = (char)tolower((unsigned char)*names);
+            }
+            names++;
+        }
+        name[length] = 0;
+        // 查找
+        for (int i = 0; i < sizeof(cpu_names) / sizeof(cpu_names[0]); i++) {
+            if (strcmp(name, cpu_names[i].name) == 0) {
+                features |= cpu_names[i].feature;
+                break;
+            }
+        }
+    }
+    return features;
+}
+
+const char * cpu_feature_name(cpu_feature feature) {
+    for (int i = 0; i < sizeof(cpu_names) / sizeof(cpu_names[0]); i++) {
+        if (cpu_names[i].feature == feature) {
+            return cpu_names[i].name;
+        }
+    }
+    return NULL;
+}
+
+const cpu_kernel * cpu_kernel_select(const cpu_kernel *kernels, const int count, int (*self_test)(cpu_func func)) {
+    for (int i = 0; i < count - 1; i++) {
+        if (!cpu_supports(kernels[i].features)) {
+            continue;
+        }
+        // 自检失败(编译器或 CPU 的问题)时退回到下一个实现
+        if (self_test == NULL || self_test(kernels[i].func)) {
+            return &kernels[i];
+        }
+    }
+    return &kernels[count - 1];
+}
@@ -0,0 +1,101 @@
+//
+// cpu.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+
+#ifndef cpu_h
+#define cpu_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* CPU 特性(位掩码) */
+typedef enum {
+    CPU_SSE2 = 1 << 0,
+    CPU_SSSE3 = 1 << 1,
+    CPU_SSE42 = 1 << 2,
+    CPU_AVX2 = 1 << 3,
+    CPU_AVX512 = 1 << 4, // AVX-512 F + BW
+    CPU_BMI2 = 1 << 5,
+    CPU_NEON = 1 << 6,
+} cpu_feature;
+
+/* 环境变量: 允许使用的特性, 逗号分隔, 例如 "sse2,avx2", "none" 只用可移植的实现, 未设置或为空时不屏蔽 */
+#define CPU_ENV_NAME "ZXC_CPU"
+
+/**
+ 当前 CPU 支持的特性
+ 第一次调用时检测, 再按环境变量 CPU_ENV_NAME 屏蔽, 之后返回相同的结果
+ 
+ @return 特性的位掩码
+ */
+extern unsigned int cpu_features(void);
+
+/**
+ 是否支持所有指定的特性
+ 
+ @param features 特性的位掩码, 0 总是支持
+ @return 1 支持, 0 不支持
+ */
+extern int cpu_supports(unsigned int features);
+
+/**
+ 解析特性名称的列表, 名称不区分大小写, 未知的名称被忽略
+ 
+ @param names 逗号(或空格)分隔的名称: sse2, ssse3, sse4.2, avx2, avx512, bmi2, neon, none
+ @return 特性的位掩码
+ */
+extern unsigned int cpu_features_parse(const char *names);
+
+/**
+ 特性的名称
+ 
+ @param feature 一个特性
+ @return 名称, 未知的特性返回 NULL
+ */
+extern const char * cpu_feature_name(cpu_feature feature);
+
+/* 通用的函数指针, 内核按自己的类型转换 */
+typedef void (*cpu_func)(void);
+
+/* 内核的一个实现 */
+typedef struct cpu_kernel {
+    const char *name; // 名称
+    unsigned int features; // 需要的特性, 0 为可移植的实现
+    cpu_func func; // 实现
+} cpu_kernel;
+
+/**
+ 选择内核的实现: 按顺序取第一个 CPU 支持并且通过自检的实现
+ 实现按优先级排列, 最后一个必须是可移植的实现(不检查特性, 不自检)
+ 
+ @param kernels 实现列表
+ @param count 实现的数量
+ @param self_test 自检, 用实现算一组已知的结果, 正确返回 1; NULL 不自检
+ @return 选中的实现
+ */
+extern const cpu_kernel * cpu_kernel_select(const cpu_kernel *kernels, const int count, int (*self_test)(cpu_func func));
+
+#endif /* cpu_h */
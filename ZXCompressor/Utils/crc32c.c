@@ -0,0 +1,267 @@
+//
+// crc32c.c
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+
+#include "crc32c.h"
+#include "cpu.h"
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define CRC32C_X86 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CRC32C_ARM 1
+#endif
+
+// 反射的多项式
+#define CRC32C_POLY 0x82F63B78U
+
+// slicing-by-8 的 8 张表, table[k][b] 是字节 b 之后再跟 k 个 0 字节的 CRC
+static uint32_t crc32c_table[8][256];
+
+// 硬件实现把数据分成 3 段同时计算(crc32 指令的延迟是 3 个周期, 每个周期可以发射 1 条), 再把前面的段移过后面的长度合并
+#define CRC32C_LONG 8192
+#define CRC32C_SHORT 256
+
+// 在 CRC 后面补 CRC32C_LONG/CRC32C_SHORT 个 0 字节的运算, 按 CRC 的 4 个字节查表
+static uint32_t crc32c_long[4][256];
+static uint32_t crc32c_short[4][256];
+
+// GF(2) 上的矩阵乘向量, 矩阵的第 n 列是 mat[n]
+static uint32_t crc32c_matrix_times(const uint32_t *mat, uint32_t vec) {
+    uint32_t sum = 0;
+    for (; vec; vec >>= 1, mat++) {
+        if (vec & 1) {
+            sum ^= *mat;
+        }
+    }
+    return sum;
+}
+
+static void crc32c_matrix_square(uint32_t *square, const uint32_t *mat) {
+    for (int n = 0; n < 32; n++) {
+        square[n] = crc32c_matrix_times(mat, mat[n]);
+    }
+}
+
+// 补 length 个 0 字节的运算(矩阵), 每次平方补的 0 位数翻倍
+static void crc32c_zeros_table(uint32_t table[4][256], size_t length) {
+    uint32_t even[32], odd[32];
+    // 补 1 个 0 位
+    odd[0] = CRC32C_POLY;
+    for (int n = 1; n < 32; n++) {
+        odd[n] = 1U << (n - 1);
+    }
+    crc32c_matrix_square(even, odd); // 2 位
+    crc32c_matrix_square(odd, even); // 4 位
+    // 8 位(1 字节)起, length 只有最高位是 1(2 的幂)
+    uint32_t *op = odd;
+    do {
+        crc32c_matrix_square(even, odd);
+        op = even;
+        length >>= 1;
+        if (length == 0) {
+            break;
+        }
+        crc32c_matrix_square(odd, even);
+        op = odd;
+        length >>= 1;
+    } while (length);
+    for (unsigned int n = 0; n < 256; n++) {
+        table[0][n] = crc32c_matrix_times(op, n);
+        table[1][n] = crc32c_matrix_times(op, n << 8);
+        table[2][n] = crc32c_matrix_times(op, n << 16);
+        table[3][n] = crc32c_matrix_times(op, n << 24);
+    }
+}
+
+static inline uint32_t crc32c_shift(uint32_t table[4][256], uint32_t crc) {
+    return table[0][crc & 0xFF] ^ table[1][(crc >> 8) & 0xFF] ^ table[2][(crc >> 16) & 0xFF] ^ table[3][crc >> 24];
+}
+
+static void crc32c_table_init(void) {
+    for (unsigned int i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; j++) {
+            crc = crc & 1 ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        }
+        crc32c_table[0][i] = crc;
+    }
+    for (unsigned int i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) {
+            crc32c_table[k][i] = (crc32c_table[k - 1][i] >> 8) ^ crc32c_table[0][crc32c_table[k - 1][i] & 0xFF];
+        }
+    }
+    crc32c_zeros_table(crc32c_long, CRC32C_LONG);
+    crc32c_zeros_table(crc32c_short, CRC32C_SHORT);
+}
+
+// 每次 8 字节, 8 次查表互不依赖
+static uint32_t crc32c_slice8(uint32_t crc, const unsigned char *data, size_t length) {
+    while (length >= 8) {
+        uint32_t low = crc ^ ((uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24);
+        crc = crc32c_table[7][low & 0xFF] ^ crc32c_table[6][(low >> 8) & 0xFF] ^
+              crc32c_table[5][(low >> 16) & 0xFF] ^ crc32c_table[4][low >> 24] ^
+              crc32c_table[3][data[4]] ^ crc32c_table[2][data[5]] ^
+              crc32c_table[1][data[6]] ^ crc32c_table[0][data[7]];
+        data += 8;
+        length -= 8;
+    }
+    while (length--) {
+        crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *data++) & 0xFF];
+    }
+    return crc;
+}
+
+#if CRC32C_X86
+#if defined(__x86_64__)
+// 3 段同时计算, 每段 size 字节
+__attribute__((target("sse4.2")))
+static inline uint32_t crc32c_sse42_3way(uint32_t crc, const unsigned char *data, const size_t size) {
+    uint64_t crc0 = crc, crc1 = 0, crc2 = 0;
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t word0, word1, word2;
+        memcpy(&word0, &data[i], sizeof(word0));
+        memcpy(&word1, &data[size + i], sizeof(word1));
+        memcpy(&word2, &data[size * 2 + i], sizeof(word2));
+        crc0 = _mm_crc32_u64(crc0, word0);
+        crc1 = _mm_crc32_u64(crc1, word1);
+        crc2 = _mm_crc32_u64(crc2, word2);
+    }
+    uint32_t (*table)[256] = size == CRC32C_LONG ? crc32c_long : crc32c_short;
+    crc = crc32c_shift(table, (uint32_t)crc0) ^ (uint32_t)crc1;
+    return crc32c_shift(table, crc) ^ (uint32_t)crc2;
+}
+#endif
+
+// crc32 指令每次 8 字节(32 位平台 4 字节)
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const unsigned char *data, size_t length) {
+#if defined(__x86_64__)
+    while (length >= CRC32C_LONG * 3) {
+        crc = crc32c_sse42_3way(crc, data, CRC32C_LONG);
+        data += CRC32C_LONG * 3;
+        length -= CRC32C_LONG * 3;
+    }
+    while (length >= CRC32C_SHORT * 3) {
+        crc = crc32c_sse42_3way(crc, data, CRC32C_SHORT);
+        data += CRC32C_SHORT * 3;
+        length -= CRC32C_SHORT * 3;
+    }
+    uint64_t crc64 = crc;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        length -= 8;
+    }
+    crc = (uint32_t)crc64;
+#else
+    while (length >= 4) {
+        uint32_t word;
+        memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+        data += 4;
+        length -= 4;
+    }
+#endif
+    while (length--) {
+        crc = _mm_crc32_u8(crc, *data++);
+    }
+    return crc;
+}
+#endif
+
+#if CRC32C_ARM
+// ARMv8 的 crc32c 指令, 编译时已确定可用
+static uint32_t crc32c_armv8(uint32_t crc, const unsigned char *data, size_t length) {
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc = __crc32cd(crc, word);
+        data += 8;
+        length -= 8;
+    }
+    while (length--) {
+        crc = __crc32cb(crc, *data++);
+    }
+    return crc;
+}
+#endif
+
+typedef uint32_t (*crc32c_func)(uint32_t crc, const unsigned char *data, size_t length);
+
+// 按优先级排列, 最后一个是可移植的实现
+static const cpu_kernel crc32c_kernels[] = {
+#if CRC32C_X86
+    {"sse4.2", CPU_SSE42, (cpu_func)crc32c_sse42},
+#elif CRC32C_ARM
+    {"armv8", 0, (cpu_func)crc32c_armv8},
+#endif
+    {"slice8", 0, (cpu_func)crc32c_slice8},
+};
+
+// 自检: 标准的校验值, 以及各种长度和对齐与逐字节查表的结果相同
+static int crc32c_self_test(cpu_func func) {
+    crc32c_func crc32c = (crc32c_func)func;
+    if (~crc32c(~0U, (const unsigned char *)"123456789", 9) != 0xE3069283U) {
+        return 0;
+    }
+    unsigned char data[100];
+    for (int i = 0; i < sizeof(data); i++) {
+        data[i] = (unsigned char)(i * 131 + 7);
+    }
+    for (int start = 0; start < 8; start++) {
+        uint32_t expected = ~0U;
+        for (int length = 0; start + length <= sizeof(data); length++) {
+            if (crc32c(~0U, &data[start], length) != expected) {
+                return 0;
+            }
+            if (start + length < sizeof(data)) {
+                expected = (expected >> 8) ^ crc32c_table[0][(expected ^ data[start + length]) & 0xFF];
+            }
+        }
+    }
+    return 1;
+}
+
+static uint32_t crc32c_init(uint32_t crc, const unsigned char *data, size_t length);
+
+// 第一次调用时生成查表并选择实现(重复赋值的结果相同, 多线程下无害)
+static crc32c_func crc32c_impl = crc32c_init;
+
+static uint32_t crc32c_init(uint32_t crc, const unsigned char *data, size_t length) {
+    crc32c_table_init();
+    const cpu_kernel *kernel = cpu_kernel_select(crc32c_kernels, sizeof(crc32c_kernels) / sizeof(crc32c_kernels[0]), crc32c_self_test);
+    crc32c_func func = (crc32c_func)kernel->func;
+    crc32c_impl = func;
+    return func(crc, data, length);
+}
+
+unsigned int crc32c_update(unsigned int crc, const void *data, size_t length) {
+    return ~crc32c_impl(~crc, data, length);
+}
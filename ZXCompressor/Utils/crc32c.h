@@ -0,0 +1,46 @@
+//
+// crc32c.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+
+#ifndef crc32c_h
+#define crc32c_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ CRC-32C(Castagnoli, 多项式 0x1EDC6F41), 用于校验解压后的数据
+ 按 cpu_features() 选择实现: x86 的 SSE4.2 crc32 指令, ARMv8 的 crc32c 指令, 其他平台 slicing-by-8 查表
+ 可以分段计算: crc32c_update(crc32c_update(0, a, n), b, m) 等于 a 和 b 连在一起的结果
+ 
+ @param crc 前面数据的 CRC, 开始时为 0
+ @param data 数据
+ @param length 数据长度
+ @return 到目前为止的 CRC, crc32c_update(0, "123456789", 9) 为 0xE3069283
+ */
+extern unsigned int crc32c_update(unsigned int crc, const void *data, size_t length);
+
+#endif /* crc32c_h */
@@ -0,0 +1,123 @@
+//
+// dictionary.c
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "dictionary.h"
+#include "hash.h"
+
+#define DICTIONARY_KMER_SIZE        8 // hash8()
+#define DICTIONARY_SEGMENT_SIZE     64
+#define DICTIONARY_HASH_BITS        20
+
+typedef struct dictionary_segment {
+    unsigned long long offset;
+    unsigned int score;
+} dictionary_segment;
+
+static unsigned int dictionary_kmer_hash(const unsigned char *bytes) {
+    return hash8(bytes, DICTIONARY_HASH_BITS);
+}
+
+static int dictionary_segment_compare(const void *a, const void *b) {
+    const dictionary_segment *x = a, *y = b;
+    return x->score < y->score ? -1 : (x->score > y->score ? 1 : 0);
+}
+
+unsigned int dictionary_train(const unsigned char *samples, const unsigned int *sizes, const unsigned int count, unsigned char *dictionary, const unsigned int capacity) {
+    unsigned long long total = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        total += sizes[i];
+    }
+    // 样本不足, 直接使用全部样本
+    if (total <= capacity) {
+        memcpy(dictionary, samples, (size_t)total);
+        return (unsigned int)total;
+    }
+    // 字典放不下一个片段, 直接使用样本末尾的 capacity 字节
+    if (capacity < DICTIONARY_SEGMENT_SIZE) {
+        memcpy(dictionary, &samples[total - capacity], capacity);
+        return capacity;
+    }
+    // k-mer 出现在多少个样本中(document frequency), 同一个样本只计一次
+    unsigned int hash_size = 1 << DICTIONARY_HASH_BITS;
+    unsigned int *freq = calloc(hash_size, sizeof(unsigned int));
+    unsigned int *seen = calloc(hash_size, sizeof(unsigned int));
+    unsigned long long start = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        for (unsigned int j = 0; j + DICTIONARY_KMER_SIZE <= sizes[i]; j++) {
+            unsigned int h = dictionary_kmer_hash(&samples[start + j]);
+            if (seen[h] != i + 1) {
+                seen[h] = i + 1;
+                freq[h]++;
+            }
+        }
+        start += sizes[i];
+    }
+    // 每段选出得分最高的片段
+    unsigned int segments = capacity / DICTIONARY_SEGMENT_SIZE;
+    unsigned long long epoch = total / segments;
+    dictionary_segment *picked = calloc(segments, sizeof(dictionary_segment));
+    unsigned int picked_count = 0;
+    for (unsigned int i = 0; i < segments; i++) {
+        unsigned long long begin = epoch * i;
+        unsigned long long end = i + 1 < segments ? begin + epoch : total;
+        if (end - begin < DICTIONARY_SEGMENT_SIZE) {
+            continue;
+        }
+        // 滑动窗口: 片段的得分是其中所有 k-mer 的出现次数之和
+        unsigned int kmers = DICTIONARY_SEGMENT_SIZE - DICTIONARY_KMER_SIZE + 1;
+        unsigned long long score = 0, best_score = 0, best_offset = begin;
+        for (unsigned long long j = begin; j + DICTIONARY_KMER_SIZE <= end; j++) {
+            score += freq[dictionary_kmer_hash(&samples[j])];
+            if (j >= begin + kmers) {
+                score -= freq[dictionary_kmer_hash(&samples[j - kmers])];
+            }
+            if (j + 1 >= begin + kmers && score > best_score) {
+                best_score = score;
+                best_offset = j + 1 - kmers;
+            }
+        }
+        if (best_score == 0) {
+            continue;
+        }
+        // 已选中的 k-mer 不再计分, 避免重复的片段
+        for (unsigned int j = 0; j < kmers; j++) {
+            freq[dictionary_kmer_hash(&samples[best_offset + j])] = 0;
+        }
+        picked[picked_count].offset = best_offset;
+        picked[picked_count].score = (unsigned int)(best_score > 0xFFFFFFFF ? 0xFFFFFFFF : best_score);
+        picked_count++;
+    }
+    // 得分高的放在末尾
+    qsort(picked, picked_count, sizeof(dictionary_segment), dictionary_segment_compare);
+    unsigned int length = 0;
+    for (unsigned int i = 0; i < picked_count; i++) {
+        memcpy(&dictionary[length], &samples[picked[i].offset], DICTIONARY_SEGMENT_SIZE);
+        length += DICTIONARY_SEGMENT_SIZE;
+    }
+    free(picked);
+    free(seen);
+    free(freq);
+    return length;
+}
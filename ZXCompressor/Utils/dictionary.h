@@ -0,0 +1,47 @@
+//
+// dictionary.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef dictionary_h
+#define dictionary_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ 从样本中训练字典(COVER 算法的简化版)
+ 把样本分成若干段(epoch), 每段选出 k-mer 在所有样本中出现最多的片段(segment),
+ 得分高的片段放在字典的末尾, 离待压缩的数据最近(偏移量最小)
+ 
+ @param samples 样本(首尾相连)
+ @param sizes 每个样本的长度
+ @param count 样本数量
+ @param dictionary 输出字典
+ @param capacity 字典的最大长度, 小于一个片段(64 字节)时取样本末尾的 capacity 字节
+ @return 字典长度
+ */
+extern unsigned int dictionary_train(const unsigned char *samples, const unsigned int *sizes, const unsigned int count, unsigned char *dictionary, const unsigned int capacity);
+
+#endif /* dictionary_h */
@@ -0,0 +1,240 @@
+//
+// entropy.c
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <math.h>
+#include "entropy.h"
+#include "histogram.h"
+#include "bitbyte.h"
+
+static inline void entropy_write_u32(unsigned char *output, const unsigned int value) {
+    output[0] = (unsigned char)(value >> 24);
+    output[1] = (unsigned char)(value >> 16);
+    output[2] = (unsigned char)(value >> 8);
+    output[3] = (unsigned char)value;
+}
+
+static inline unsigned int entropy_read_u32(const unsigned char *input) {
+    return (unsigned int)input[0] << 24 | input[1] << 16 | input[2] << 8 | input[3];
+}
+
+static unsigned int entropy_store(const unsigned char *input, const unsigned int length, unsigned char *output) {
+    output[0] = ENTROPY_RAW;
+    memcpy(&output[1], input, length);
+    return 1 + length;
+}
+
+unsigned int entropy_encode(const unsigned char *input, const unsigned int length, unsigned char *output, const int table_log, entropy_table *repeat) {
+    if (length == 0) {
+        output[0] = ENTROPY_RAW;
+        return 1;
+    }
+    unsigned int counts[HISTOGRAM_SIZE];
+    histogram_count(input, length, counts);
+    // fse, 0 if there are fewer than 2 symbols
+    short norm[HISTOGRAM_SIZE];
+    int log = fse_normalize(counts, length, norm, table_log);
+    if (log == 0) {
+        output[0] = ENTROPY_RUN;
+        output[1] = input[0];
+        return 2;
+    }
+    unsigned int i, last;
+    // estimated size in bits: sum of count * log2(states / norm)
+    double fse_bits = 0;
+    for (i = 0; i < HISTOGRAM_SIZE; i++) {
+        if (counts[i] > 0) {
+            fse_bits += counts[i] * (log - log2(norm[i]));
+        }
+    }
+    unsigned char header[FSE_MAX_HEADER_SIZE];
+    unsigned long long fse_size = 1 + fse_write_norm(norm, log, header) + 4 + (unsigned long long)fse_bits / 8 + 8;
+    // huffman, the exact size
+    unsigned char lengths[HISTOGRAM_SIZE];
+    huffman_code_lengths(counts, lengths, HISTOGRAM_SIZE, HUFFMAN_MAX_BITS);
+    last = HISTOGRAM_SIZE - 1;
+    while (last > 0 && lengths[last] == 0) {
+        last--;
+    }
+    int streams = length >= ENTROPY_HUFFMAN4_MIN_LENGTH ? 4 : 1;
+    unsigned long long huffman_size = 1 + 1 + (last + 2) / 2 + 4 + BITS_TO_BYTES(huffman_encoded_bits(counts, lengths, HISTOGRAM_SIZE)) + (streams == 4 ? HUFFMAN_JUMP_TABLE_SIZE + 3 : 0);
+    // the last table, if it has a code for every symbol of the input
+    unsigned long long repeat_size = ~0ULL;
+    if (repeat && repeat->valid) {
+        for (i = 0; i < HISTOGRAM_SIZE && (counts[i] == 0 || repeat->lengths[i] > 0); i++) {
+        }
+        if (i == HISTOGRAM_SIZE) {
+            repeat_size = 1 + 4 + BITS_TO_BYTES(huffman_encoded_bits(counts, repeat->lengths, HISTOGRAM_SIZE)) + (streams == 4 ? HUFFMAN_JUMP_TABLE_SIZE + 3 : 0);
+        }
+    }
+    // raw if none is smaller
+    if (fse_size >= 1 + length && huffman_size >= 1 + length && repeat_size >= 1 + length) {
+        return entropy_store(input, length, output);
+    }
+    unsigned int size, payload;
+    if (repeat_size <= huffman_size && repeat_size <= fse_size) {
+        // no table, preferred on a tie
+        unsigned int codes[HISTOGRAM_SIZE];
+        huffman_canonical_codes(repeat->lengths, codes, HISTOGRAM_SIZE);
+        size = 0;
+        output[size++] = streams == 4 ? ENTROPY_REPEAT4 : ENTROPY_REPEAT;
+        if (streams == 4) {
+            payload = huffman_block_encode4(input, length, repeat->lengths, codes, &output[size + 4]);
+        } else {
+            payload = huffman_block_encode(input, length, repeat->lengths, codes, &output[size + 4]);
+        }
+    } else if (huffman_size <= fse_size) {
+        // the huffman codes decode faster, preferred on a tie
+        unsigned int codes[HISTOGRAM_SIZE];
+        huffman_canonical_codes(lengths, codes, HISTOGRAM_SIZE);
+        size = 0;
+        output[size++] = streams == 4 ? ENTROPY_HUFFMAN4 : ENTROPY_HUFFMAN;
+        output[size++] = (unsigned char)last;
+        for (i = 0; i <= last; i += 2) {
+            output[size++] = (unsigned char)(lengths[i] << 4 | (i + 1 <= last ? lengths[i + 1] : 0));
+        }
+        if (streams == 4) {
+            payload = huffman_block_encode4(input, length, lengths, codes, &output[size + 4]);
+        } else {
+            payload = huffman_block_encode(input, length, lengths, codes, &output[size + 4]);
+        }
+    } else {
+        fse_ctable ctable;
+        fse_build_ctable(norm, log, &ctable);
+        size = 0;
+        output[size++] = ENTROPY_FSE;
+        size += fse_write_norm(norm, log, &output[size]);
+        payload = fse_encode(input, length, &ctable, &output[size + 4]);
+    }
+    entropy_write_u32(&output[size], payload);
+    size += 4 + payload;
+    // the estimation was off
+    if (size >= 1 + length) {
+        return entropy_store(input, length, output);
+    }
+    // a new huffman table becomes the last table of the stream
+    if (repeat && (output[0] == ENTROPY_HUFFMAN || output[0] == ENTROPY_HUFFMAN4)) {
+        memcpy(repeat->lengths, lengths, sizeof(lengths));
+        repeat->valid = 1;
+    }
+    return size;
+}
+
+int entropy_decode(const unsigned char *input, const unsigned int input_len, unsigned char *output, const unsigned int length, entropy_workspace *workspace, entropy_table *repeat) {
+    if (unlikely(input_len < 1)) {
+        return -1;
+    }
+    unsigned int i, last, size = 1, payload;
+    switch (input[0]) {
+        case ENTROPY_RAW:
+            if (unlikely(input_len - size < length)) {
+                return -1;
+            }
+            memcpy(output, &input[size], length);
+            return size + length;
+        case ENTROPY_RUN:
+            if (unlikely(input_len < 2)) {
+                return -1;
+            }
+            memset(output, input[1], length);
+            return 2;
+        case ENTROPY_HUFFMAN:
+        case ENTROPY_HUFFMAN4:
+        case ENTROPY_REPEAT:
+        case ENTROPY_REPEAT4:
+        {
+            unsigned char lengths[HISTOGRAM_SIZE];
+            if (input[0] == ENTROPY_REPEAT || input[0] == ENTROPY_REPEAT4) {
+                if (unlikely(!repeat || !repeat->valid)) {
+                    return -1;
+                }
+                memcpy(lengths, repeat->lengths, sizeof(lengths));
+            } else {
+                if (unlikely(input_len < 2)) {
+                    return -1;
+                }
+                last = input[size++];
+                if (unlikely(input_len - size < (last + 2) / 2)) {
+                    return -1;
+                }
+                memset(lengths, 0, sizeof(lengths));
+                for (i = 0; i <= last; i++) {
+                    lengths[i] = i % 2 ? input[size + i / 2] & 0x0F : input[size + i / 2] >> 4;
+                }
+                size += (last + 2) / 2;
+            }
+            if (unlikely(input_len - size < 4)) {
+                return -1;
+            }
+            if (unlikely(huffman_decode_table(lengths, workspace->huffman) < 0)) {
+                return -1;
+            }
+            // a new table becomes the last table of the stream
+            if (repeat && (input[0] == ENTROPY_HUFFMAN || input[0] == ENTROPY_HUFFMAN4)) {
+                memcpy(repeat->lengths, lengths, sizeof(lengths));
+                repeat->valid = 1;
+            }
+            payload = entropy_read_u32(&input[size]);
+            size += 4;
+            if (unlikely(input_len - size < payload)) {
+                return -1;
+            }
+            int result;
+            if (input[0] == ENTROPY_HUFFMAN4 || input[0] == ENTROPY_REPEAT4) {
+                result = huffman_block_decode4(&input[size], payload, workspace->huffman, output, length);
+            } else {
+                result = huffman_block_decode(&input[size], payload, workspace->huffman, output, length);
+            }
+            if (unlikely(result < 0)) {
+                return -1;
+            }
+            return size + payload;
+        }
+        case ENTROPY_FSE:
+        {
+            short norm[HISTOGRAM_SIZE];
+            int log;
+            int header = fse_read_norm(&input[size], input_len - size, norm, &log);
+            if (unlikely(header < 0)) {
+                return -1;
+            }
+            size += header;
+            if (unlikely(input_len - size < 4)) {
+                return -1;
+            }
+            payload = entropy_read_u32(&input[size]);
+            size += 4;
+            if (unlikely(input_len - size < payload)) {
+                return -1;
+            }
+            fse_build_dtable(norm, log, &workspace->fse);
+            if (unlikely(fse_decode(&input[size], payload, &workspace->fse, output, length) != 0)) {
+                return -1;
+            }
+            return size + payload;
+        }
+        default:
+            return -1;
+    }
+}
@@ -0,0 +1,74 @@
+//
+// entropy.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef entropy_h
+#define entropy_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "histogram.h"
+#include "huffman.h"
+#include "fse.h"
+
+/* the mode of a coded stream, the first byte of it */
+typedef enum {
+    ENTROPY_RAW = 0, // stored bytes
+    ENTROPY_RUN, // one byte repeated
+    ENTROPY_HUFFMAN, // last symbol + 4-bit code lengths, payload length (4 bytes, big endian), payload
+    ENTROPY_HUFFMAN4, // as ENTROPY_HUFFMAN, the payload is 4 streams
+    ENTROPY_FSE, // normalized counts, payload length (4 bytes, big endian), payload
+    ENTROPY_REPEAT, // as ENTROPY_HUFFMAN with the last huffman table of the stream, payload length, payload
+    ENTROPY_REPEAT4, // as ENTROPY_REPEAT, the payload is 4 streams
+} entropy_mode;
+
+/* the output size bound of entropy_encode() */
+#define ENTROPY_ENCODE_BOUND(length) (1 + 4 + FSE_MAX_HEADER_SIZE + FSE_ENCODE_BOUND(length, FSE_MAX_TABLE_LOG) + HUFFMAN_JUMP_TABLE_SIZE + 32)
+
+/* streams shorter than it are not split into 4 huffman streams */
+#define ENTROPY_HUFFMAN4_MIN_LENGTH 1024
+
+/* the last huffman table of a stream, kept by both sides, the small blocks (sync flushes) reuse it instead of sending a table */
+typedef struct entropy_table {
+    int valid;
+    unsigned char lengths[HISTOGRAM_SIZE];
+} entropy_table;
+
+/* the decoding tables, reused between the streams */
+typedef struct entropy_workspace {
+    unsigned short huffman[1 << HUFFMAN_MAX_BITS];
+    fse_dtable fse;
+} entropy_workspace;
+
+/* encode the bytes with the smallest of raw, run, huffman, the repeated huffman table and fse (estimated from the counts),
+   the decoder has to know 'length', 'repeat' is the table of the stream (NULL for none, zeroed at the start),
+   returns the output length in bytes */
+extern unsigned int entropy_encode(const unsigned char *input, const unsigned int length, unsigned char *output, const int table_log, entropy_table *repeat);
+
+/* decode 'length' bytes, 'repeat' is the table of the stream as passed to entropy_encode(),
+   returns the input length in bytes, -1 if the stream is truncated or invalid */
+extern int entropy_decode(const unsigned char *input, const unsigned int input_len, unsigned char *output, const unsigned int length, entropy_workspace *workspace, entropy_table *repeat);
+
+#endif /* entropy_h */
@@ -0,0 +1,267 @@
+//
+// fse.c
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "fse.h"
+#include "bitbyte.h"
+#include <stdint.h>
+
+static inline int fse_highbit(const unsigned int value) {
+    return 31 - __builtin_clz(value);
+}
+
+int fse_normalize(const unsigned int *counts, const unsigned int total, short *norm, int table_log) {
+    int i, symbols = 0, largest = 0;
+    for (i = 0; i < 256; i++) {
+        symbols += counts[i] > 0;
+        largest = counts[i] > counts[largest] ? i : largest;
+    }
+    memset(norm, 0, sizeof(short) * 256);
+    if (symbols < 2) {
+        return 0;
+    }
+    // no more states than needed for small inputs, enough states for every symbol
+    if (table_log > fse_highbit(total) + 1) {
+        table_log = fse_highbit(total) + 1;
+    }
+    if (table_log < fse_highbit(symbols - 1) + 2) {
+        table_log = fse_highbit(symbols - 1) + 2;
+    }
+    if (table_log < FSE_MIN_TABLE_LOG) {
+        table_log = FSE_MIN_TABLE_LOG;
+    }
+    if (table_log > FSE_MAX_TABLE_LOG) {
+        table_log = FSE_MAX_TABLE_LOG;
+    }
+    const int size = 1 << table_log;
+    int sum = 0;
+    for (i = 0; i < 256; i++) {
+        if (counts[i]) {
+            unsigned long long scaled = ((unsigned long long)counts[i] * size + total / 2) / total;
+            norm[i] = (short)(scaled ? scaled : 1);
+            sum += norm[i];
+        }
+    }
+    // the rounding error goes to the largest symbols
+    while (sum != size) {
+        if (sum < size || norm[largest] > 1) {
+            int delta = sum < size ? size - sum : -(sum - size < norm[largest] - 1 ? sum - size : norm[largest] - 1);
+            norm[largest] += delta;
+            sum += delta;
+        }
+        if (sum > size) {
+            // the largest symbol is down to 1, take from the current largest norm
+            for (i = 0, largest = 0; i < 256; i++) {
+                largest = norm[i] > norm[largest] ? i : largest;
+            }
+        }
+    }
+    return table_log;
+}
+
+unsigned int fse_write_norm(const short *norm, const int table_log, unsigned char *output) {
+    int i, last = 255;
+    unsigned int length = 0;
+    while (last > 0 && norm[last] == 0) {
+        last--;
+    }
+    output[length++] = (unsigned char)table_log;
+    output[length++] = (unsigned char)last;
+    // 1 byte below 128, 2 bytes otherwise (high bit set)
+    for (i = 0; i <= last; i++) {
+        if (norm[i] < 128) {
+            output[length++] = (unsigned char)norm[i];
+        } else {
+            output[length++] = (unsigned char)(0x80 | norm[i] >> 8);
+            output[length++] = (unsigned char)norm[i];
+        }
+    }
+    return length;
+}
+
+int fse_read_norm(const unsigned char *input, const unsigned int input_len, short *norm, int *table_log) {
+    unsigned int length = 0;
+    int i, last, sum = 0;
+    if (input_len < 2) {
+        return -1;
+    }
+    *table_log = input[length++];
+    last = input[length++];
+    if (*table_log < FSE_MIN_TABLE_LOG || *table_log > FSE_MAX_TABLE_LOG) {
+        return -1;
+    }
+    memset(norm, 0, sizeof(short) * 256);
+    for (i = 0; i <= last; i++) {
+        if (length >= input_len) {
+            return -1;
+        }
+        norm[i] = input[length++];
+        if (norm[i] & 0x80) {
+            if (length >= input_len) {
+                return -1;
+            }
+            norm[i] = (short)((norm[i] & 0x7F) << 8 | input[length++]);
+        }
+        sum += norm[i];
+    }
+    return sum == 1 << *table_log ? (int)length : -1;
+}
+
+// the symbols spread over the states, the step is odd so every state is visited once
+static void fse_spread(const short *norm, const int table_log, unsigned char *table_symbol) {
+    const unsigned int size = 1 << table_log;
+    const unsigned int mask = size - 1;
+    const unsigned int step = (size >> 1) + (size >> 3) + 3;
+    unsigned int position = 0;
+    for (int s = 0; s < 256; s++) {
+        for (int i = 0; i < norm[s]; i++) {
+            table_symbol[position] = (unsigned char)s;
+            position = (position + step) & mask;
+        }
+    }
+}
+
+void fse_build_ctable(const short *norm, const int table_log, fse_ctable *ctable) {
+    const unsigned int size = 1 << table_log;
+    unsigned char table_symbol[1 << FSE_MAX_TABLE_LOG];
+    unsigned int cumul[257];
+    unsigned int u;
+    int s, total = 0;
+    ctable->table_log = table_log;
+    fse_spread(norm, table_log, table_symbol);
+    cumul[0] = 0;
+    for (s = 0; s < 256; s++) {
+        cumul[s + 1] = cumul[s] + norm[s];
+    }
+    // the states of a symbol, sorted
+    for (u = 0; u < size; u++) {
+        ctable->state_table[cumul[table_symbol[u]]++] = (unsigned short)(size + u);
+    }
+    for (s = 0; s < 256; s++) {
+        fse_symbol_transform *transform = &ctable->symbols[s];
+        if (norm[s] == 0) {
+            transform->delta_nb_bits = ((table_log + 1) << 16) - size;
+            transform->delta_find_state = 0;
+        } else if (norm[s] == 1) {
+            transform->delta_nb_bits = (table_log << 16) - size;
+            transform->delta_find_state = total - 1;
+            total += 1;
+        } else {
+            const unsigned int max_bits_out = table_log - fse_highbit(norm[s] - 1);
+            const unsigned int min_state_plus = (unsigned int)norm[s] << max_bits_out;
+            transform->delta_nb_bits = (max_bits_out << 16) - min_state_plus;
+            transform->delta_find_state = total - norm[s];
+            total += norm[s];
+        }
+    }
+}
+
+void fse_build_dtable(const short *norm, const int table_log, fse_dtable *dtable) {
+    const unsigned int size = 1 << table_log;
+    unsigned char table_symbol[1 << FSE_MAX_TABLE_LOG];
+    unsigned int next[256];
+    dtable->table_log = table_log;
+    fse_spread(norm, table_log, table_symbol);
+    for (int s = 0; s < 256; s++) {
+        next[s] = norm[s];
+    }
+    for (unsigned int u = 0; u < size; u++) {
+        fse_decode_entry *entry = &dtable->entries[u];
+        const unsigned int state = next[table_symbol[u]]++;
+        entry->symbol = table_symbol[u];
+        entry->nb_bits = (unsigned char)(table_log - fse_highbit(state));
+        entry->new_state = (unsigned short)((state << entry->nb_bits) - size);
+    }
+}
+
+unsigned int fse_encode(const unsigned char *input, const unsigned int length, const fse_ctable *ctable, unsigned char *output) {
+    const unsigned int size = 1 << ctable->table_log;
+    unsigned long long acc = 0;
+    unsigned int bits = 0, out = 0;
+    unsigned int state = size;
+    // the decoder reads backwards, so the last symbol is encoded first
+    for (unsigned int i = length; i > 0; i--) {
+        const fse_symbol_transform transform = ctable->symbols[input[i - 1]];
+        const unsigned int nb_bits = (state + transform.delta_nb_bits) >> 16;
+        acc |= (unsigned long long)(state & ((1U << nb_bits) - 1)) << bits;
+        bits += nb_bits;
+        state = ctable->state_table[(state >> nb_bits) + transform.delta_find_state];
+        if (bits >= 32) {
+            output[out++] = (unsigned char)acc;
+            output[out++] = (unsigned char)(acc >> 8);
+            output[out++] = (unsigned char)(acc >> 16);
+            output[out++] = (unsigned char)(acc >> 24);
+            acc >>= 32;
+            bits -= 32;
+        }
+    }
+    // the final state, then the end mark
+    acc |= (unsigned long long)(state - size) << bits;
+    bits += ctable->table_log;
+    acc |= 1ULL << bits;
+    bits += 1;
+    while (bits > 0) {
+        output[out++] = (unsigned char)acc;
+        acc >>= 8;
+        bits = bits > 8 ? bits - 8 : 0;
+    }
+    return out;
+}
+
+// read n bits before the position, backwards
+static inline unsigned int fse_read_bits(const unsigned char *input, const unsigned int input_len, long long *position, const unsigned int n) {
+    *position -= n;
+    if (unlikely(*position < 0)) {
+        return 0;
+    }
+    const unsigned int byte = (unsigned int)(*position >> 3);
+    uint32_t word = 0;
+    if (byte + sizeof(word) <= input_len) {
+        memcpy(&word, &input[byte], sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        word = __builtin_bswap32(word);
+#endif
+    } else {
+        for (unsigned int i = 0; byte + i < input_len; i++) {
+            word |= (uint32_t)input[byte + i] << (i * 8);
+        }
+    }
+    return (word >> (*position & 7)) & ((1U << n) - 1);
+}
+
+int fse_decode(const unsigned char *input, const unsigned int input_len, const fse_dtable *dtable, unsigned char *output, const unsigned int length) {
+    if (input_len == 0 || input[input_len - 1] == 0) {
+        return -1;
+    }
+    // the bits before the end mark
+    long long position = BYTES_TO_BITS((long long)input_len - 1) + fse_highbit(input[input_len - 1]);
+    unsigned int state = fse_read_bits(input, input_len, &position, dtable->table_log);
+    for (unsigned int i = 0; i < length; i++) {
+        const fse_decode_entry entry = dtable->entries[state];
+        output[i] = entry.symbol;
+        state = entry.new_state + fse_read_bits(input, input_len, &position, entry.nb_bits);
+    }
+    // back to the initial state, every bit consumed
+    return position == 0 && state == 0 ? 0 : -1;
+}
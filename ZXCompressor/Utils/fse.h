@@ -0,0 +1,89 @@
+//
+// fse.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef fse_h
+#define fse_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* table log (the number of states is 1 << table_log) */
+#define FSE_MIN_TABLE_LOG 5
+#define FSE_MAX_TABLE_LOG 12
+#define FSE_DEFAULT_TABLE_LOG 11
+
+/* the largest header written by fse_write_norm() */
+#define FSE_MAX_HEADER_SIZE (2 + 256 * 2)
+
+/* encoding transform of a symbol, nb_bits = (state + delta_nb_bits) >> 16 */
+typedef struct fse_symbol_transform {
+    int delta_find_state;
+    unsigned int delta_nb_bits;
+} fse_symbol_transform;
+
+/* encoding table */
+typedef struct fse_ctable {
+    int table_log;
+    unsigned short state_table[1 << FSE_MAX_TABLE_LOG];
+    fse_symbol_transform symbols[256];
+} fse_ctable;
+
+/* decoding table entry, state = new_state + read(nb_bits) */
+typedef struct fse_decode_entry {
+    unsigned short new_state;
+    unsigned char symbol;
+    unsigned char nb_bits;
+} fse_decode_entry;
+
+/* decoding table */
+typedef struct fse_dtable {
+    int table_log;
+    fse_decode_entry entries[1 << FSE_MAX_TABLE_LOG];
+} fse_dtable;
+
+/* scale the counts to sum 1 << table_log, non-zero counts stay non-zero,
+   returns the table log used (smaller for small inputs), 0 if there are fewer than 2 symbols */
+extern int fse_normalize(const unsigned int *counts, const unsigned int total, short *norm, int table_log);
+
+/* write the table log and the normalized counts, returns the bytes written (at most FSE_MAX_HEADER_SIZE) */
+extern unsigned int fse_write_norm(const short *norm, const int table_log, unsigned char *output);
+
+/* read the table log and the normalized counts, returns the bytes read, -1 if they are truncated or invalid */
+extern int fse_read_norm(const unsigned char *input, const unsigned int input_len, short *norm, int *table_log);
+
+extern void fse_build_ctable(const short *norm, const int table_log, fse_ctable *ctable);
+extern void fse_build_dtable(const short *norm, const int table_log, fse_dtable *dtable);
+
+/* the output size bound of fse_encode() */
+#define FSE_ENCODE_BOUND(length, table_log) ((length) * (table_log) / 8 + 16)
+
+/* encode the bytes (backwards), returns the output length in bytes */
+extern unsigned int fse_encode(const unsigned char *input, const unsigned int length, const fse_ctable *ctable, unsigned char *output);
+
+/* decode 'length' bytes, returns -1 if the stream is not exactly consumed or does not end in the initial state */
+extern int fse_decode(const unsigned char *input, const unsigned int input_len, const fse_dtable *dtable, unsigned char *output, const unsigned int length);
+
+#endif /* fse_h */
@@ -188,3 +188,25 @@ unsigned int CRC_hash(const char *str, unsigned int len)
     return (answer & 0xFFFFFFFF);
 }
 
+/* Rolling Hash Function, the same as hash_roll() byte by byte */
+unsigned int hash_bytes(const void *bytes, unsigned int len)
+{
+    const unsigned int p2 = HASH_PRIME32 * HASH_PRIME32;
+    const unsigned int p3 = p2 * HASH_PRIME32;
+    const unsigned int p4 = p3 * HASH_PRIME32;
+    const unsigned char *p = bytes;
+    unsigned int hash = 0;
+    unsigned int i = 0;
+    
+    /* the 4 products are independent, unlike the byte loop */
+    for(; i + 4 <= len; i += 4)
+    {
+        hash = hash * p4 + (p[i] + 1U) * p3 + (p[i + 1] + 1U) * p2 + (p[i + 2] + 1U) * HASH_PRIME32 + (p[i + 3] + 1U);
+    }
+    for(; i < len; i++)
+    {
+        hash = hash_roll(hash, p[i]);
+    }
+    
+    return hash;
+}
@@ -7,6 +7,7 @@
 #define hash_h
 
 #include <stdio.h>
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -42,6 +43,45 @@ extern "C" {
     /* CRC Hash Function */
     unsigned int CRC_hash(const char *str, unsigned int len);
     
+    /*
+     Fast hash family for power-of-two tables, the functions above hash a byte at a time
+     and their low bits are weak, so they need a modulo by a prime-ish size.
+     */
+    
+    /* Knuth's multiplicative constants, 2^32 / phi and 2^64 / phi */
+#define HASH_PRIME32 2654435761U
+#define HASH_PRIME64 0x9E3779B185EBCA87ULL
+    
+    /* Multiplicative hash of 4 bytes, the top 'bits' (1...32) */
+    static inline unsigned int hash4(const void *bytes, unsigned int bits) {
+        unsigned int value;
+        memcpy(&value, bytes, sizeof(value));
+        return (value * HASH_PRIME32) >> (32 - bits);
+    }
+    
+    /* Multiplicative hash of 8 bytes, the top 'bits' (1...32) */
+    static inline unsigned int hash8(const void *bytes, unsigned int bits) {
+        unsigned long long value;
+        memcpy(&value, bytes, sizeof(value));
+        return (unsigned int)((value * HASH_PRIME64) >> (64 - bits));
+    }
+    
+    /* Rolling (polynomial) hash: appends a byte, hash_roll(hash_bytes(s, n), c) == hash_bytes(s + c, n + 1), the empty hash is 0 */
+    static inline unsigned int hash_roll(unsigned int hash, unsigned char byte) {
+        return hash * HASH_PRIME32 + byte + 1;
+    }
+    
+    /* Rolling hash of the bytes, 4 bytes per step */
+    unsigned int hash_bytes(const void *bytes, unsigned int len);
+    
+    /* The index of a rolling hash in a table of 1 << bits (0...32) entries, mixes the low bits into the top bits */
+    static inline unsigned int hash_index(unsigned int hash, unsigned int bits) {
+        hash ^= hash >> 16;
+        hash *= 0x85EBCA6BU;
+        hash ^= hash >> 13;
+        return bits ? hash >> (32 - bits) : 0;
+    }
+    
 #ifdef __cplusplus
 }
 #endif
@@ -25,10 +25,16 @@
 #include "hashtable.h"
 #include "hash.h"
 
-hashdata * hashdata_new(const void *data, int len) {
+// from the arena, or malloc if it is NULL
+static inline void * hash_alloc(arena *arena, size_t size) {
+    return arena ? arena_alloc(arena, size) : malloc(size);
+}
+
+// the header and the bytes in one allocation
+static hashdata * hashdata_alloc(arena *arena, const void *data, int len) {
     if (data && len > 0) {
-        hashdata * hd = malloc(sizeof(hashdata));
-        hd->data = malloc(len);
+        hashdata * hd = hash_alloc(arena, sizeof(hashdata) + len);
+        hd->data = hd + 1;
         hd->length = len;
         memcpy(hd->data, data, len);
         return hd;
@@ -36,22 +42,26 @@ hashdata * hashdata_new(const void *data, int len) {
     return NULL;
 }
 
+static hashnode * hashnode_alloc(arena *arena, const void *key, int key_len, const void *value, int val_len) {
+    hashnode * node = hash_alloc(arena, sizeof(hashnode));
+    node->key = hashdata_alloc(arena, key, key_len);
+    node->value = hashdata_alloc(arena, value, val_len);
+    node->next = NULL;
+    return node;
+}
+
+hashdata * hashdata_new(const void *data, int len) {
+    return hashdata_alloc(NULL, data, len);
+}
+
 void hashdata_free(hashdata * data) {
     if (data) {
-        if (data->data) {
-            free(data->data);
-            data->data = NULL;
-        }
         free(data);
     }
 }
 
 hashnode * hashnode_new(const void *key, int key_len, const void *value, int val_len) {
-    hashnode * node = malloc(sizeof(hashnode));
-    node->key = hashdata_new(key, key_len);
-    node->value = hashdata_new(value, val_len);
-    node->next = NULL;
-    return node;
+    return hashnode_alloc(NULL, key, key_len, value, val_len);
 }
 
 void hashnode_free(hashnode * node) {
@@ -83,18 +93,32 @@ void hashnode_set_value(hashnode * node, const void *value, int val_len) {
 }
 
 hashtable * hashtable_new(int size) {
-    hashtable * ht = malloc(sizeof(hashtable));
+    return hashtable_new_arena(size, NULL);
+}
+
+hashtable * hashtable_new_arena(int size, arena *arena) {
+    hashtable * ht = hash_alloc(arena, sizeof(hashtable));
     ht->size = size;
-    ht->node = malloc(sizeof(hashnode) * size);
-    memset(ht->node, 0, sizeof(hashnode) * size);
+    ht->used = 0;
+    // the bucket index is masked from the hash, no modulo
+    ht->bits = 0;
+    while ((1 << ht->bits) < size && ht->bits < 30) {
+        ht->bits++;
+    }
+    ht->node = hash_alloc(arena, sizeof(hashnode) << ht->bits);
+    ht->arena = arena;
+    memset(ht->node, 0, sizeof(hashnode) << ht->bits);
     return ht;
 }
 
 void hashtable_free(hashtable * table) {
-    if (table) {
+    // released with the arena
+    if (table && table->arena == NULL) {
         if (table->node) {
-            for (int i = 0; i < table->size; i++) {
+            for (int i = 0; i < 1 << table->bits; i++) {
                 hashnode * node = &table->node[i];
+                hashdata_free(node->key);
+                hashdata_free(node->value);
                 while (node->next) {
                     hashnode * next = node->next;
                     node->next = next->next;
@@ -109,20 +133,32 @@ void hashtable_free(hashtable * table) {
 }
 
 void hashtable_set_node(hashtable * table, const void *key, int key_len, const void *value, int val_len) {
-    hashnode * node = hashtable_get_node(table, key, key_len);
+    hashtable_set_node_hash(table, key, key_len, hash_bytes(key, key_len), value, val_len);
+}
+
+void hashtable_set_node_hash(hashtable * table, const void *key, int key_len, unsigned int hash, const void *value, int val_len) {
+    hashnode * node = hashtable_get_node_hash(table, key, key_len, hash);
     if (node == NULL) {
-        unsigned int i = simple_hash(key, key_len) % table->size;
+        unsigned int i = hash_index(hash, table->bits);
         node = &table->node[i];
         if (node->key == NULL) {
-            hashnode_set_key(node, key, key_len);
-            hashnode_set_value(node, value, val_len);
+            if (table->arena) {
+                node->key = hashdata_alloc(table->arena, key, key_len);
+                node->value = hashdata_alloc(table->arena, value, val_len);
+            } else {
+                hashnode_set_key(node, key, key_len);
+                hashnode_set_value(node, value, val_len);
+            }
             table->used++;
         } else { // conflict
-            node = hashnode_new(key, key_len, value, val_len);
+            node = hashnode_alloc(table->arena, key, key_len, value, val_len);
             node->next = table->node[i].next;
             table->node[i].next = node;
             table->used++;
         }
+    } else if (table->arena) {
+        // update value, the old one is released with the arena
+        node->value = hashdata_alloc(table->arena, value, val_len);
     } else {
         // update value
         hashnode_set_value(node, value, val_len);
@@ -130,7 +166,11 @@ void hashtable_set_node(hashtable * table, const void *key, int key_len, const v
 }
 
 hashnode * hashtable_get_node(hashtable * table, const void *key, int key_len) {
-    unsigned int i = simple_hash(key, key_len) % table->size;
+    return hashtable_get_node_hash(table, key, key_len, hash_bytes(key, key_len));
+}
+
+hashnode * hashtable_get_node_hash(hashtable * table, const void *key, int key_len, unsigned int hash) {
+    unsigned int i = hash_index(hash, table->bits);
     for (hashnode *node = &table->node[i]; node != NULL; node = node->next) {
         if (node->key && node->key->length == key_len && (memcmp(key, node->key->data, key_len) == 0)) {
             return node;
@@ -138,3 +178,37 @@ hashnode * hashtable_get_node(hashtable * table, const void *key, int key_len) {
     }
     return NULL;
 }
+
+hashtable * hashtable_copy(hashtable * table) {
+    return hashtable_copy_arena(table, NULL);
+}
+
+hashtable * hashtable_copy_arena(hashtable * table, arena *arena) {
+    hashtable * ht = hashtable_new_arena(table->size, arena);
+    for (int i = 0; i < 1 << table->bits; i++) {
+        hashnode * node = &table->node[i];
+        if (node->key) {
+            ht->node[i].key = hashdata_alloc(arena, node->key->data, node->key->length);
+            ht->node[i].value = node->value ? hashdata_alloc(arena, node->value->data, node->value->length) : NULL;
+        }
+        hashnode * tail = &ht->node[i];
+        for (node = node->next; node != NULL; node = node->next) {
+            tail->next = hashnode_alloc(arena, node->key->data, node->key->length, node->value ? node->value->data : NULL, node->value ? node->value->length : 0);
+            tail = tail->next;
+        }
+    }
+    ht->used = table->used;
+    return ht;
+}
+
+hashtable * hashtable_invert(hashtable * table) {
+    hashtable * ht = hashtable_new_arena(table->size, table->arena);
+    for (int i = 0; i < 1 << table->bits; i++) {
+        for (hashnode * node = &table->node[i]; node != NULL; node = node->next) {
+            if (node->key && node->value) {
+                hashtable_set_node(ht, node->value->data, node->value->length, node->key->data, node->key->length);
+            }
+        }
+    }
+    return ht;
+}
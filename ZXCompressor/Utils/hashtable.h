@@ -28,6 +28,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "arena.h"
 
 typedef struct hash_data {
     void *data;
@@ -43,7 +44,9 @@ typedef struct hash_node {
 typedef struct hash_table {
     int size;
     int used;
+    int bits; // the node array has 1 << bits buckets, the power of two >= size
     struct hash_node *node;
+    struct arena *arena; // NULL for malloc
 } hashtable;
 
 extern hashdata * hashdata_new(const void *data, int len);
@@ -55,8 +58,16 @@ extern void hashnode_set_key(hashnode * node, const void *key, int key_len);
 extern void hashnode_set_value(hashnode * node, const void *value, int val_len);
 
 extern hashtable * hashtable_new(int size);
+// the table, nodes, keys and values are allocated from the arena, released with it (hashtable_free does nothing)
+extern hashtable * hashtable_new_arena(int size, arena *arena);
 extern void hashtable_free(hashtable * table);
 extern void hashtable_set_node(hashtable  *table, const void *key, int key_len, const void *value, int val_len);
 extern hashnode * hashtable_get_node(hashtable * table, const void *key, int key_len);
+// with the hash_bytes() of the key, callers growing a key a byte at a time keep it with hash_roll()
+extern void hashtable_set_node_hash(hashtable  *table, const void *key, int key_len, unsigned int hash, const void *value, int val_len);
+extern hashnode * hashtable_get_node_hash(hashtable * table, const void *key, int key_len, unsigned int hash);
+extern hashtable * hashtable_copy(hashtable * table);
+extern hashtable * hashtable_copy_arena(hashtable * table, arena *arena);
+extern hashtable * hashtable_invert(hashtable * table);
 
 #endif /* hashtable_h */
@@ -0,0 +1,65 @@
+//
+// histogram.c
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "histogram.h"
+#include <stdint.h>
+
+// 交错的计数表数量
+#define HISTOGRAM_TABLES 4
+
+void histogram_count(const unsigned char *bytes, const unsigned int length, unsigned int *counts) {
+    uint32_t tables[HISTOGRAM_TABLES][HISTOGRAM_SIZE];
+    memset(tables, 0, sizeof(tables));
+    unsigned int i = 0;
+    // 每次 8 字节, 相邻字节落在不同的计数表
+    for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, &bytes[i], sizeof(word));
+        tables[0][(unsigned char)(word)]++;
+        tables[1][(unsigned char)(word >> 8)]++;
+        tables[2][(unsigned char)(word >> 16)]++;
+        tables[3][(unsigned char)(word >> 24)]++;
+        tables[0][(unsigned char)(word >> 32)]++;
+        tables[1][(unsigned char)(word >> 40)]++;
+        tables[2][(unsigned char)(word >> 48)]++;
+        tables[3][(unsigned char)(word >> 56)]++;
+    }
+    // 剩余字节
+    for (; i < length; i++) {
+        tables[0][bytes[i]]++;
+    }
+    // 合并
+    for (i = 0; i < HISTOGRAM_SIZE; i++) {
+        counts[i] = tables[0][i] + tables[1][i] + tables[2][i] + tables[3][i];
+    }
+}
+
+void histogram_accumulate(const unsigned char *bytes, const unsigned int length, unsigned long long *counts) {
+    unsigned int block[HISTOGRAM_SIZE];
+    histogram_count(bytes, length, block);
+    for (int i = 0; i < HISTOGRAM_SIZE; i++) {
+        counts[i] += block[i];
+    }
+}
@@ -0,0 +1,55 @@
+//
+// histogram.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef histogram_h
+#define histogram_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 字节直方图的大小 */
+#define HISTOGRAM_SIZE 256
+
+/**
+ 统计字节出现的次数(覆盖 counts)
+ 用 4 张交错的计数表分摊连续相同字节的写依赖(store-to-load), 每次读入 8 字节, 最后合并
+ 
+ @param bytes 字节流
+ @param length 字节流长度
+ @param counts 输出计数, HISTOGRAM_SIZE 个
+ */
+extern void histogram_count(const unsigned char *bytes, const unsigned int length, unsigned int *counts);
+
+/**
+ 统计字节出现的次数(累加到 counts), 用于分块读入的大文件
+ 
+ @param bytes 字节流
+ @param length 字节流长度
+ @param counts 累加计数, HISTOGRAM_SIZE 个
+ */
+extern void histogram_accumulate(const unsigned char *bytes, const unsigned int length, unsigned long long *counts);
+
+#endif /* histogram_h */
@@ -25,19 +25,40 @@
 #include "huffman.h"
 #include "bitbyte.h"
 
-huffman_data * huffman_data_new(int symbol, int weight) {
-    huffman_data *data = malloc(sizeof(huffman_data));
+// from the arena, or malloc if it is NULL
+static inline void * huffman_alloc(arena *arena, size_t size) {
+    return arena ? arena_alloc(arena, size) : malloc(size);
+}
+
+static huffman_data * huffman_data_alloc(arena *arena, int symbol, int weight) {
+    huffman_data *data = huffman_alloc(arena, sizeof(huffman_data));
     data->symbol = symbol;
     data->weight = weight;
     return data;
 }
 
+huffman_data * huffman_data_new(int symbol, int weight) {
+    return huffman_data_alloc(NULL, symbol, weight);
+}
+
 void huffman_data_free(huffman_data *data) {
     if (data) {
         free(data);
     }
 }
 
+// the header and the bits in one allocation from the arena
+static huffman_code * huffman_code_alloc(arena *arena, int size) {
+    huffman_code *code = arena_alloc(arena, sizeof(huffman_code) + BITS_TO_BYTES(size));
+    code->size = size;
+    code->bits = size > 0 ? (unsigned char *)(code + 1) : NULL;
+    code->used = 0;
+    if (code->bits) {
+        memset(code->bits, 0, BITS_TO_BYTES(size));
+    }
+    return code;
+}
+
 huffman_code * huffman_code_new(int size) {
     huffman_code *code = malloc(sizeof(huffman_code));
     if (code) {
@@ -83,20 +104,21 @@ int huffman_code_pop(huffman_code *code) {
 }
 
 
-void huffman_code_make(huffman_node *node, huffman_code *code) {
+// the leaf codes are allocated from the arena, or malloc if it is NULL
+static void huffman_code_make_arena(huffman_node *node, huffman_code *code, arena *arena) {
     // right child is 0
     if (node->lchild) {
         huffman_code_push(code, 0);
-        huffman_code_make(node->lchild, code);
+        huffman_code_make_arena(node->lchild, code, arena);
     }
     // right child is 1
     if (node->rchild) {
         huffman_code_push(code, 1);
-        huffman_code_make(node->rchild, code);
+        huffman_code_make_arena(node->rchild, code, arena);
     }
     // leaf node
     if (node->lchild == NULL && node->rchild == NULL) {
-        node->code = huffman_code_new(code->size);
+        node->code = arena ? huffman_code_alloc(arena, code->size) : huffman_code_new(code->size);
         int size = BITS_TO_BYTES(code->size);
         memcpy(node->code->bits, code->bits, size);
         node->code->used = code->used;
@@ -115,19 +137,339 @@ void huffman_code_make(huffman_node *node, huffman_code *code) {
     code->used--;
 }
 
+void huffman_code_make(huffman_node *node, huffman_code *code) {
+    huffman_code_make_arena(node, code, NULL);
+}
+
+void huffman_weights_from_counts(const unsigned long long *counts, unsigned int *weights, const int size) {
+    unsigned long long sum = 0;
+    for (int i = 0; i < size; i++) {
+        sum += counts[i];
+    }
+    // inputs larger than the limit (1 GB) are scaled by a power of 2
+    int shift = 0;
+    while ((sum >> shift) > HUFFMAN_WEIGHT_LIMIT) {
+        shift++;
+    }
+    for (int i = 0; i < size; i++) {
+        unsigned long long weight = counts[i] >> shift;
+        weights[i] = (unsigned int)(counts[i] && weight == 0 ? 1 : weight);
+    }
+}
+
+// sort the leaves by weight, ties by symbol, so the lengths do not depend on the qsort implementation
+static int huffman_leaf_compare(const void *a, const void *b) {
+    const unsigned long long x = *(const unsigned long long *)a;
+    const unsigned long long y = *(const unsigned long long *)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+int huffman_code_lengths(const unsigned int *weights, unsigned char *lengths, const int size, const int max_bits) {
+    // leaves: weight << 8 | symbol, sorted once
+    unsigned long long leaves[256];
+    // nodes [0, count) are the sorted leaves, [count, 2 * count - 1) the internal nodes in creation order
+    unsigned long long weight[511];
+    unsigned short parent[511];
+    unsigned char depth[511];
+    unsigned int num_codes[256] = {0};
+    int i, count = 0, max_len = 0;
+    memset(lengths, 0, size);
+    for (i = 0; i < size && i < 256; i++) {
+        if (weights[i]) {
+            leaves[count++] = (unsigned long long)weights[i] << 8 | i;
+        }
+    }
+    if (count == 0) {
+        return 0;
+    }
+    // a single symbol still takes one bit
+    if (count == 1) {
+        lengths[leaves[0] & 0xFF] = 1;
+        return 1;
+    }
+    qsort(leaves, count, sizeof(leaves[0]), huffman_leaf_compare);
+    for (i = 0; i < count; i++) {
+        weight[i] = leaves[i] >> 8;
+    }
+    // two queues: the next leaf and the next internal node, both are in non-decreasing order
+    int leaf = 0, node = count, next;
+    for (next = count; next < count * 2 - 1; next++) {
+        int child[2];
+        for (int c = 0; c < 2; c++) {
+            if (node >= next || (leaf < count && weight[leaf] <= weight[node])) {
+                child[c] = leaf++;
+            } else {
+                child[c] = node++;
+            }
+        }
+        weight[next] = weight[child[0]] + weight[child[1]];
+        parent[child[0]] = parent[child[1]] = next;
+    }
+    // depths, parents always come after their children
+    depth[count * 2 - 2] = 0;
+    for (i = count * 2 - 3; i >= 0; i--) {
+        depth[i] = depth[parent[i]] + 1;
+    }
+    for (i = 0; i < count; i++) {
+        num_codes[depth[i]]++;
+        if (max_len < depth[i]) {
+            max_len = depth[i];
+        }
+    }
+    // too long, move the deep codes up to max_bits and split shorter codes until the Kraft sum is 1
+    if (max_len > max_bits) {
+        for (i = max_bits + 1; i <= max_len; i++) {
+            num_codes[max_bits] += num_codes[i];
+            num_codes[i] = 0;
+        }
+        unsigned int total = 0;
+        for (i = max_bits; i > 0; i--) {
+            total += num_codes[i] << (max_bits - i);
+        }
+        while (total != 1U << max_bits) {
+            num_codes[max_bits]--;
+            for (i = max_bits - 1; i > 0; i--) {
+                if (num_codes[i]) {
+                    num_codes[i]--;
+                    num_codes[i + 1] += 2;
+                    break;
+                }
+            }
+            total--;
+        }
+        max_len = max_bits;
+    }
+    // the lightest leaves take the longest codes
+    for (int len = max_len, j = 0; len > 0; len--) {
+        for (unsigned int k = 0; k < num_codes[len]; k++) {
+            lengths[leaves[j++] & 0xFF] = len;
+        }
+    }
+    return max_len;
+}
+
+void huffman_canonical_codes(const unsigned char *lengths, unsigned int *codes, const int size) {
+    unsigned int bl_count[HUFFMAN_MAX_BITS + 1] = {0};
+    unsigned int next_code[HUFFMAN_MAX_BITS + 1] = {0};
+    int i;
+    for (i = 0; i < size; i++) {
+        bl_count[lengths[i]]++;
+    }
+    bl_count[0] = 0;
+    for (i = 1; i <= HUFFMAN_MAX_BITS; i++) {
+        next_code[i] = (next_code[i - 1] + bl_count[i - 1]) << 1;
+    }
+    for (i = 0; i < size; i++) {
+        codes[i] = lengths[i] ? next_code[lengths[i]]++ : 0;
+    }
+}
+
+unsigned long long huffman_encoded_bits(const unsigned int *counts, const unsigned char *lengths, const int size) {
+    unsigned long long bits = 0;
+    for (int i = 0; i < size; i++) {
+        if (counts[i] && lengths[i] == 0) {
+            return ~0ULL;
+        }
+        bits += (unsigned long long)counts[i] * lengths[i];
+    }
+    return bits;
+}
+
+unsigned int huffman_block_encode(const unsigned char *input, const unsigned int length, const unsigned char *lengths, const unsigned int *codes, unsigned char *output) {
+    unsigned long long acc = 0;
+    unsigned int bits = 0, out = 0;
+    for (unsigned int i = 0; i < length; i++) {
+        acc = (acc << lengths[input[i]]) | codes[input[i]];
+        bits += lengths[input[i]];
+        // flush 4 bytes at a time, at most 31 + 15 bits are pending
+        if (bits >= 32) {
+            bits -= 32;
+            output[out++] = (unsigned char)(acc >> (bits + 24));
+            output[out++] = (unsigned char)(acc >> (bits + 16));
+            output[out++] = (unsigned char)(acc >> (bits + 8));
+            output[out++] = (unsigned char)(acc >> bits);
+        }
+    }
+    while (bits >= 8) {
+        bits -= 8;
+        output[out++] = (unsigned char)(acc >> bits);
+    }
+    if (bits > 0) {
+        output[out++] = (unsigned char)(acc << (8 - bits));
+    }
+    return out;
+}
+
+int huffman_decode_table(const unsigned char *lengths, unsigned short *table) {
+    unsigned int codes[256];
+    unsigned int kraft = 0;
+    int i;
+    for (i = 0; i < 256; i++) {
+        if (lengths[i] > HUFFMAN_MAX_BITS) {
+            return -1;
+        }
+        kraft += lengths[i] ? 1 << (HUFFMAN_MAX_BITS - lengths[i]) : 0;
+    }
+    if (kraft > 1 << HUFFMAN_MAX_BITS) {
+        return -1;
+    }
+    // unused codes have length 0
+    memset(table, 0, sizeof(unsigned short) << HUFFMAN_MAX_BITS);
+    huffman_canonical_codes(lengths, codes, 256);
+    for (i = 0; i < 256; i++) {
+        if (lengths[i]) {
+            unsigned int shift = HUFFMAN_MAX_BITS - lengths[i];
+            unsigned short entry = (unsigned short)(i | lengths[i] << 8);
+            for (unsigned int j = codes[i] << shift; j < (codes[i] + 1) << shift; j++) {
+                table[j] = entry;
+            }
+        }
+    }
+    return 0;
+}
+
+// bit reader of one code stream, reads zeros past the end of the input
+typedef struct huffman_reader {
+    const unsigned char *input;
+    unsigned int input_len;
+    unsigned int in;
+    unsigned int bits;
+    unsigned long long acc;
+    unsigned long long consumed;
+} huffman_reader;
+
+static inline void huffman_reader_init(huffman_reader *reader, const unsigned char *input, const unsigned int input_len) {
+    memset(reader, 0, sizeof(huffman_reader));
+    reader->input = input;
+    reader->input_len = input_len;
+}
+
+// decode one symbol, returns the code length, 0 for an unused code
+static inline unsigned int huffman_reader_decode(huffman_reader *reader, const unsigned short *table, unsigned char *symbol) {
+    // refill, at least 3 codes are buffered after a refill
+    if (reader->bits < HUFFMAN_MAX_BITS) {
+        while (reader->bits <= 56) {
+            reader->acc = (reader->acc << 8) | (reader->in < reader->input_len ? reader->input[reader->in] : 0);
+            reader->in++;
+            reader->bits += 8;
+        }
+    }
+    unsigned short entry = table[(reader->acc >> (reader->bits - HUFFMAN_MAX_BITS)) & ((1 << HUFFMAN_MAX_BITS) - 1)];
+    unsigned int len = entry >> 8;
+    *symbol = (unsigned char)entry;
+    reader->bits -= len;
+    reader->consumed += len;
+    return len;
+}
+
+// read past the end of the input
+static inline int huffman_reader_overrun(const huffman_reader *reader) {
+    return reader->consumed > BYTES_TO_BITS((unsigned long long)reader->input_len);
+}
+
+int huffman_block_decode(const unsigned char *input, const unsigned int input_len, const unsigned short *table, unsigned char *output, const unsigned int length) {
+    huffman_reader reader;
+    huffman_reader_init(&reader, input, input_len);
+    for (unsigned int i = 0; i < length; i++) {
+        if (unlikely(huffman_reader_decode(&reader, table, &output[i]) == 0)) {
+            return -1;
+        }
+    }
+    return huffman_reader_overrun(&reader) ? -1 : 0;
+}
+
+// the symbols of the 4 streams, the first streams take the remainder
+static void huffman_stream_sizes(const unsigned int length, unsigned int *sizes) {
+    for (int k = 0; k < 4; k++) {
+        sizes[k] = length / 4 + (k < length % 4 ? 1 : 0);
+    }
+}
+
+unsigned int huffman_block_encode4(const unsigned char *input, const unsigned int length, const unsigned char *lengths, const unsigned int *codes, unsigned char *output) {
+    unsigned int sizes[4];
+    unsigned int out = HUFFMAN_JUMP_TABLE_SIZE;
+    huffman_stream_sizes(length, sizes);
+    for (int k = 0; k < 4; k++) {
+        unsigned int bytes = huffman_block_encode(input, sizes[k], lengths, codes, &output[out]);
+        // jump table: the byte sizes of the first 3 streams, big endian
+        if (k < 3) {
+            output[k * 4 + 0] = (unsigned char)(bytes >> 24);
+            output[k * 4 + 1] = (unsigned char)(bytes >> 16);
+            output[k * 4 + 2] = (unsigned char)(bytes >> 8);
+            output[k * 4 + 3] = (unsigned char)bytes;
+        }
+        input += sizes[k];
+        out += bytes;
+    }
+    return out;
+}
+
+int huffman_block_decode4(const unsigned char *input, const unsigned int input_len, const unsigned short *table, unsigned char *output, const unsigned int length) {
+    unsigned int sizes[4], bytes[4];
+    unsigned char *outputs[4];
+    huffman_reader readers[4];
+    unsigned int i, k, offset = HUFFMAN_JUMP_TABLE_SIZE;
+    if (input_len < HUFFMAN_JUMP_TABLE_SIZE) {
+        return -1;
+    }
+    huffman_stream_sizes(length, sizes);
+    for (k = 0; k < 3; k++) {
+        bytes[k] = (unsigned int)input[k * 4] << 24 | input[k * 4 + 1] << 16 | input[k * 4 + 2] << 8 | input[k * 4 + 3];
+    }
+    if (bytes[0] > input_len || bytes[1] > input_len || bytes[2] > input_len ||
+        (unsigned long long)bytes[0] + bytes[1] + bytes[2] > input_len - HUFFMAN_JUMP_TABLE_SIZE) {
+        return -1;
+    }
+    bytes[3] = input_len - HUFFMAN_JUMP_TABLE_SIZE - bytes[0] - bytes[1] - bytes[2];
+    for (k = 0; k < 4; k++) {
+        huffman_reader_init(&readers[k], &input[offset], bytes[k]);
+        outputs[k] = output;
+        offset += bytes[k];
+        output += sizes[k];
+    }
+    // 4 independent readers in one loop, the last stream is the shortest
+    for (i = 0; i < sizes[3]; i++) {
+        unsigned int l0 = huffman_reader_decode(&readers[0], table, &outputs[0][i]);
+        unsigned int l1 = huffman_reader_decode(&readers[1], table, &outputs[1][i]);
+        unsigned int l2 = huffman_reader_decode(&readers[2], table, &outputs[2][i]);
+        unsigned int l3 = huffman_reader_decode(&readers[3], table, &outputs[3][i]);
+        if (unlikely((l0 == 0) | (l1 == 0) | (l2 == 0) | (l3 == 0))) {
+            return -1;
+        }
+    }
+    // the remainder
+    for (k = 0; k < 3; k++) {
+        for (i = sizes[3]; i < sizes[k]; i++) {
+            if (unlikely(huffman_reader_decode(&readers[k], table, &outputs[k][i]) == 0)) {
+                return -1;
+            }
+        }
+    }
+    for (k = 0; k < 4; k++) {
+        if (huffman_reader_overrun(&readers[k])) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
 huffman_tree * huffman_tree_new(huffman_data *data, const int size) {
+    return huffman_tree_new_arena(data, size, NULL);
+}
+
+huffman_tree * huffman_tree_new_arena(huffman_data *data, const int size, arena *arena) {
     // size
     int leaf_size = size;
     int tree_size = leaf_size * 2 - 1;
     // tree
-    huffman_tree *tree = malloc(sizeof(huffman_tree) * tree_size);
+    huffman_tree *tree = huffman_alloc(arena, sizeof(huffman_tree) * tree_size);
     memset(tree, 0, sizeof(huffman_tree) * tree_size);
     // leaf
-    pqueue_heap *heap = pqueue_heap_new(tree_size);
+    pqueue_heap *heap = pqueue_heap_new_arena(tree_size, arena);
     for (int i = 0; i < leaf_size; i++) {
         huffman_node *node = &tree[i];
         huffman_data *_data = &data[i];
-        node->data = huffman_data_new(_data->symbol, _data->weight);
+        node->data = huffman_data_alloc(arena, _data->symbol, _data->weight);
         pqueue_heap_push(heap, node->data->weight, node);
     }
     // node
@@ -138,13 +480,13 @@ huffman_tree * huffman_tree_new(huffman_data *data, const int size) {
         node->lchild->parent = node;
         node->rchild = pqueue_heap_pop(heap);
         node->rchild->parent = node;
-        node->data = huffman_data_new(0, node->lchild->data->weight + node->rchild->data->weight);
+        node->data = huffman_data_alloc(arena, 0, node->lchild->data->weight + node->rchild->data->weight);
         pqueue_heap_push(heap, node->data->weight, node);
     }
     // code
     huffman_node *node = pqueue_heap_pop(heap);
     huffman_code *code = huffman_code_new(leaf_size);
-    huffman_code_make(node, code);
+    huffman_code_make_arena(node, code, arena);
     // free
     huffman_code_free(code);
     pqueue_heap_free(heap);
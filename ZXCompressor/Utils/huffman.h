@@ -29,6 +29,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include "pqueue.h"
+#include "arena.h"
+
+/* the max sum of weights, keeps the weights of internal nodes in int */
+#define HUFFMAN_WEIGHT_LIMIT (1 << 30)
 
 /* huffman data */
 typedef struct huffman_data {
@@ -61,7 +65,44 @@ extern void huffman_code_push(huffman_code *code, int state);
 extern int huffman_code_pop(huffman_code *code);
 extern void huffman_code_make(huffman_node *node, huffman_code *code);
 
+/* scale the symbol counts down to weights whose sum is at most HUFFMAN_WEIGHT_LIMIT + size, non-zero counts keep non-zero weights */
+extern void huffman_weights_from_counts(const unsigned long long *counts, unsigned int *weights, const int size);
+
+/* the max code length of the canonical (block) codes, fits in a nibble */
+#define HUFFMAN_MAX_BITS 15
+
+/* code lengths of the symbols with non-zero weight, at most max_bits, returns the max length (0 if all weights are zero)
+   sorts the weights once and merges with two queues in flat arrays, no heap allocation */
+extern int huffman_code_lengths(const unsigned int *weights, unsigned char *lengths, const int size, const int max_bits);
+
+/* canonical codes of the code lengths, assigned in (length, symbol) order */
+extern void huffman_canonical_codes(const unsigned char *lengths, unsigned int *codes, const int size);
+
+/* the size in bits of the symbols coded with the code lengths, ~0 if a counted symbol has no code */
+extern unsigned long long huffman_encoded_bits(const unsigned int *counts, const unsigned char *lengths, const int size);
+
+/* encode the bytes with the canonical codes (MSB-first), output holds huffman_encoded_bits() / 8 + 8 bytes, returns the output length in bytes */
+extern unsigned int huffman_block_encode(const unsigned char *input, const unsigned int length, const unsigned char *lengths, const unsigned int *codes, unsigned char *output);
+
+/* the decoding table of 1 << HUFFMAN_MAX_BITS entries (symbol | length << 8) from 256 code lengths, returns -1 if the lengths are over-subscribed */
+extern int huffman_decode_table(const unsigned char *lengths, unsigned short *table);
+
+/* decode 'length' bytes, returns -1 if an unused code is met or the input ends early */
+extern int huffman_block_decode(const unsigned char *input, const unsigned int input_len, const unsigned short *table, unsigned char *output, const unsigned int length);
+
+/* the jump table of the 4 streams: the byte sizes of the first 3 streams (4 bytes each, big endian) */
+#define HUFFMAN_JUMP_TABLE_SIZE 12
+
+/* encode the bytes as 4 streams (length / 4 symbols each, the first streams take the remainder) after a jump table,
+   output holds huffman_encoded_bits() / 8 + HUFFMAN_JUMP_TABLE_SIZE + 32 bytes, returns the output length in bytes */
+extern unsigned int huffman_block_encode4(const unsigned char *input, const unsigned int length, const unsigned char *lengths, const unsigned int *codes, unsigned char *output);
+
+/* decode 'length' bytes of 4 streams with 4 interleaved bit readers, returns -1 if the jump table or a stream is invalid */
+extern int huffman_block_decode4(const unsigned char *input, const unsigned int input_len, const unsigned short *table, unsigned char *output, const unsigned int length);
+
 extern huffman_tree * huffman_tree_new(huffman_data *data, const int size);
+/* the tree, its data, codes and queue are allocated from the arena, released with it instead of huffman_tree_free() */
+extern huffman_tree * huffman_tree_new_arena(huffman_data *data, const int size, arena *arena);
 extern void huffman_tree_free(huffman_tree *tree, const int size);
 extern huffman_node * huffman_tree_root(huffman_tree *tree);
 
@@ -0,0 +1,131 @@
+//
+// ldm.c
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "ldm.h"
+#include "bitbyte.h"
+
+// 滚动哈希(Rabin-Karp)的乘数, 按 2^64 取模
+#define LDM_PRIME 0x9E3779B185EBCA87ULL
+
+// prime ^ (LDM_MIN_LENGTH - 1), 移出字节的权重
+static unsigned long long ldm_prime_power(void) {
+    unsigned long long power = 1;
+    for (int i = 0; i < LDM_MIN_LENGTH - 1; i++) {
+        power *= LDM_PRIME;
+    }
+    return power;
+}
+
+static inline unsigned long long ldm_hash(const unsigned char *bytes) {
+    unsigned long long hash = 0;
+    for (int i = 0; i < LDM_MIN_LENGTH; i++) {
+        hash = hash * LDM_PRIME + bytes[i] + 1;
+    }
+    return hash;
+}
+
+ldm_table * ldm_table_new(unsigned int window_size) {
+    ldm_table *table = malloc(sizeof(ldm_table));
+    // 每 2^LDM_SAMPLE_BITS 字节一个采样
+    unsigned int log = LDM_MIN_TABLE_LOG;
+    while (log < LDM_MAX_TABLE_LOG && (1ULL << (log + LDM_SAMPLE_BITS)) < window_size) {
+        log++;
+    }
+    table->window_size = window_size;
+    table->table_log = log;
+    table->entries = calloc((size_t)1 << log, sizeof(ldm_entry));
+    return table;
+}
+
+void ldm_table_free(ldm_table *table) {
+    if (table) {
+        free(table->entries);
+        free(table);
+    }
+}
+
+void ldm_table_slide(ldm_table *table, unsigned int shift) {
+    size_t i, size = (size_t)1 << table->table_log;
+    for (i = 0; i < size; i++) {
+        ldm_entry *entry = &table->entries[i];
+        entry->position = entry->position > shift ? entry->position - shift : 0;
+    }
+}
+
+unsigned int ldm_find_matches(ldm_table *table, const unsigned char *base, unsigned int start, unsigned int end, ldm_match *matches) {
+    unsigned int count = 0;
+    if (end - start < LDM_MIN_LENGTH) {
+        return 0;
+    }
+    const unsigned long long power = ldm_prime_power();
+    const unsigned int shift = 64 - LDM_SAMPLE_BITS - table->table_log;
+    const unsigned int mask = (1U << table->table_log) - 1;
+    // 上一个匹配的末尾, 向前扩展的边界
+    unsigned int floor = start;
+    unsigned int pos = start;
+    unsigned long long hash = ldm_hash(&base[pos]);
+    for (;;) {
+        // 最高 LDM_SAMPLE_BITS 位为 0 的位置是采样点
+        if ((hash >> (64 - LDM_SAMPLE_BITS)) == 0) {
+            ldm_entry *entry = &table->entries[(hash >> shift) & mask];
+            unsigned int checksum = (unsigned int)hash;
+            if (entry->position > 0 && entry->checksum == checksum && pos - (entry->position - 1) < table->window_size) {
+                unsigned int candidate = entry->position - 1;
+                unsigned int length = match_length(&base[candidate], &base[pos], end - pos);
+                if (length >= LDM_MIN_LENGTH) {
+                    // 向前扩展
+                    unsigned int begin = pos;
+                    while (begin > floor && candidate > 0 && base[begin - 1] == base[candidate - 1]) {
+                        begin--;
+                        candidate--;
+                    }
+                    matches[count].position = begin;
+                    matches[count].length = pos + length - begin;
+                    matches[count].offset = begin - candidate;
+                    count++;
+                    // 最新的位置
+                    entry->position = pos + 1;
+                    // 跳过匹配的内容, 重新计算哈希
+                    pos += length;
+                    floor = pos;
+                    if (end - pos < LDM_MIN_LENGTH) {
+                        break;
+                    }
+                    hash = ldm_hash(&base[pos]);
+                    continue;
+                }
+            }
+            entry->position = pos + 1;
+            entry->checksum = checksum;
+        }
+        // 滚动到下一个位置
+        if (pos + LDM_MIN_LENGTH >= end) {
+            break;
+        }
+        hash = (hash - (base[pos] + 1ULL) * power) * LDM_PRIME + base[pos + LDM_MIN_LENGTH] + 1;
+        pos++;
+    }
+    return count;
+}
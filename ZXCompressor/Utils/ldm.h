@@ -0,0 +1,99 @@
+//
+// ldm.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef ldm_h
+#define ldm_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 长距离匹配(long-distance matching)的最短长度, 也是滚动哈希的字节数 */
+#define LDM_MIN_LENGTH 64
+
+/* 采样率: 滚动哈希最高 LDM_SAMPLE_BITS 位为 0 的位置才插入/查找(平均每 64 字节一个) */
+#define LDM_SAMPLE_BITS 6
+
+/* 哈希表的最小/最大位数 */
+#define LDM_MIN_TABLE_LOG 12
+#define LDM_MAX_TABLE_LOG 22
+
+/* 哈希表项 */
+typedef struct ldm_entry {
+    unsigned int position; // 位置 + 1(0 表示空)
+    unsigned int checksum; // 滚动哈希的低 32 位, 排除哈希表下标相同的不同内容
+} ldm_entry;
+
+/* 哈希表, 按内容采样(相同的内容在相同的相对位置采样), 覆盖很大的滑动窗口 */
+typedef struct ldm_table {
+    unsigned int window_size; // 滑动窗口大小, 最大匹配偏移为 window_size - 1
+    unsigned int table_log; // 哈希表的位数
+    ldm_entry *entries;
+} ldm_table;
+
+/* 长距离匹配 */
+typedef struct ldm_match {
+    unsigned int position; // 位置
+    unsigned int length; // 长度, 至少 LDM_MIN_LENGTH
+    unsigned int offset; // 匹配位置到 position 的距离
+} ldm_match;
+
+/**
+ 创建哈希表, 表的大小按滑动窗口的采样数决定
+ 
+ @param window_size 滑动窗口大小
+ @return 哈希表
+ */
+extern ldm_table * ldm_table_new(unsigned int window_size);
+
+/**
+ 释放哈希表
+ 
+ @param table 哈希表
+ */
+extern void ldm_table_free(ldm_table *table);
+
+/**
+ 调用者缓冲区左移 shift 字节后, 所有位置减去 shift, 移出缓冲区的位置被丢弃
+ 
+ @param table 哈希表
+ @param shift 左移的字节数
+ */
+extern void ldm_table_slide(ldm_table *table, unsigned int shift);
+
+/**
+ 用滚动哈希查找 base[start, end) 中的长距离匹配, 并插入采样的位置
+ 匹配向后扩展到 end, 向前扩展到 start 或上一个匹配的末尾, 匹配之间不重叠
+ 
+ @param table 哈希表
+ @param base 缓冲区, base[0, start) 是之前插入过的历史数据
+ @param start 开始位置
+ @param end 结束位置
+ @param matches 输出的匹配, 按位置升序, 至少 (end - start) / LDM_MIN_LENGTH + 1 个
+ @return 匹配的个数
+ */
+extern unsigned int ldm_find_matches(ldm_table *table, const unsigned char *base, unsigned int start, unsigned int end, ldm_match *matches);
+
+#endif /* ldm_h */
@@ -0,0 +1,689 @@
+//
+// lzh.c
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "lzh.h"
+#include <dispatch/dispatch.h>
+#include "matchfinder.h"
+#include "ldm.h"
+#include "entropy.h"
+#include "bitbyte.h"
+#include "crc32c.h"
+
+// block format, the first byte of the stream, the checksum format adds the CRC-32C of the origin data to the end block
+static const unsigned char kLZHBlockFormat = 1;
+static const unsigned char kLZHChecksumFormat = 2;
+
+// block header: type (1 byte) + origin length (4 bytes, big endian)
+#define LZH_BLOCK_HEADER_SIZE 5
+
+// the window is 1 << log bytes, the log follows the format byte
+static const unsigned int kLZHMinWindowLog = 10;
+static const unsigned int kLZHMaxWindowLog = 30;
+
+// the hash chain covers the nearest bytes of the window, the rest is left to the long-distance matcher
+static const unsigned int kLZHChainWindowSize = 65536;
+
+// values below it are coded as themselves, the others as 12 + log2(value) + log2(value) extra bits
+static const unsigned int kLZHDirectCodes = 16;
+
+// the largest value code, log2(value) < 32
+static const unsigned int kLZHMaxCode = 12 + 31;
+
+// the max extra bytes of a sequence: run, length and offset, 31 bits each
+static const unsigned int kLZHSequenceExtraSize = 12;
+
+// the blocks are split into segments of it, regardless of the threads, so the output does not depend on them
+static const unsigned int kLZHSegmentSize = 32768;
+
+// a lazy parse stops deferring a match of it, longer matches are rarely beaten by the next position
+static const unsigned int kLZHLazyLength = 32;
+
+// the worth of a match to a lazy parse: 4 per byte, less the extra bits of the offset
+static inline int LZHMatchGain(const unsigned int length, const unsigned int offset) {
+    return (int)(length * 4) - (31 - __builtin_clz(offset + 1));
+}
+
+// the probe of a block: runs of positions spread over it (4 KB in all), the match search is skipped when less than
+// 1 / kLZHProbeHitRatio of them repeat kLZHProbeMinLength bytes in the window, the shorter repeats of a small alphabet cost more than they save
+static const unsigned int kLZHProbeRuns = 16;
+static const unsigned int kLZHProbeRunLength = 256;
+static const unsigned int kLZHProbeMinLength = 6;
+static const unsigned int kLZHProbeHitRatio = 16;
+
+// the max sequences of a block, every match is at least MATCH_MIN_LENGTH bytes
+static inline unsigned int LZHMaxSequences(const unsigned int blockSize) {
+    return blockSize / MATCH_MIN_LENGTH + 1;
+}
+
+// the max payload of a compressed block: sequences + literals, 4 streams and the extra bits
+static inline unsigned int LZHMaxPayload(const unsigned int blockSize) {
+    unsigned int sequences = LZHMaxSequences(blockSize);
+    return 8 + ENTROPY_ENCODE_BOUND(blockSize) + ENTROPY_ENCODE_BOUND(sequences) * 3 + sequences * kLZHSequenceExtraSize + 8;
+}
+
+// the log of the window size, rounded up to a power of two in [1 KB, 1 GB]
+static inline unsigned int LZHWindowLog(const unsigned int windowSize) {
+    unsigned int log = kLZHMinWindowLog;
+    while (log < kLZHMaxWindowLog && (1U << log) < windowSize) {
+        log++;
+    }
+    return log;
+}
+
+// the window + the free space of the incoming blocks, the window is moved back once the space runs out
+static inline size_t LZHBufferSize(const unsigned int windowSize, const unsigned int blockSize) {
+    return (size_t)windowSize + (blockSize > windowSize / 4 ? blockSize : windowSize / 4);
+}
+
+static inline void LZHWriteU32(unsigned char *output, const unsigned int value) {
+    output[0] = (unsigned char)(value >> 24);
+    output[1] = (unsigned char)(value >> 16);
+    output[2] = (unsigned char)(value >> 8);
+    output[3] = (unsigned char)value;
+}
+
+static inline unsigned int LZHReadU32(const unsigned char *input) {
+    return (unsigned int)input[0] << 24 | input[1] << 16 | input[2] << 8 | input[3];
+}
+
+// extra bits, LSB-first
+typedef struct {
+    unsigned char *bytes;
+    unsigned int length;
+    unsigned long long bits;
+    unsigned int count;
+} LZHBitWriter;
+
+static inline void LZHWriteBits(LZHBitWriter *writer, const unsigned int value, const unsigned int count) {
+    writer->bits |= (unsigned long long)value << writer->count;
+    writer->count += count;
+    while (writer->count >= 8) {
+        writer->bytes[writer->length++] = (unsigned char)writer->bits;
+        writer->bits >>= 8;
+        writer->count -= 8;
+    }
+}
+
+static inline void LZHFlushBits(LZHBitWriter *writer) {
+    if (writer->count > 0) {
+        writer->bytes[writer->length++] = (unsigned char)writer->bits;
+    }
+    writer->bits = 0;
+    writer->count = 0;
+}
+
+typedef struct {
+    const unsigned char *bytes;
+    unsigned int length;
+    unsigned int position;
+    unsigned long long bits;
+    unsigned int count;
+} LZHBitReader;
+
+// returns -1 if the bytes run out
+static inline int LZHReadBits(LZHBitReader *reader, const unsigned int count, unsigned int *value) {
+    while (reader->count < count) {
+        if (unlikely(reader->position >= reader->length)) {
+            return -1;
+        }
+        reader->bits |= (unsigned long long)reader->bytes[reader->position++] << reader->count;
+        reader->count += 8;
+    }
+    *value = (unsigned int)(reader->bits & ((1ULL << count) - 1));
+    reader->bits >>= count;
+    reader->count -= count;
+    return 0;
+}
+
+// the code of a value, writes the extra bits
+static inline unsigned char LZHEncodeValue(const unsigned int value, LZHBitWriter *writer) {
+    if (value < kLZHDirectCodes) {
+        return (unsigned char)value;
+    }
+    unsigned int n = 31 - __builtin_clz(value);
+    LZHWriteBits(writer, value - (1U << n), n);
+    return (unsigned char)(12 + n);
+}
+
+// the value of a code, reads the extra bits, returns -1 if the code is out of range or the bits run out
+static inline int LZHDecodeValue(const unsigned char code, LZHBitReader *reader, unsigned int *value) {
+    if (code < kLZHDirectCodes) {
+        *value = code;
+        return 0;
+    }
+    if (unlikely(code > kLZHMaxCode)) {
+        return -1;
+    }
+    unsigned int n = code - 12, extra;
+    if (unlikely(LZHReadBits(reader, n, &extra) < 0)) {
+        return -1;
+    }
+    *value = (1U << n) + extra;
+    return 0;
+}
+
+// a match found by a segment search, the same fields as a long-distance match
+typedef ldm_match LZHMatch;
+
+// greedy (or lazy) matches of data[start, stop), a match may run past 'stop' up to 'end' or the next long match,
+// the long matches are skipped, returns the number of matches
+static unsigned int LZHSearchSegment(const match_finder *finder, const unsigned char *data, const unsigned int start, const unsigned int stop, const unsigned int end,
+                                     const ldm_match *longMatches, const unsigned int longCount, const lzh_parse parse, LZHMatch *matches) {
+    unsigned int count = 0, position = start, length, offset, limit, nextLength, nextOffset;
+    // the first long match ending after the start
+    unsigned int next = 0;
+    while (next < longCount && longMatches[next].position + longMatches[next].length <= start) {
+        next++;
+    }
+    while (position < stop) {
+        if (next < longCount && position >= longMatches[next].position) {
+            if (position < longMatches[next].position + longMatches[next].length) {
+                position = longMatches[next].position + longMatches[next].length;
+            }
+            next++;
+            continue;
+        }
+        limit = (next < longCount ? longMatches[next].position : end) - position;
+        length = match_finder_search(finder, data, position, limit, &offset);
+        if (length == 0) {
+            position++;
+            continue;
+        }
+        // lazy: the byte becomes a literal if the next position starts a match worth more,
+        // the current match is favoured by the cost of the literal
+        while (parse == LZH_PARSE_LAZY && length < kLZHLazyLength && position + 1 < stop) {
+            nextLength = match_finder_search(finder, data, position + 1, limit - 1, &nextOffset);
+            if (nextLength == 0 || LZHMatchGain(nextLength, nextOffset) <= LZHMatchGain(length, offset) + 4) {
+                break;
+            }
+            position++;
+            limit--;
+            length = nextLength;
+            offset = nextOffset;
+        }
+        matches[count].position = position;
+        matches[count].length = length;
+        matches[count].offset = offset;
+        count++;
+        position += length;
+    }
+    return count;
+}
+
+// the sequences of a block
+typedef struct {
+    unsigned char *literals;
+    unsigned char *runs;
+    unsigned char *lengths;
+    unsigned char *offsets;
+    unsigned int literalCount;
+    unsigned int count;
+    unsigned int cursor; // the end of the last match
+    LZHBitWriter extra;
+} LZHSequences;
+
+// appends the literal run before the match and the match, a match starting before the cursor is cut (same offset) or dropped
+static inline void LZHAppendMatch(LZHSequences *sequences, const unsigned char *data, unsigned int position, unsigned int length, const unsigned int offset) {
+    if (position < sequences->cursor) {
+        if (position + length < sequences->cursor + MATCH_MIN_LENGTH) {
+            return;
+        }
+        length -= sequences->cursor - position;
+        position = sequences->cursor;
+    }
+    unsigned int run = position - sequences->cursor;
+    memcpy(&sequences->literals[sequences->literalCount], &data[sequences->cursor], run);
+    sequences->literalCount += run;
+    sequences->runs[sequences->count] = LZHEncodeValue(run, &sequences->extra);
+    sequences->lengths[sequences->count] = LZHEncodeValue(length - MATCH_MIN_LENGTH, &sequences->extra);
+    sequences->offsets[sequences->count] = LZHEncodeValue(offset, &sequences->extra);
+    sequences->count++;
+    sequences->cursor = position + length;
+}
+
+struct lzh_encoder {
+    unsigned int block_size;
+    // CRC-32C of the compressed blocks
+    unsigned int checksum;
+    unsigned int window_log;
+    unsigned int window;
+    lzh_parse parse;
+    // window + block
+    unsigned char *data;
+    size_t buffer_size;
+    unsigned int history;
+    // streams
+    LZHSequences sequences;
+    // header + payload length + payload
+    unsigned char *output;
+    // the last huffman tables of the literal, run, length and offset streams, the short blocks of the sync flushes reuse them
+    entropy_table tables[4];
+    // the chain keeps the nearest window + block, the segments search it after all positions are inserted
+    match_finder *finder;
+    // the long-distance matcher covers the rest of a larger window
+    ldm_table *table;
+    ldm_match *long_matches;
+    unsigned int long_count;
+    // segments
+    unsigned int threads;
+    unsigned int segment_matches;
+    LZHMatch *matches;
+    unsigned int *match_counts;
+};
+
+// the segments of a block searched by the workers, worker i takes the segments i, i + stride, ...
+typedef struct {
+    lzh_encoder *encoder;
+    unsigned int start;
+    unsigned int end;
+    unsigned int segments;
+    unsigned int stride;
+} LZHSearchContext;
+
+static void LZHSearchWorker(void *context, size_t worker) {
+    const LZHSearchContext *search = context;
+    lzh_encoder *encoder = search->encoder;
+    for (unsigned int index = (unsigned int)worker; index < search->segments; index += search->stride) {
+        unsigned int start = search->start + index * kLZHSegmentSize;
+        unsigned int stop = start + kLZHSegmentSize < search->end ? start + kLZHSegmentSize : search->end;
+        encoder->match_counts[index] = LZHSearchSegment(encoder->finder, encoder->data, start, stop, search->end,
+                                                        encoder->long_matches, encoder->long_count, encoder->parse, &encoder->matches[index * encoder->segment_matches]);
+    }
+}
+
+// samples the inserted positions of a block, returns 1 if the match search is likely to pay off
+static int LZHProbeBlock(const lzh_encoder *encoder, const unsigned int start, const unsigned int length) {
+    // the short blocks (sync flushes) are searched, sampling them saves little
+    if (length < kLZHProbeRuns * kLZHProbeRunLength * 2) {
+        return 1;
+    }
+    unsigned int stride = length / kLZHProbeRuns, hits = 0, run, i;
+    for (run = 0; run < kLZHProbeRuns; run++) {
+        unsigned int position = start + run * stride;
+        for (i = 0; i < kLZHProbeRunLength; i++) {
+            hits += match_finder_probe(encoder->finder, encoder->data, position + i, kLZHProbeMinLength) >= kLZHProbeMinLength;
+        }
+    }
+    return hits * kLZHProbeHitRatio >= kLZHProbeRuns * kLZHProbeRunLength;
+}
+
+unsigned int lzh_block_bound(const unsigned int block_size) {
+    unsigned int payload = LZHMaxPayload(block_size);
+    return LZH_BLOCK_HEADER_SIZE + 4 + (payload > block_size ? payload : block_size);
+}
+
+lzh_encoder * lzh_encoder_new(const unsigned int block_size, const unsigned int window_size, const unsigned int depth, const lzh_parse parse, const unsigned int threads) {
+    lzh_encoder *encoder = calloc(1, sizeof(lzh_encoder));
+    encoder->block_size = block_size;
+    encoder->parse = parse;
+    // window, 1 << log bytes
+    encoder->window_log = LZHWindowLog(window_size);
+    encoder->window = 1U << encoder->window_log;
+    unsigned int chainWindow = encoder->window < kLZHChainWindowSize ? encoder->window : kLZHChainWindowSize;
+    encoder->buffer_size = LZHBufferSize(encoder->window, block_size);
+    encoder->data = malloc(encoder->buffer_size);
+    unsigned int maxSequences = LZHMaxSequences(block_size);
+    encoder->sequences.literals = malloc(block_size);
+    encoder->sequences.runs = malloc(maxSequences);
+    encoder->sequences.lengths = malloc(maxSequences);
+    encoder->sequences.offsets = malloc(maxSequences);
+    encoder->sequences.extra.bytes = malloc(maxSequences * kLZHSequenceExtraSize + 8);
+    encoder->output = malloc(lzh_block_bound(block_size));
+    encoder->finder = match_finder_new(chainWindow, chainWindow + block_size, depth);
+    if (encoder->window > chainWindow) {
+        encoder->table = ldm_table_new(encoder->window);
+        encoder->long_matches = malloc(sizeof(ldm_match) * (block_size / LDM_MIN_LENGTH + 1));
+    }
+    encoder->threads = threads > 0 ? threads : 1;
+    unsigned int maxSegments = (block_size + kLZHSegmentSize - 1) / kLZHSegmentSize;
+    encoder->segment_matches = LZHMaxSequences(kLZHSegmentSize);
+    encoder->matches = malloc(sizeof(LZHMatch) * encoder->segment_matches * maxSegments);
+    encoder->match_counts = malloc(sizeof(unsigned int) * maxSegments);
+    return encoder;
+}
+
+void lzh_encoder_free(lzh_encoder *encoder) {
+    if (encoder) {
+        free(encoder->match_counts);
+        free(encoder->matches);
+        free(encoder->long_matches);
+        ldm_table_free(encoder->table);
+        match_finder_free(encoder->finder);
+        free(encoder->output);
+        free(encoder->sequences.extra.bytes);
+        free(encoder->sequences.offsets);
+        free(encoder->sequences.lengths);
+        free(encoder->sequences.runs);
+        free(encoder->sequences.literals);
+        free(encoder->data);
+        free(encoder);
+    }
+}
+
+unsigned int lzh_encoder_header(const lzh_encoder *encoder, unsigned char *output) {
+    output[0] = kLZHChecksumFormat;
+    output[1] = (unsigned char)encoder->window_log;
+    return LZH_HEADER_SIZE;
+}
+
+unsigned char * lzh_encoder_buffer(lzh_encoder *encoder) {
+    // move the window back to the start of the buffer once the next block does not fit
+    if (encoder->history + encoder->block_size > encoder->buffer_size) {
+        unsigned int shift = encoder->history - encoder->window;
+        memmove(&encoder->data[0], &encoder->data[shift], encoder->window);
+        match_finder_slide(encoder->finder, shift);
+        if (encoder->table) {
+            ldm_table_slide(encoder->table, shift);
+        }
+        encoder->history = encoder->window;
+    }
+    return &encoder->data[encoder->history];
+}
+
+unsigned int lzh_encoder_compress(lzh_encoder *encoder, const unsigned int length, const unsigned char **output) {
+    unsigned char *data = encoder->data;
+    unsigned int history = encoder->history;
+    LZHSequences *sequences = &encoder->sequences;
+    encoder->checksum = crc32c_update(encoder->checksum, &data[history], length);
+    // stage 1: LZSS matches as sequences of literal run + match
+    unsigned int end = history + length;
+    unsigned int i, j;
+    // long repeats anywhere in the window
+    encoder->long_count = 0;
+    if (encoder->table) {
+        encoder->long_count = ldm_find_matches(encoder->table, data, history, end, encoder->long_matches);
+    }
+    for (i = history; i + MATCH_MIN_LENGTH <= end; i++) {
+        match_finder_insert(encoder->finder, data, i);
+    }
+    // the codec of the block: LZ matches, or the literals alone (entropy_encode picks raw, run, huffman or fse),
+    // the positions are inserted either way, the next blocks may still match them
+    int searched = encoder->long_count > 0 || LZHProbeBlock(encoder, history, length);
+    sequences->literalCount = 0;
+    sequences->count = 0;
+    sequences->cursor = history;
+    sequences->extra.length = 0;
+    if (searched) {
+        // the segments are searched in parallel against the shared window, each parses greedily from its start
+        unsigned int segments = (length + kLZHSegmentSize - 1) / kLZHSegmentSize;
+        LZHSearchContext search = { encoder, history, end, segments, encoder->threads < segments ? encoder->threads : segments };
+        if (search.stride > 1) {
+            dispatch_apply_f(search.stride, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), &search, LZHSearchWorker);
+        } else {
+            LZHSearchWorker(&search, 0);
+        }
+        // the serial pass finalizes the parse: merges the long matches, cuts the matches overlapped by the previous segment
+        const ldm_match *longMatches = encoder->long_matches;
+        unsigned int longCount = encoder->long_count;
+        unsigned int next = 0;
+        for (i = 0; i < segments; i++) {
+            const LZHMatch *segment = &encoder->matches[i * encoder->segment_matches];
+            for (j = 0; j < encoder->match_counts[i]; j++) {
+                for (; next < longCount && longMatches[next].position <= segment[j].position; next++) {
+                    LZHAppendMatch(sequences, data, longMatches[next].position, longMatches[next].length, longMatches[next].offset);
+                }
+                LZHAppendMatch(sequences, data, segment[j].position, segment[j].length, segment[j].offset);
+            }
+        }
+        for (; next < longCount; next++) {
+            LZHAppendMatch(sequences, data, longMatches[next].position, longMatches[next].length, longMatches[next].offset);
+        }
+    }
+    // the trailing literals
+    memcpy(&sequences->literals[sequences->literalCount], &data[sequences->cursor], end - sequences->cursor);
+    sequences->literalCount += end - sequences->cursor;
+    LZHFlushBits(&sequences->extra);
+    // stage 2: entropy coding of each stream, the tables of the streams are restored if the block is stored raw,
+    // the decoder only takes the tables of the compressed blocks
+    entropy_table tables[4];
+    memcpy(tables, encoder->tables, sizeof(tables));
+    unsigned char *block = encoder->output;
+    unsigned int payload = 0;
+    unsigned char *stream = &block[LZH_BLOCK_HEADER_SIZE + 4];
+    LZHWriteU32(&stream[payload], sequences->count);
+    payload += 4;
+    LZHWriteU32(&stream[payload], sequences->literalCount);
+    payload += 4;
+    payload += entropy_encode(sequences->literals, sequences->literalCount, &stream[payload], FSE_DEFAULT_TABLE_LOG, &encoder->tables[0]);
+    payload += entropy_encode(sequences->runs, sequences->count, &stream[payload], FSE_DEFAULT_TABLE_LOG, &encoder->tables[1]);
+    payload += entropy_encode(sequences->lengths, sequences->count, &stream[payload], FSE_DEFAULT_TABLE_LOG, &encoder->tables[2]);
+    payload += entropy_encode(sequences->offsets, sequences->count, &stream[payload], FSE_DEFAULT_TABLE_LOG, &encoder->tables[3]);
+    memcpy(&stream[payload], sequences->extra.bytes, sequences->extra.length);
+    payload += sequences->extra.length;
+    // header
+    unsigned int size;
+    LZHWriteU32(&block[1], length);
+    if (4 + payload < length) {
+        block[0] = LZH_BLOCK_COMPRESSED;
+        LZHWriteU32(&block[LZH_BLOCK_HEADER_SIZE], payload);
+        size = LZH_BLOCK_HEADER_SIZE + 4 + payload;
+    } else {
+        // not smaller than the raw bytes
+        memcpy(encoder->tables, tables, sizeof(tables));
+        block[0] = LZH_BLOCK_RAW;
+        memcpy(&block[LZH_BLOCK_HEADER_SIZE], &data[history], length);
+        size = LZH_BLOCK_HEADER_SIZE + length;
+    }
+    encoder->history = end;
+    *output = block;
+    return size;
+}
+
+unsigned int lzh_encoder_end(const lzh_encoder *encoder, unsigned char *output) {
+    output[0] = LZH_BLOCK_END;
+    LZHWriteU32(&output[1], encoder->checksum);
+    return LZH_END_SIZE;
+}
+
+struct lzh_decoder {
+    unsigned int block_size;
+    // the stream format, the CRC-32C of the decoded blocks is checked at the end block of the checksum format
+    unsigned char format;
+    unsigned int checksum;
+    unsigned int max_sequences;
+    unsigned int max_payload;
+    // window + block, allocated once the window log is read
+    unsigned char *data;
+    size_t buffer_size;
+    unsigned int window;
+    unsigned int history;
+    // streams
+    unsigned char *literals;
+    unsigned char *runs;
+    unsigned char *lengths;
+    unsigned char *offsets;
+    entropy_workspace *workspace;
+    // the last huffman tables of the streams, as the encoder
+    entropy_table tables[4];
+};
+
+lzh_decoder * lzh_decoder_new(const unsigned int block_size) {
+    lzh_decoder *decoder = calloc(1, sizeof(lzh_decoder));
+    decoder->block_size = block_size;
+    decoder->max_sequences = LZHMaxSequences(block_size);
+    decoder->max_payload = LZHMaxPayload(block_size);
+    decoder->literals = malloc(block_size);
+    decoder->runs = malloc(decoder->max_sequences);
+    decoder->lengths = malloc(decoder->max_sequences);
+    decoder->offsets = malloc(decoder->max_sequences);
+    decoder->workspace = malloc(sizeof(entropy_workspace));
+    return decoder;
+}
+
+void lzh_decoder_free(lzh_decoder *decoder) {
+    if (decoder) {
+        free(decoder->workspace);
+        free(decoder->offsets);
+        free(decoder->lengths);
+        free(decoder->runs);
+        free(decoder->literals);
+        free(decoder->data);
+        free(decoder);
+    }
+}
+
+unsigned int lzh_decoder_need(const lzh_decoder *decoder, const unsigned char *input, const unsigned int available) {
+    // format + window log
+    if (decoder->data == NULL) {
+        return LZH_HEADER_SIZE;
+    }
+    // type
+    if (available < 1) {
+        return 1;
+    }
+    if (input[0] == LZH_BLOCK_END) {
+        return decoder->format == kLZHChecksumFormat ? LZH_END_SIZE : 1;
+    }
+    if (unlikely(input[0] > LZH_BLOCK_COMPRESSED)) {
+        return 0;
+    }
+    // origin length
+    if (available < LZH_BLOCK_HEADER_SIZE) {
+        return LZH_BLOCK_HEADER_SIZE;
+    }
+    unsigned int length = LZHReadU32(&input[1]);
+    if (unlikely(length - 1 >= decoder->block_size)) {
+        return 0;
+    }
+    if (input[0] == LZH_BLOCK_RAW) {
+        return LZH_BLOCK_HEADER_SIZE + length;
+    }
+    // payload
+    if (available < LZH_BLOCK_HEADER_SIZE + 4) {
+        return LZH_BLOCK_HEADER_SIZE + 4;
+    }
+    unsigned int payload = LZHReadU32(&input[LZH_BLOCK_HEADER_SIZE]);
+    if (unlikely((payload < 8) | (payload > decoder->max_payload))) {
+        return 0;
+    }
+    return LZH_BLOCK_HEADER_SIZE + 4 + payload;
+}
+
+lzh_status lzh_decoder_decode(lzh_decoder *decoder, const unsigned char *input, const unsigned int input_len, const unsigned char **output, unsigned int *length) {
+    *length = 0;
+    unsigned int need = lzh_decoder_need(decoder, input, input_len);
+    if (unlikely((need == 0) | (need != input_len))) {
+        return LZH_STATUS_CORRUPTED;
+    }
+    // format + window log
+    if (decoder->data == NULL) {
+        if (((input[0] != kLZHBlockFormat) & (input[0] != kLZHChecksumFormat)) | (input[1] < kLZHMinWindowLog) | (input[1] > kLZHMaxWindowLog)) {
+            return LZH_STATUS_CORRUPTED;
+        }
+        decoder->format = input[0];
+        decoder->window = 1U << input[1];
+        decoder->buffer_size = LZHBufferSize(decoder->window, decoder->block_size);
+        decoder->data = malloc(decoder->buffer_size);
+        return LZH_STATUS_HEADER;
+    }
+    if (input[0] == LZH_BLOCK_END) {
+        if (decoder->format == kLZHChecksumFormat && LZHReadU32(&input[1]) != decoder->checksum) {
+            return LZH_STATUS_CHECKSUM;
+        }
+        return LZH_STATUS_END;
+    }
+    // move the window back to the start of the buffer once the next block does not fit
+    if (decoder->history + decoder->block_size > decoder->buffer_size) {
+        memmove(&decoder->data[0], &decoder->data[decoder->history - decoder->window], decoder->window);
+        decoder->history = decoder->window;
+    }
+    unsigned int origin = LZHReadU32(&input[1]);
+    unsigned char *block = &decoder->data[decoder->history];
+    if (input[0] == LZH_BLOCK_RAW) {
+        memcpy(block, &input[LZH_BLOCK_HEADER_SIZE], origin);
+    } else {
+        const unsigned char *payload = &input[LZH_BLOCK_HEADER_SIZE + 4];
+        unsigned int payloadLength = input_len - LZH_BLOCK_HEADER_SIZE - 4;
+        // streams
+        unsigned int sequences = LZHReadU32(&payload[0]);
+        unsigned int literalCount = LZHReadU32(&payload[4]);
+        if (unlikely((sequences > decoder->max_sequences) | (literalCount > origin))) {
+            return LZH_STATUS_CORRUPTED;
+        }
+        unsigned int position = 8;
+        int size = entropy_decode(&payload[position], payloadLength - position, decoder->literals, literalCount, decoder->workspace, &decoder->tables[0]);
+        if (size >= 0) {
+            position += size;
+            size = entropy_decode(&payload[position], payloadLength - position, decoder->runs, sequences, decoder->workspace, &decoder->tables[1]);
+        }
+        if (size >= 0) {
+            position += size;
+            size = entropy_decode(&payload[position], payloadLength - position, decoder->lengths, sequences, decoder->workspace, &decoder->tables[2]);
+        }
+        if (size >= 0) {
+            position += size;
+            size = entropy_decode(&payload[position], payloadLength - position, decoder->offsets, sequences, decoder->workspace, &decoder->tables[3]);
+        }
+        if (unlikely(size < 0)) {
+            return LZH_STATUS_CORRUPTED;
+        }
+        position += size;
+        // sequences: copy the literal run, then the match
+        LZHBitReader extra = { &payload[position], payloadLength - position, 0, 0, 0 };
+        unsigned int window = decoder->window, history = decoder->history;
+        unsigned int cursor = 0, literalCursor = 0, run, matchLength, matchOffset, i, j;
+        for (i = 0; i < sequences; i++) {
+            // the extra bits are read in the order the encoder writes them: run, length, offset
+            if (unlikely(LZHDecodeValue(decoder->runs[i], &extra, &run) < 0 ||
+                         LZHDecodeValue(decoder->lengths[i], &extra, &matchLength) < 0 ||
+                         LZHDecodeValue(decoder->offsets[i], &extra, &matchOffset) < 0)) {
+                return LZH_STATUS_CORRUPTED;
+            }
+            matchLength += MATCH_MIN_LENGTH;
+            if (unlikely((run > literalCount - literalCursor) | (run > origin - cursor))) {
+                return LZH_STATUS_CORRUPTED;
+            }
+            memcpy(&block[cursor], &decoder->literals[literalCursor], run);
+            literalCursor += run;
+            cursor += run;
+            if (unlikely((matchLength > origin - cursor) | (matchOffset - 1 >= (window - 1 < history + cursor ? window - 1 : history + cursor)))) {
+                return LZH_STATUS_CORRUPTED;
+            }
+            unsigned char *target = &block[cursor];
+            const unsigned char *source = target - matchOffset;
+            if (matchOffset >= matchLength) {
+                memcpy(target, source, matchLength);
+            } else {
+                // overlapped, repeats the last matchOffset bytes
+                for (j = 0; j < matchLength; j++) {
+                    target[j] = source[j];
+                }
+            }
+            cursor += matchLength;
+        }
+        // the trailing literals
+        if (unlikely(literalCount - literalCursor != origin - cursor)) {
+            return LZH_STATUS_CORRUPTED;
+        }
+        memcpy(&block[cursor], &decoder->literals[literalCursor], literalCount - literalCursor);
+    }
+    if (decoder->format == kLZHChecksumFormat) {
+        decoder->checksum = crc32c_update(decoder->checksum, block, origin);
+    }
+    decoder->history += origin;
+    *output = block;
+    *length = origin;
+    return LZH_STATUS_BLOCK;
+}
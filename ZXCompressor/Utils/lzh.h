@@ -0,0 +1,108 @@
+//
+// lzh.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef lzh_h
+#define lzh_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* LZSS + Huffman/FSE (two stages, deflate-class), the stateful coder behind ZXCompressor+LZH and the stream objects.
+   The stream is [format (1 byte)][window log (1 byte)] followed by blocks of [type (1 byte)][origin length (4 bytes, big endian)],
+   a compressed block carries [payload length (4 bytes, big endian)][payload], a raw block the origin bytes,
+   the end block is the type byte and the CRC-32C of the origin data (4 bytes, big endian, format 2, format 1 has no checksum).
+   Every block is byte-aligned, the window carries over between the blocks.
+   The encoder samples every block before the match search, a block with few repeats is a compressed block of literals alone. */
+
+/* the stream header: format + window log */
+#define LZH_HEADER_SIZE 2
+
+/* the end block: type + checksum */
+#define LZH_END_SIZE 5
+
+/* the block types */
+typedef enum {
+    LZH_BLOCK_END = 0, // end of stream
+    LZH_BLOCK_RAW, // stored bytes
+    LZH_BLOCK_COMPRESSED, // payload length + sequences + streams
+} lzh_block_type;
+
+/* the result of lzh_decoder_decode() */
+typedef enum {
+    LZH_STATUS_HEADER = 0, // the stream header is read
+    LZH_STATUS_BLOCK, // a block is decoded
+    LZH_STATUS_END, // the end block is read
+    LZH_STATUS_CORRUPTED, // invalid input
+    LZH_STATUS_CHECKSUM, // the end block is read, the decoded data does not match its checksum
+} lzh_status;
+
+/* the parse of the matches, the encoder only */
+typedef enum {
+    LZH_PARSE_GREEDY = 0, // the longest match at each position
+    LZH_PARSE_LAZY, // a match is deferred by a literal while the next position has a better one (longer, or much nearer)
+} lzh_parse;
+
+typedef struct lzh_encoder lzh_encoder;
+typedef struct lzh_decoder lzh_decoder;
+
+/* the output size bound of a block (header included) */
+extern unsigned int lzh_block_bound(const unsigned int block_size);
+
+/* create an encoder, the window is rounded up to a power of two in [1 KB, 1 GB],
+   'depth' is the max candidates of a match search, 'parse' picks the matches (the stream does not depend on it),
+   'threads' (at least 1) search the segments of a block */
+extern lzh_encoder * lzh_encoder_new(const unsigned int block_size, const unsigned int window_size, const unsigned int depth, const lzh_parse parse, const unsigned int threads);
+
+extern void lzh_encoder_free(lzh_encoder *encoder);
+
+/* write the stream header, returns LZH_HEADER_SIZE */
+extern unsigned int lzh_encoder_header(const lzh_encoder *encoder, unsigned char *output);
+
+/* the place of the next block, up to block_size bytes are copied there before lzh_encoder_compress(),
+   the window may be moved back, so the pointer is only valid until the block is compressed */
+extern unsigned char * lzh_encoder_buffer(lzh_encoder *encoder);
+
+/* compress the 'length' (1 ~ block_size) bytes of the buffer as a block, they become a part of the window,
+   '*output' points to the block in the encoder (valid until the next call), returns the block length in bytes */
+extern unsigned int lzh_encoder_compress(lzh_encoder *encoder, const unsigned int length, const unsigned char **output);
+
+/* write the end block with the checksum of the compressed blocks, returns LZH_END_SIZE */
+extern unsigned int lzh_encoder_end(const lzh_encoder *encoder, unsigned char *output);
+
+/* create a decoder, 'block_size' is the max block size, the window is allocated once the header is read */
+extern lzh_decoder * lzh_decoder_new(const unsigned int block_size);
+
+extern void lzh_decoder_free(lzh_decoder *decoder);
+
+/* the bytes of the next unit (the header or a block) given its first 'available' bytes:
+   more than 'available' if the unit is incomplete, 0 if the prefix is invalid */
+extern unsigned int lzh_decoder_need(const lzh_decoder *decoder, const unsigned char *input, const unsigned int available);
+
+/* decode a complete unit of lzh_decoder_need() bytes, a decoded block is '*length' bytes at '*output'
+   (in the window, valid until the next call) */
+extern lzh_status lzh_decoder_decode(lzh_decoder *decoder, const unsigned char *input, const unsigned int input_len, const unsigned char **output, unsigned int *length);
+
+#endif /* lzh_h */
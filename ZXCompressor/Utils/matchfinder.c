@@ -0,0 +1,145 @@
+//
+// matchfinder.c
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "matchfinder.h"
+#include "bitbyte.h"
+#include "hash.h"
+
+match_finder * match_finder_new(unsigned int window_size, unsigned int chain_size, unsigned int depth) {
+    match_finder *finder = malloc(sizeof(match_finder));
+    // 向上取整为 2 的幂, 链表用位与取下标
+    unsigned int size = 1;
+    while ((size < window_size || size < chain_size) && size < 0x80000000U) {
+        size <<= 1;
+    }
+    finder->window_size = window_size;
+    finder->chain_size = size;
+    finder->depth = depth > 0 ? depth : 1;
+    finder->head = malloc(sizeof(unsigned int) << MATCH_HASH_BITS);
+    finder->chain = malloc(sizeof(unsigned int) * (size_t)size);
+    match_finder_reset(finder);
+    return finder;
+}
+
+void match_finder_free(match_finder *finder) {
+    if (finder) {
+        free(finder->chain);
+        free(finder->head);
+        free(finder);
+    }
+}
+
+void match_finder_reset(match_finder *finder) {
+    memset(finder->head, 0, sizeof(unsigned int) << MATCH_HASH_BITS);
+    memset(finder->chain, 0, sizeof(unsigned int) * (size_t)finder->chain_size);
+}
+
+// 反转 chain[begin, end)
+static void MatchFinderReverse(unsigned int *chain, unsigned int begin, unsigned int end) {
+    while (begin + 1 < end) {
+        unsigned int value = chain[begin];
+        chain[begin++] = chain[--end];
+        chain[end] = value;
+    }
+}
+
+void match_finder_slide(match_finder *finder, unsigned int shift) {
+    unsigned int i;
+    for (i = 0; i < 1U << MATCH_HASH_BITS; i++) {
+        finder->head[i] = finder->head[i] > shift ? finder->head[i] - shift : 0;
+    }
+    // 链表按位置取模存放, 左移 shift 后下标也要移动: 原地循环左移 shift & mask (三次反转), 不分配内存
+    unsigned int mask = finder->chain_size - 1;
+    unsigned int rotate = shift & mask;
+    if (rotate > 0) {
+        MatchFinderReverse(finder->chain, 0, rotate);
+        MatchFinderReverse(finder->chain, rotate, mask + 1);
+        MatchFinderReverse(finder->chain, 0, mask + 1);
+    }
+    for (i = 0; i <= mask; i++) {
+        finder->chain[i] = finder->chain[i] > shift ? finder->chain[i] - shift : 0;
+    }
+}
+
+void match_finder_insert(match_finder *finder, const unsigned char *base, unsigned int pos) {
+    // 前 4 个字节的乘法哈希, 取高位
+    unsigned int hash = hash4(&base[pos], MATCH_HASH_BITS);
+    finder->chain[pos & (finder->chain_size - 1)] = finder->head[hash];
+    finder->head[hash] = pos + 1;
+}
+
+unsigned int match_finder_find(match_finder *finder, const unsigned char *base, unsigned int pos, unsigned int limit, unsigned int *offset) {
+    if (limit < MATCH_MIN_LENGTH) {
+        *offset = 0;
+        return 0;
+    }
+    match_finder_insert(finder, base, pos);
+    return match_finder_search(finder, base, pos, limit, offset);
+}
+
+unsigned int match_finder_search(const match_finder *finder, const unsigned char *base, unsigned int pos, unsigned int limit, unsigned int *offset) {
+    unsigned int best = 0;
+    *offset = 0;
+    if (limit < MATCH_MIN_LENGTH) {
+        return 0;
+    }
+    unsigned int mask = finder->chain_size - 1;
+    unsigned int next = finder->chain[pos & mask];
+    // 沿哈希链查找, 越近的位置越先比较
+    unsigned int depth = finder->depth;
+    while (next > 0 && depth-- > 0) {
+        unsigned int candidate = next - 1;
+        if (pos - candidate >= finder->window_size) {
+            break;
+        }
+        next = finder->chain[candidate & mask];
+        // 先比较最长匹配之后的字节, 不可能更长的候选直接跳过
+        if (base[candidate + best] != base[pos + best]) {
+            continue;
+        }
+        unsigned int length = match_length(&base[candidate], &base[pos], limit);
+        if (length > best) {
+            best = length;
+            *offset = pos - candidate;
+            if (length == limit) {
+                break;
+            }
+        }
+    }
+    if (best < MATCH_MIN_LENGTH) {
+        *offset = 0;
+        return 0;
+    }
+    return best;
+}
+
+unsigned int match_finder_probe(const match_finder *finder, const unsigned char *base, unsigned int pos, unsigned int limit) {
+    unsigned int prev = finder->chain[pos & (finder->chain_size - 1)];
+    if (limit < MATCH_MIN_LENGTH || prev == 0 || pos - (prev - 1) >= finder->window_size) {
+        return 0;
+    }
+    unsigned int length = match_length(&base[prev - 1], &base[pos], limit);
+    return length < MATCH_MIN_LENGTH ? 0 : length;
+}
@@ -0,0 +1,131 @@
+//
+// matchfinder.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef matchfinder_h
+#define matchfinder_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 最短匹配长度, 短于它的匹配按字面量(literal)输出 */
+#define MATCH_MIN_LENGTH 4
+
+/* 哈希表的位数(1 << MATCH_HASH_BITS 个链表头) */
+#define MATCH_HASH_BITS 16
+
+/**
+ 哈希链(hash chain)匹配查找器
+ 位置是调用者缓冲区中的绝对位置, 链表中保存 位置 + 1(0 表示空)
+ */
+typedef struct match_finder {
+    unsigned int window_size; // 滑动窗口大小, 最大匹配偏移为 window_size - 1
+    unsigned int chain_size; // 链表大小, 2 的幂, 不小于 window_size
+    unsigned int depth; // 每次查找最多比较的候选位置数
+    unsigned int *head; // 哈希值 -> 最近的位置
+    unsigned int *chain; // 位置 & (chain_size - 1) -> 上一个相同哈希值的位置
+} match_finder;
+
+/**
+ 创建匹配查找器
+ 
+ @param window_size 滑动窗口大小, 最大匹配偏移为 window_size - 1
+ @param chain_size 链表大小, 向上取整为 2 的幂(至少 window_size)
+ 查找的位置之后最多还能插入 chain_size - window_size 个位置(见 match_finder_search)
+ @param depth 搜索深度, 越大压缩率越高, 速度越慢
+ @return 匹配查找器
+ */
+extern match_finder * match_finder_new(unsigned int window_size, unsigned int chain_size, unsigned int depth);
+
+/**
+ 释放匹配查找器
+ 
+ @param finder 匹配查找器
+ */
+extern void match_finder_free(match_finder *finder);
+
+/**
+ 清空所有位置
+ 
+ @param finder 匹配查找器
+ */
+extern void match_finder_reset(match_finder *finder);
+
+/**
+ 调用者缓冲区左移 shift 字节后, 所有位置减去 shift, 移出缓冲区的位置被丢弃
+ 
+ @param finder 匹配查找器
+ @param shift 左移的字节数
+ */
+extern void match_finder_slide(match_finder *finder, unsigned int shift);
+
+/**
+ 插入位置(不查找), 位置必须按升序插入
+ base[pos] 起至少要有 MATCH_MIN_LENGTH 个字节可读
+ 
+ @param finder 匹配查找器
+ @param base 缓冲区
+ @param pos 位置
+ */
+extern void match_finder_insert(match_finder *finder, const unsigned char *base, unsigned int pos);
+
+/**
+ 查找 base[pos] 在滑动窗口中最长的匹配, 并插入 pos
+ 
+ @param finder 匹配查找器
+ @param base 缓冲区
+ @param pos 位置
+ @param limit base[pos] 起可读的字节数(最大匹配长度)
+ @param offset 匹配成功后, 匹配位置到 pos 的距离, [1, window_size - 1]
+ @return 匹配长度, 0 或 [MATCH_MIN_LENGTH, limit]
+ */
+extern unsigned int match_finder_find(match_finder *finder, const unsigned char *base, unsigned int pos, unsigned int limit, unsigned int *offset);
+
+/**
+ 查找已插入的位置 pos 的最长匹配(只读, 不修改查找器), 多个线程可以同时查找
+ 只比较 pos 之前的位置, pos 之后最多插入了 chain_size - window_size 个位置
+ 
+ @param finder 匹配查找器
+ @param base 缓冲区
+ @param pos 已插入的位置
+ @param limit base[pos] 起可读的字节数(最大匹配长度)
+ @param offset 匹配成功后, 匹配位置到 pos 的距离, [1, window_size - 1]
+ @return 匹配长度, 0 或 [MATCH_MIN_LENGTH, limit]
+ */
+extern unsigned int match_finder_search(const match_finder *finder, const unsigned char *base, unsigned int pos, unsigned int limit, unsigned int *offset);
+
+/**
+ 探测已插入的位置 pos 的匹配(只读), 只比较哈希链中 pos 的上一个位置
+ 比 match_finder_search 快得多, 用于在查找之前估计数据能否匹配
+ 
+ @param finder 匹配查找器
+ @param base 缓冲区
+ @param pos 已插入的位置
+ @param limit base[pos] 起可读的字节数(最大匹配长度)
+ @return 匹配长度, 0 或 [MATCH_MIN_LENGTH, limit]
+ */
+extern unsigned int match_finder_probe(const match_finder *finder, const unsigned char *base, unsigned int pos, unsigned int limit);
+
+#endif /* matchfinder_h */
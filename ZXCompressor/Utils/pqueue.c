@@ -21,19 +21,25 @@ void pqueue_node_free(pqueue_node *node) {
 }
 
 pqueue_heap * pqueue_heap_new(unsigned int size) {
-    pqueue_heap *heap = malloc(sizeof(pqueue_heap));
+    return pqueue_heap_new_arena(size, NULL);
+}
+
+pqueue_heap * pqueue_heap_new_arena(unsigned int size, arena *arena) {
+    pqueue_heap *heap = arena ? arena_alloc(arena, sizeof(pqueue_heap)) : malloc(sizeof(pqueue_heap));
     heap->size = size;
     if (heap->size > 0) {
-        heap->nodes = malloc(heap->size * sizeof (pqueue_node));
+        heap->nodes = arena ? arena_alloc(arena, heap->size * sizeof (pqueue_node)) : malloc(heap->size * sizeof (pqueue_node));
     } else {
         heap->nodes = NULL;
     }
     heap->used = 0;
+    heap->arena = arena;
     return heap;
 }
 
 void pqueue_heap_free(pqueue_heap *heap) {
-    if (heap) {
+    // released with the arena
+    if (heap && heap->arena == NULL) {
         if (heap->nodes) {
             free(heap->nodes);
             heap->nodes = NULL;
@@ -47,7 +53,16 @@ void pqueue_heap_free(pqueue_heap *heap) {
 void pqueue_heap_push(pqueue_heap *heap, int priority, void *data) {
     if (heap->used >= heap->size) {
         heap->size = heap->size ? heap->size * 2 : 4;
-        heap->nodes = (pqueue_node *)realloc(heap->nodes, heap->size * sizeof (pqueue_node));
+        if (heap->arena) {
+            // the old nodes are released with the arena
+            pqueue_node *nodes = arena_alloc(heap->arena, heap->size * sizeof (pqueue_node));
+            if (heap->used > 0) {
+                memcpy(nodes, heap->nodes, heap->used * sizeof (pqueue_node));
+            }
+            heap->nodes = nodes;
+        } else {
+            heap->nodes = (pqueue_node *)realloc(heap->nodes, heap->size * sizeof (pqueue_node));
+        }
     }
     int i = heap->used;
     int j = (i - 1) / 2;
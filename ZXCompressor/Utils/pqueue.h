@@ -7,6 +7,8 @@
 #define pqueue_h
 
 #include <stdlib.h>
+#include <string.h>
+#include "arena.h"
 
 typedef struct pqueue_node {
     int priority;
@@ -17,12 +19,15 @@ typedef struct pqueue_heap {
     pqueue_node *nodes;
     unsigned int size;
     unsigned int used;
+    struct arena *arena; // NULL for malloc
 } pqueue_heap;
 
 extern pqueue_node * pqueue_node_new(int priority, void *data);
 extern void pqueue_node_free(pqueue_node *node);
 
 extern pqueue_heap * pqueue_heap_new(unsigned int size);
+// the heap and its nodes are allocated from the arena, released with it (pqueue_heap_free does nothing)
+extern pqueue_heap * pqueue_heap_new_arena(unsigned int size, arena *arena);
 extern void pqueue_heap_free(pqueue_heap *heap);
 
 extern void pqueue_heap_push(pqueue_heap *heap, int priority, void *data);
@@ -0,0 +1,109 @@
+//
+// ZXCChunkStore.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#import "ZXCompressor.h"
+
+/**
+ ZXCChunkStore
+ 
+ The local store of the content-defined chunks (deduplication), a chunk is stored once by its SHA-256 digest,
+ the files are compressed to manifests referencing the chunks, see compressFileAtPath:toPath:chunkStore:completion:
+ */
+@interface ZXCChunkStore : NSObject
+
+/** The store directory, a chunk is at <path>/<first 2 hex digits>/<hex digest> */
+@property (nonatomic, readonly, copy) NSString *path;
+
+/** The algorithm compressing the new chunks, recorded in each chunk */
+@property (nonatomic, readonly) ZXCAlgorithm algorithm;
+
+/** The options compressing and decompressing the chunks, see ZXCompressorOptions, nil for the defaults */
+@property (nonatomic, readonly, copy) ZXCompressorOptions *options;
+
+/**
+ Open (or create) the store, the chunks are compressed using kZXCAlgorithmDefault
+
+ @param path The store directory
+ @return The store
+ */
+- (instancetype)initWithPath:(NSString *)path;
+
+/**
+ Open (or create) the store
+
+ @param path The store directory
+ @param algorithm The algorithm compressing the new chunks, see ZXCAlgorithm
+ @return The store
+ */
+- (instancetype)initWithPath:(NSString *)path algorithm:(ZXCAlgorithm)algorithm;
+
+/**
+ Open (or create) the store with options, a store must be opened with the same options (block size, dictionary policy) to read its chunks
+
+ @param path The store directory
+ @param algorithm The algorithm compressing the new chunks, see ZXCAlgorithm
+ @param options The options compressing and decompressing the chunks, see ZXCompressorOptions, nil for the defaults
+ @return The store
+ */
+- (instancetype)initWithPath:(NSString *)path algorithm:(ZXCAlgorithm)algorithm options:(ZXCompressorOptions *)options NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ The SHA-256 digest of the chunk
+
+ @param chunk The chunk content
+ @return The digest, 32 bytes
+ */
++ (NSData *)digestOfChunk:(NSData *)chunk;
+
+/**
+ Whether the chunk is in the store
+
+ @param digest The chunk digest
+ @return YES if the chunk is stored
+ */
+- (BOOL)containsChunkWithDigest:(NSData *)digest;
+
+/**
+ Compress and store the chunk, nothing is written if it is already stored
+
+ @param chunk The chunk content
+ @param digest The chunk digest, see digestOfChunk:
+ @param error The file error
+ @return YES if the chunk is stored
+ */
+- (BOOL)addChunk:(NSData *)chunk digest:(NSData *)digest error:(NSError **)error;
+
+/**
+ Load and decompress the chunk, the content is verified against the digest
+
+ @param digest The chunk digest
+ @param error The file error, or ZXCompressorErrorDomain if the chunk is corrupted
+ @return The chunk content, nil if failed
+ */
+- (NSData *)chunkWithDigest:(NSData *)digest error:(NSError **)error;
+
+@end
@@ -0,0 +1,108 @@
+//
+// ZXCChunkStore.m
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#import "ZXCChunkStore.h"
+#import "ZXCompressorOptions.h"
+#import <CommonCrypto/CommonDigest.h>
+
+@implementation ZXCChunkStore
+
+- (instancetype)initWithPath:(NSString *)path {
+    return [self initWithPath:path algorithm:kZXCAlgorithmDefault];
+}
+
+- (instancetype)initWithPath:(NSString *)path algorithm:(ZXCAlgorithm)algorithm {
+    return [self initWithPath:path algorithm:algorithm options:nil];
+}
+
+- (instancetype)initWithPath:(NSString *)path algorithm:(ZXCAlgorithm)algorithm options:(ZXCompressorOptions *)options {
+    self = [super init];
+    if (self) {
+        _path = [path copy];
+        _algorithm = algorithm;
+        _options = [options copy];
+        [[NSFileManager defaultManager] createDirectoryAtPath:_path withIntermediateDirectories:YES attributes:nil error:nil];
+    }
+    return self;
+}
+
++ (NSData *)digestOfChunk:(NSData *)chunk {
+    NSMutableData *digest = [NSMutableData dataWithLength:CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(chunk.bytes, (CC_LONG)chunk.length, digest.mutableBytes);
+    return digest;
+}
+
+- (NSString *)pathOfChunkWithDigest:(NSData *)digest {
+    const unsigned char *bytes = digest.bytes;
+    NSMutableString *name = [NSMutableString stringWithCapacity:digest.length * 2];
+    for (NSUInteger i = 0; i < digest.length; i++) {
+        [name appendFormat:@"%02x", bytes[i]];
+    }
+    return [[_path stringByAppendingPathComponent:[name substringToIndex:MIN(2, name.length)]] stringByAppendingPathComponent:name];
+}
+
+- (BOOL)containsChunkWithDigest:(NSData *)digest {
+    return [[NSFileManager defaultManager] fileExistsAtPath:[self pathOfChunkWithDigest:digest]];
+}
+
+- (BOOL)addChunk:(NSData *)chunk digest:(NSData *)digest error:(NSError **)error {
+    NSString *path = [self pathOfChunkWithDigest:digest];
+    if ([[NSFileManager defaultManager] fileExistsAtPath:path]) {
+        return YES;
+    }
+    if (![[NSFileManager defaultManager] createDirectoryAtPath:[path stringByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:error]) {
+        return NO;
+    }
+    // algorithm (1 byte) + compressed chunk
+    unsigned char algorithm = (unsigned char)_algorithm;
+    NSMutableData *data = [NSMutableData dataWithBytes:&algorithm length:sizeof(algorithm)];
+    [ZXCompressor compressData:chunk usingAlgorithm:_algorithm options:_options completion:^(NSData *compressed) {
+        [data appendData:compressed];
+    }];
+    return [data writeToFile:path options:NSDataWritingAtomic error:error];
+}
+
+- (NSData *)chunkWithDigest:(NSData *)digest error:(NSError **)error {
+    NSData *data = [NSData dataWithContentsOfFile:[self pathOfChunkWithDigest:digest] options:0 error:error];
+    if (!data) {
+        return nil;
+    }
+    __block NSData *chunk = nil;
+    if (data.length > 0) {
+        ZXCAlgorithm algorithm = (ZXCAlgorithm)((const unsigned char *)data.bytes)[0];
+        [ZXCompressor decompressData:[data subdataWithRange:NSMakeRange(1, data.length - 1)] usingAlgorithm:algorithm options:_options completion:^(NSData *data) {
+            chunk = data;
+        }];
+    }
+    if (!chunk || ![[ZXCChunkStore digestOfChunk:chunk] isEqualToData:digest]) {
+        if (error) {
+            *error = [NSError errorWithDomain:ZXCompressorErrorDomain code:kZXCErrorCorrupted userInfo:nil];
+        }
+        return nil;
+    }
+    return chunk;
+}
+
+@end
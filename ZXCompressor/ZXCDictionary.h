@@ -0,0 +1,95 @@
+//
+// ZXCDictionary.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#import "ZXCompressor.h"
+
+struct hash_table;
+struct code_table;
+
+/**
+ ZXCDictionary
+ 
+ The pre-trained dictionary for small and similar data (JSON, logs, records ...),
+ the compressor and the decompressor must use the same dictionary
+ */
+@interface ZXCDictionary : NSObject
+
+/** The dictionary id, written into the compressed data and verified by the decompressor */
+@property (nonatomic, readonly) unsigned int identifier;
+
+/** The dictionary content, the most useful bytes are at the end */
+@property (nonatomic, readonly, copy) NSData *data;
+
+/**
+ Create the dictionary with raw content, the identifier is the hash of the content
+
+ @param data The dictionary content
+ @return The dictionary
+ */
+- (instancetype)initWithData:(NSData *)data;
+
+/**
+ Create the dictionary with raw content and identifier
+
+ @param data The dictionary content
+ @param identifier The dictionary id, 0 is reserved for no dictionary
+ @return The dictionary
+ */
+- (instancetype)initWithData:(NSData *)data identifier:(unsigned int)identifier NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Train the dictionary from samples
+
+ @param samples The sample data, similar to the data will be compressed
+ @param size The max size of the dictionary, 4 KB ~ 64 KB is recommended, below 64 bytes the last bytes of the samples are used
+ @return The dictionary, nil if there is no sample
+ */
++ (instancetype)dictionaryWithSamples:(NSArray<NSData *> *)samples size:(NSUInteger)size;
+
+/**
+ The code table primed with the dictionary content, built once and shared,
+ read only, the code dictionaries of the coders (codeTableForAlgorithm:tableSize:policy:) are built from it
+
+ @param algorithm kZXCAlgorithmLZ78 or kZXCAlgorithmLZW
+ @param tableSize The code table size
+ @param inverse NO for the compressor (string -> code), YES for the decompressor (code -> string)
+ @return The code table, owned by the dictionary
+ */
+- (struct hash_table *)tableForAlgorithm:(ZXCAlgorithm)algorithm tableSize:(unsigned int)tableSize inverse:(BOOL)inverse;
+
+/**
+ The LZ78/LZW code dictionary primed with the dictionary content and sealed, built once per
+ table size and policy and shared, the coders must copy it (code_table_copy) before use
+
+ @param algorithm kZXCAlgorithmLZ78 or kZXCAlgorithmLZW
+ @param tableSize The code table size
+ @param policy What the coder does when the code dictionary is full
+ @return The code dictionary, owned by the dictionary
+ */
+- (struct code_table *)codeTableForAlgorithm:(ZXCAlgorithm)algorithm tableSize:(unsigned int)tableSize policy:(ZXCDictionaryPolicy)policy;
+
+@end
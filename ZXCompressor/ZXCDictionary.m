@@ -0,0 +1,133 @@
+//
+// ZXCDictionary.m
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#import "ZXCDictionary.h"
+#import "ZXCompressor+LZ78.h"
+#import "ZXCompressor+LZW.h"
+#import "dictionary.h"
+#import "hash.h"
+#import "hashtable.h"
+#import "codetable.h"
+
+@interface ZXCDictionary ()
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSValue *> *tables;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSValue *> *codeTables;
+
+@end
+
+@implementation ZXCDictionary
+
+- (instancetype)initWithData:(NSData *)data {
+    unsigned int identifier = simple_hash((const char *)data.bytes, (unsigned int)data.length);
+    return [self initWithData:data identifier:identifier ? identifier : 1];
+}
+
+- (instancetype)initWithData:(NSData *)data identifier:(unsigned int)identifier {
+    self = [super init];
+    if (self) {
+        _data = data ? [data copy] : [NSData data];
+        _identifier = identifier;
+        _tables = [NSMutableDictionary dictionary];
+        _codeTables = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSValue *value in _tables.allValues) {
+        hashtable_free(value.pointerValue);
+    }
+    for (NSValue *value in _codeTables.allValues) {
+        code_table_free(value.pointerValue);
+    }
+}
+
++ (instancetype)dictionaryWithSamples:(NSArray<NSData *> *)samples size:(NSUInteger)size {
+    if (samples.count == 0 || size == 0) {
+        return nil;
+    }
+    NSMutableData *buffer = [NSMutableData data];
+    unsigned int *sizes = malloc(samples.count * sizeof(unsigned int));
+    for (NSUInteger i = 0; i < samples.count; i++) {
+        sizes[i] = (unsigned int)samples[i].length;
+        [buffer appendData:samples[i]];
+    }
+    unsigned int capacity = (unsigned int)MIN(size, UINT_MAX);
+    unsigned char *dictionary = malloc(capacity);
+    unsigned int length = dictionary_train(buffer.bytes, sizes, (unsigned int)samples.count, dictionary, capacity);
+    NSData *data = [NSData dataWithBytesNoCopy:dictionary length:length freeWhenDone:YES];
+    free(sizes);
+    return length > 0 ? [[self alloc] initWithData:data] : nil;
+}
+
+- (struct hash_table *)tableForAlgorithm:(ZXCAlgorithm)algorithm tableSize:(unsigned int)tableSize inverse:(BOOL)inverse {
+    NSString *key = [NSString stringWithFormat:@"%d-%u", algorithm, tableSize];
+    NSString *inverseKey = [key stringByAppendingString:@"-inverse"];
+    @synchronized (self) {
+        // 编码表(字符串 -> 编码)
+        hashtable *table = [self.tables[key] pointerValue];
+        if (table == NULL) {
+            if (algorithm == kZXCAlgorithmLZ78) {
+                table = [ZXCompressor tableUsingLZ78:tableSize dictionary:self.data];
+            } else if (algorithm == kZXCAlgorithmLZW) {
+                table = [ZXCompressor tableUsingLZW:tableSize dictionary:self.data];
+            } else {
+                return NULL;
+            }
+            self.tables[key] = [NSValue valueWithPointer:table];
+        }
+        // 解码表(编码 -> 字符串)
+        if (inverse) {
+            hashtable *inverseTable = [self.tables[inverseKey] pointerValue];
+            if (inverseTable == NULL) {
+                inverseTable = hashtable_invert(table);
+                self.tables[inverseKey] = [NSValue valueWithPointer:inverseTable];
+            }
+            return inverseTable;
+        }
+        return table;
+    }
+}
+
+- (struct code_table *)codeTableForAlgorithm:(ZXCAlgorithm)algorithm tableSize:(unsigned int)tableSize policy:(ZXCDictionaryPolicy)policy {
+    NSString *key = [NSString stringWithFormat:@"%d-%u-%d", algorithm, tableSize, policy];
+    @synchronized (self) {
+        code_table *table = [self.codeTables[key] pointerValue];
+        if (table == NULL) {
+            // 按编码表建一次, 之后只复制
+            if (algorithm == kZXCAlgorithmLZ78) {
+                table = [ZXCompressor codeTableUsingLZ78:tableSize dictionary:self policy:policy];
+            } else if (algorithm == kZXCAlgorithmLZW) {
+                table = [ZXCompressor codeTableUsingLZW:tableSize dictionary:self policy:policy];
+            } else {
+                return NULL;
+            }
+            self.codeTables[key] = [NSValue valueWithPointer:table];
+        }
+        return table;
+    }
+}
+
+@end
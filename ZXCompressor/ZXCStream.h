@@ -0,0 +1,150 @@
+//
+// ZXCStream.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#import "ZXCompressor.h"
+
+/**
+ ZXCStreamCompressor
+ 
+ Incremental compressor for sockets and message feeds, the input is pushed in pieces of any size and the blocks are
+ written as soon as they are complete, the window carries over between the pieces, the memory is bounded by the window + a block.
+ The output is a kZXCAlgorithmLZH stream, it can also be read by decompressData:usingAlgorithm:completion:
+ */
+@interface ZXCStreamCompressor : NSObject
+
+/**
+ Create the compressor with a 64 KB window
+
+ @param writeBuffer The output, called with the stream header before the first block
+ @return The compressor
+ */
+- (instancetype)initWithWriteBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer;
+
+/**
+ Create the compressor
+
+ @param windowSize The sliding window size, rounded up to a power of two in [1 KB, 1 GB], the decompressor holds the same window
+ @param writeBuffer The output, called with the stream header before the first block
+ @return The compressor
+ */
+- (instancetype)initWithWindowSize:(unsigned int)windowSize writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer;
+
+/**
+ Create the compressor with options, the window size, depth, parse, block size and threads are used
+
+ @param options The options, see ZXCompressorOptions, nil for the defaults, the decompressor must use the same block size
+ @param writeBuffer The output, called with the stream header before the first block
+ @return The compressor
+ */
+- (instancetype)initWithOptions:(ZXCompressorOptions *)options writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Push the input, every complete block (128 KB by default) is compressed and written
+
+ @param bytes The input bytes
+ @param length The input length in bytes
+ */
+- (void)updateWithBytes:(const void *)bytes length:(NSUInteger)length;
+
+/**
+ Push the input
+
+ @param data The input data
+ */
+- (void)updateWithData:(NSData *)data;
+
+/**
+ Compress and write the pending input as a (short) block (sync flush), the window is kept, so the next input still matches it
+ The block is byte-aligned, the decompressor outputs all input pushed before the flush once it gets the block,
+ a short block reuses the last Huffman tables of the stream instead of sending new ones
+ */
+- (void)flush;
+
+/**
+ Flush and write the end of the stream, the compressor can not be updated any more
+ */
+- (void)finish;
+
+@end
+
+/**
+ ZXCStreamDecompressor
+ 
+ Incremental decompressor of the ZXCStreamCompressor (or kZXCAlgorithmLZH) stream,
+ the compressed input is pushed in pieces of any size and every block is written once it is complete
+ */
+@interface ZXCStreamDecompressor : NSObject
+
+/** Whether the end of the stream is read */
+@property (nonatomic, readonly, getter=isFinished) BOOL finished;
+
+/**
+ Create the decompressor
+
+ @param writeBuffer The output, called with every decoded block
+ @return The decompressor
+ */
+- (instancetype)initWithWriteBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer;
+
+/**
+ Create the decompressor with options, only the block size is used
+
+ @param options The options used by the compressor, see ZXCompressorOptions, nil for the defaults
+ @param writeBuffer The output, called with every decoded block
+ @return The decompressor
+ */
+- (instancetype)initWithOptions:(ZXCompressorOptions *)options writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Push the compressed input
+
+ @param bytes The input bytes
+ @param length The input length in bytes
+ @return kZXCErrorCorrupted if the stream is invalid or continues after its end,
+ kZXCErrorChecksum if the end of the stream is read and the decompressed data does not match its checksum,
+ the error is kept for the following calls
+ */
+- (ZXCError)updateWithBytes:(const void *)bytes length:(NSUInteger)length;
+
+/**
+ Push the compressed input
+
+ @param data The input data
+ @return kZXCErrorCorrupted if the stream is invalid or continues after its end
+ */
+- (ZXCError)updateWithData:(NSData *)data;
+
+/**
+ Check the end of the input
+
+ @return kZXCErrorTruncated if the end of the stream is not read, kZXCErrorNone if succeeded
+ */
+- (ZXCError)finish;
+
+@end
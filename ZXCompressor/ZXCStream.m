@@ -0,0 +1,232 @@
+//
+// ZXCStream.m
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#import "ZXCStream.h"
+#import "ZXCompressorOptions.h"
+#import "lzh.h"
+
+// 块大小, 窗口大小和匹配深度取自 ZXCompressorOptions, 流与 kZXCAlgorithmLZH 相同, 所以 decompressData:usingAlgorithm:options:completion: 也能解压
+
+@implementation ZXCStreamCompressor {
+    lzh_encoder *_encoder;
+    void (^_writeBuffer)(const void *buffer, const unsigned int length);
+    unsigned int _blockSize;
+    // 当前块在编码器缓冲区中的位置和长度
+    unsigned char *_buffer;
+    unsigned int _pendingLength;
+    BOOL _started;
+    BOOL _finished;
+}
+
+- (instancetype)initWithWriteBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer {
+    return [self initWithOptions:nil writeBuffer:writeBuffer];
+}
+
+- (instancetype)initWithWindowSize:(unsigned int)windowSize writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer {
+    ZXCompressorOptions *options = [ZXCompressorOptions options];
+    options.windowSize = windowSize;
+    return [self initWithOptions:options writeBuffer:writeBuffer];
+}
+
+- (instancetype)initWithOptions:(ZXCompressorOptions *)options writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer {
+    self = [super init];
+    if (self) {
+        if (!options) {
+            options = [ZXCompressorOptions options];
+        }
+        unsigned int threads = options.threads > 0 ? options.threads : (unsigned int)[NSProcessInfo processInfo].activeProcessorCount;
+        _blockSize = options.blockSize;
+        _encoder = lzh_encoder_new(_blockSize, options.windowSize, options.depth, options.parse == kZXCParseLazy ? LZH_PARSE_LAZY : LZH_PARSE_GREEDY, threads);
+        _writeBuffer = [writeBuffer copy];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    lzh_encoder_free(_encoder);
+}
+
+- (void)writeBytes:(const void *)bytes length:(unsigned int)length {
+    if (_writeBuffer) {
+        _writeBuffer(bytes, length);
+    }
+}
+
+// 写入标识 + 窗口大小
+- (void)start {
+    if (!_started) {
+        _started = YES;
+        unsigned char header[LZH_HEADER_SIZE];
+        [self writeBytes:header length:lzh_encoder_header(_encoder, header)];
+    }
+}
+
+// 压缩并写入当前块
+- (void)compressPending {
+    if (_pendingLength > 0) {
+        [self start];
+        const unsigned char *output;
+        unsigned int length = lzh_encoder_compress(_encoder, _pendingLength, &output);
+        _pendingLength = 0;
+        [self writeBytes:output length:length];
+    }
+}
+
+- (void)updateWithBytes:(const void *)bytes length:(NSUInteger)length {
+    NSAssert(!_finished, @"%s the stream is finished", __func__);
+    if (_finished) {
+        return;
+    }
+    const unsigned char *input = bytes;
+    while (length > 0) {
+        // 新块开始时才移动窗口, 当前块的字节不会被移动
+        if (_pendingLength == 0) {
+            _buffer = lzh_encoder_buffer(_encoder);
+        }
+        unsigned int count = (unsigned int)MIN(length, _blockSize - _pendingLength);
+        memcpy(&_buffer[_pendingLength], input, count);
+        _pendingLength += count;
+        input += count;
+        length -= count;
+        if (_pendingLength == _blockSize) {
+            [self compressPending];
+        }
+    }
+}
+
+- (void)updateWithData:(NSData *)data {
+    [self updateWithBytes:data.bytes length:data.length];
+}
+
+- (void)flush {
+    if (!_finished) {
+        [self compressPending];
+    }
+}
+
+- (void)finish {
+    if (!_finished) {
+        [self start];
+        [self compressPending];
+        unsigned char end[LZH_END_SIZE];
+        [self writeBytes:end length:lzh_encoder_end(_encoder, end)];
+        _finished = YES;
+    }
+}
+
+@end
+
+@implementation ZXCStreamDecompressor {
+    lzh_decoder *_decoder;
+    void (^_writeBuffer)(const void *buffer, const unsigned int length);
+    // 不完整的块
+    NSMutableData *_pending;
+    ZXCError _error;
+}
+
+- (instancetype)initWithWriteBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer {
+    return [self initWithOptions:nil writeBuffer:writeBuffer];
+}
+
+- (instancetype)initWithOptions:(ZXCompressorOptions *)options writeBuffer:(void (^)(const void *buffer, const unsigned int length))writeBuffer {
+    self = [super init];
+    if (self) {
+        _decoder = lzh_decoder_new(options ? options.blockSize : [ZXCompressorOptions options].blockSize);
+        _writeBuffer = [writeBuffer copy];
+        _pending = [NSMutableData data];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    lzh_decoder_free(_decoder);
+}
+
+// 解码 input 中完整的块, 返回使用的字节数
+- (NSUInteger)decodeBytes:(const unsigned char *)input length:(NSUInteger)length {
+    NSUInteger position = 0;
+    while (_error == kZXCErrorNone && position < length) {
+        if (_finished) {
+            // 结束之后还有数据
+            _error = kZXCErrorCorrupted;
+            break;
+        }
+        unsigned int available = (unsigned int)MIN(length - position, UINT_MAX);
+        unsigned int need = lzh_decoder_need(_decoder, &input[position], available);
+        if (need == 0) {
+            _error = kZXCErrorCorrupted;
+            break;
+        }
+        if (need > available) {
+            break;
+        }
+        const unsigned char *output;
+        unsigned int outputLength;
+        lzh_status status = lzh_decoder_decode(_decoder, &input[position], need, &output, &outputLength);
+        position += need;
+        if (status == LZH_STATUS_CORRUPTED) {
+            _error = kZXCErrorCorrupted;
+        } else if (status == LZH_STATUS_CHECKSUM) {
+            // 解码的数据已经输出, 结束时才能发现不一致
+            _error = kZXCErrorChecksum;
+        } else if (status == LZH_STATUS_END) {
+            _finished = YES;
+        } else if (status == LZH_STATUS_BLOCK && _writeBuffer) {
+            _writeBuffer(output, outputLength);
+        }
+    }
+    return position;
+}
+
+- (ZXCError)updateWithBytes:(const void *)bytes length:(NSUInteger)length {
+    if (_error != kZXCErrorNone || length == 0) {
+        return _error;
+    }
+    if (_pending.length == 0) {
+        // 没有未完成的块, 直接解码输入, 只保存剩下的字节
+        NSUInteger used = [self decodeBytes:bytes length:length];
+        if (_error == kZXCErrorNone) {
+            [_pending appendBytes:(const unsigned char *)bytes + used length:length - used];
+        }
+    } else {
+        [_pending appendBytes:bytes length:length];
+        NSUInteger used = [self decodeBytes:_pending.bytes length:_pending.length];
+        [_pending replaceBytesInRange:NSMakeRange(0, used) withBytes:NULL length:0];
+    }
+    return _error;
+}
+
+- (ZXCError)updateWithData:(NSData *)data {
+    return [self updateWithBytes:data.bytes length:data.length];
+}
+
+- (ZXCError)finish {
+    if (_error == kZXCErrorNone && !_finished) {
+        _error = kZXCErrorTruncated;
+    }
+    return _error;
+}
+
+@end
@@ -39,8 +39,48 @@ typedef enum {
     kZXCAlgorithmPPM, // Prediction by partial matching
     kZXCAlgorithmRLE, // Run-length encoding
     
+    kZXCAlgorithmFSE, // Finite state entropy (tabled asymmetric numeral systems)
+    
+    kZXCAlgorithmLZH, // LZSS + Huffman/FSE (two stages, deflate-class)
+    
+    kZXCAlgorithmDefault = kZXCAlgorithmLZH, // The general-purpose mode
+    kZXCAlgorithmAuto = kZXCAlgorithmLZH, // Picks per block from a sample: LZ matches, literals alone (Huffman/FSE/run) or stored bytes
+    
 } ZXCAlgorithm;
 
+/* The block size range of kZXCAlgorithmHuffman/FSE/LZH (the block coders) and the streams, the coders reject the sizes out of it */
+#define kZXCBlockSizeMin        (1 << 10)
+#define kZXCBlockSizeMax        (1 << 26)
+
+/* ZXCError */
+typedef enum {
+    kZXCErrorNone = 0, // No error
+    kZXCErrorTruncated, // The compressed data ends in the middle of a header or phrase
+    kZXCErrorCorrupted, // The compressed data contains an out of range field
+    kZXCErrorDictionaryMismatch, // The compressed data was made with another dictionary
+    kZXCErrorChecksum, // The decompressed data does not match the checksum of the compressed data (LZH streams)
+    kZXCErrorCompressFailed, // The compressor could not encode the data (unsupported algorithm or options), nothing was decoded
+} ZXCError;
+
+/* ZXCDictionaryPolicy, what LZ78/LZW do when the code dictionary is full */
+typedef enum {
+    kZXCDictionaryPolicyReset = 0, // Clear the dictionary at once (the original format)
+    kZXCDictionaryPolicyMonitor, // Keep coding with the full dictionary, clear it only when the compression ratio drops (compress(1))
+} ZXCDictionaryPolicy;
+
+/* ZXCParse, how kZXCAlgorithmLZH picks the matches, the decompressor does not depend on it */
+typedef enum {
+    kZXCParseGreedy = 0, // The longest match at each position
+    kZXCParseLazy, // A match is deferred by a literal when the next position starts a better one, slower and smaller on most data
+} ZXCParse;
+
+/* The error domain of NSError, the code is ZXCError */
+extern NSString * const ZXCompressorErrorDomain;
+
+@class ZXCDictionary;
+@class ZXCChunkStore;
+@class ZXCompressorOptions;
+
 /**
  ZXCompressor
  */
@@ -55,6 +95,50 @@ typedef enum {
  */
 + (void)compressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm completion:(void(^)(NSData *data))completion;
 
+/**
+ Compress data using specified algorithm and pre-trained dictionary, suits small data (a few KB)
+ The dictionary id is written before the compressed data, only LZ77/LZSS/LZ78/LZW use the dictionary
+
+ @param data Uncompressed data
+ @param algorithm Compression algorithm, see ZXCAlgorithm
+ @param dictionary The pre-trained dictionary, see ZXCDictionary, nil for none
+ @param completion Callback when completed
+ */
++ (void)compressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm dictionary:(ZXCDictionary *)dictionary completion:(void(^)(NSData *data))completion;
+
+/**
+ Compress data using specified algorithm and sliding window size
+ Only kZXCAlgorithmLZH uses the window size (written to the compressed data), the other algorithms keep their fixed windows
+ A window beyond 64 KB finds the long repeats (VM images, backups) with a rolling hash, both sides hold the window in memory
+
+ @param data Uncompressed data
+ @param algorithm Compression algorithm, see ZXCAlgorithm
+ @param windowSize The sliding window size in bytes, rounded up to a power of two in [1 KB, 1 GB], 0 for the default (64 KB)
+ @param completion Callback when completed
+ */
++ (void)compressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm windowSize:(unsigned int)windowSize completion:(void(^)(NSData *data))completion;
+
+/**
+ Compress data using specified algorithm and options (level, window size, depth, block size, threads...)
+
+ @param data Uncompressed data
+ @param algorithm Compression algorithm, see ZXCAlgorithm
+ @param options The options, see ZXCompressorOptions, nil for the defaults
+ @param completion Callback when completed
+ */
++ (void)compressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm options:(ZXCompressorOptions *)options completion:(void(^)(NSData *data))completion;
+
+/**
+ Compress data using specified algorithm, pre-trained dictionary and options
+
+ @param data Uncompressed data
+ @param algorithm Compression algorithm, see ZXCAlgorithm
+ @param dictionary The pre-trained dictionary, see ZXCDictionary, nil for none
+ @param options The options, see ZXCompressorOptions, nil for the defaults
+ @param completion Callback when completed
+ */
++ (void)compressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm dictionary:(ZXCDictionary *)dictionary options:(ZXCompressorOptions *)options completion:(void(^)(NSData *data))completion;
+
 /**
  Compress file using specified algorithm
 
@@ -65,23 +149,152 @@ typedef enum {
  */
 + (void)compressFileAtPath:(NSString *)source toPath:(NSString *)target usingAlgorithm:(ZXCAlgorithm)algorithm completion:(void(^)(NSError *error))completion;
 
+/**
+ Compress file using specified algorithm and sliding window size, see compressData:usingAlgorithm:windowSize:completion:
+
+ @param source Uncompressed source file
+ @param target Compressed target file
+ @param algorithm Compression algorithm, see ZXCAlgorithm
+ @param windowSize The sliding window size in bytes, rounded up to a power of two in [1 KB, 1 GB], 0 for the default (64 KB)
+ @param completion Callback when completed
+ */
++ (void)compressFileAtPath:(NSString *)source toPath:(NSString *)target usingAlgorithm:(ZXCAlgorithm)algorithm windowSize:(unsigned int)windowSize completion:(void(^)(NSError *error))completion;
+
+/**
+ Compress file using specified algorithm and options
+
+ @param source Uncompressed source file
+ @param target Compressed target file
+ @param algorithm Compression algorithm, see ZXCAlgorithm
+ @param options The options, see ZXCompressorOptions, nil for the defaults
+ @param completion Callback when completed
+ */
++ (void)compressFileAtPath:(NSString *)source toPath:(NSString *)target usingAlgorithm:(ZXCAlgorithm)algorithm options:(ZXCompressorOptions *)options completion:(void(^)(NSError *error))completion;
+
 /**
  Decompress data using specified algorithm
 
  @param data Compressed data
  @param algorithm Compression algorithm, see ZXCAlgorithm
- @param completion Callback when completed
+ @param completion Callback when completed, data is nil if the compressed data is truncated or corrupted
  */
 + (void)decompressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm completion:(void(^)(NSData *data))completion;
 
+/**
+ Decompress data using specified algorithm and pre-trained dictionary
+
+ @param data Compressed data
+ @param algorithm Compression algorithm, see ZXCAlgorithm
+ @param dictionary The dictionary used by the compressor, nil for none
+ @param completion Callback when completed, data is nil if the compressed data is truncated, corrupted or made with another dictionary
+ */
++ (void)decompressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm dictionary:(ZXCDictionary *)dictionary completion:(void(^)(NSData *data))completion;
+
+/**
+ Decompress data using specified algorithm and options
+
+ @param data Compressed data
+ @param algorithm Compression algorithm, see ZXCAlgorithm
+ @param options The options used by the compressor (block size, LZ77/LZSS/LZ78/LZW sizes, dictionary policy), nil for the defaults
+ @param completion Callback when completed, data is nil if the compressed data is truncated or corrupted
+ */
++ (void)decompressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm options:(ZXCompressorOptions *)options completion:(void(^)(NSData *data))completion;
+
+/**
+ Decompress data using specified algorithm, pre-trained dictionary and options
+
+ @param data Compressed data
+ @param algorithm Compression algorithm, see ZXCAlgorithm
+ @param dictionary The dictionary used by the compressor, nil for none
+ @param options The options used by the compressor (block size, LZ77/LZSS/LZ78/LZW sizes, dictionary policy), nil for the defaults
+ @param completion Callback when completed, data is nil if the compressed data is truncated, corrupted or made with another dictionary
+ */
++ (void)decompressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm dictionary:(ZXCDictionary *)dictionary options:(ZXCompressorOptions *)options completion:(void(^)(NSData *data))completion;
+
 /**
  Decompress file using specified algorithm
 
  @param source Compressed source file
  @param target Decompressed target file
  @param algorithm Compression algorithm, see ZXCAlgorithm
- @param completion Callback when completed
+ @param completion Callback when completed, error domain is ZXCompressorErrorDomain if the source file is truncated or corrupted
  */
 + (void)decompressFileAtPath:(NSString *)source toPath:(NSString *)target usingAlgorithm:(ZXCAlgorithm)algorithm completion:(void(^)(NSError *error))completion;
 
+/**
+ Decompress file using specified algorithm and options
+
+ @param source Compressed source file
+ @param target Decompressed target file
+ @param algorithm Compression algorithm, see ZXCAlgorithm
+ @param options The options used by the compressor (block size, LZ77/LZSS/LZ78/LZW sizes, dictionary policy), nil for the defaults
+ @param completion Callback when completed, error domain is ZXCompressorErrorDomain if the source file is truncated or corrupted
+ */
++ (void)decompressFileAtPath:(NSString *)source toPath:(NSString *)target usingAlgorithm:(ZXCAlgorithm)algorithm options:(ZXCompressorOptions *)options completion:(void(^)(NSError *error))completion;
+
+/**
+ Compress file to a manifest of content-defined chunks (deduplication), for backups of mostly unchanged files
+ The file is split by a gear rolling hash (2 KB ~ 64 KB, 8 KB on average), only the chunks not in the store are compressed and written,
+ the manifest lists the SHA-256 digest and the size of every chunk
+
+ @param source Uncompressed source file
+ @param target The manifest file
+ @param store The chunk store, shared between the files and the runs, see ZXCChunkStore, the chunks are compressed with its algorithm and options
+ @param completion Callback when completed
+ */
++ (void)compressFileAtPath:(NSString *)source toPath:(NSString *)target chunkStore:(ZXCChunkStore *)store completion:(void(^)(NSError *error))completion;
+
+/**
+ Decompress file from a manifest of chunks
+
+ @param source The manifest file
+ @param target Decompressed target file
+ @param store The chunk store holding the chunks of the manifest
+ @param completion Callback when completed, error domain is ZXCompressorErrorDomain if the manifest or a chunk is truncated or corrupted
+ */
++ (void)decompressFileAtPath:(NSString *)source toPath:(NSString *)target chunkStore:(ZXCChunkStore *)store completion:(void(^)(NSError *error))completion;
+
+/**
+ Compress file to a seekable container: the file is cut into blocks compressed independently, followed by an index of
+ (uncompressed offset, compressed offset) per block, so any byte range can be read back without decoding the whole file
+
+ @param source Uncompressed source file
+ @param target The seekable file
+ @param algorithm Algorithm used for every block
+ @param blockSize Uncompressed size of a block, 0 for the default (1 MB); smaller blocks give cheaper random reads and a lower ratio
+ @param completion Callback when completed, kZXCErrorCompressFailed in ZXCompressorErrorDomain if a block could not be compressed, or the write error; no file is left on error
+ */
++ (void)compressSeekableFileAtPath:(NSString *)source toPath:(NSString *)target usingAlgorithm:(ZXCAlgorithm)algorithm blockSize:(unsigned int)blockSize completion:(void(^)(NSError *error))completion;
+
+/**
+ Compress file to a seekable container using specified options, see compressSeekableFileAtPath:toPath:usingAlgorithm:blockSize:completion:
+
+ @param source Uncompressed source file
+ @param target The seekable file
+ @param algorithm Algorithm used for every block
+ @param blockSize Uncompressed size of a block, 0 for the default (1 MB)
+ @param options The options of every block, see ZXCompressorOptions, nil for the defaults
+ @param completion Callback when completed, kZXCErrorCompressFailed in ZXCompressorErrorDomain if a block could not be compressed, or the write error; no file is left on error
+ */
++ (void)compressSeekableFileAtPath:(NSString *)source toPath:(NSString *)target usingAlgorithm:(ZXCAlgorithm)algorithm blockSize:(unsigned int)blockSize options:(ZXCompressorOptions *)options completion:(void(^)(NSError *error))completion;
+
+/**
+ Decompress a byte range of a seekable file, only the blocks covering the range are decoded (in parallel)
+
+ @param range Range in the uncompressed data, clipped to the uncompressed size
+ @param source The seekable file
+ @param completion Callback when completed, error domain is ZXCompressorErrorDomain if the index or a block is truncated or corrupted
+ */
++ (void)decompressRange:(NSRange)range ofSeekableFileAtPath:(NSString *)source completion:(void(^)(NSData *data, NSError *error))completion;
+
+/**
+ Decompress a byte range of a seekable file made with options
+
+ @param range Range in the uncompressed data, clipped to the uncompressed size
+ @param source The seekable file
+ @param options The options used by the compressor (block size, LZ77/LZSS/LZ78/LZW sizes, dictionary policy), nil for the defaults
+ @param completion Callback when completed, error domain is ZXCompressorErrorDomain if the index or a block is truncated or corrupted
+ */
++ (void)decompressRange:(NSRange)range ofSeekableFileAtPath:(NSString *)source options:(ZXCompressorOptions *)options completion:(void(^)(NSData *data, NSError *error))completion;
+
 @end
@@ -23,36 +23,140 @@
 //
 
 #import "ZXCompressor.h"
+#import <CommonCrypto/CommonDigest.h>
+#import "ZXCDictionary.h"
+#import "ZXCChunkStore.h"
+#import "ZXCompressorOptions.h"
 #import "ZXCompressor+LZ77.h"
 #import "ZXCompressor+LZSS.h"
 #import "ZXCompressor+LZ78.h"
 #import "ZXCompressor+LZW.h"
 #import "ZXCompressor+Huffman.h"
+#import "ZXCompressor+FSE.h"
+#import "ZXCompressor+LZH.h"
+#import "chunker.h"
+
+NSString * const ZXCompressorErrorDomain = @"ZXCompressorErrorDomain";
 
 @implementation ZXCompressor
 
-#define LZ77_WINDOW_SIZE        256
-#define LZ77_BUFFER_SIZE        256
-#define LZSS_WINDOW_SIZE        4096
-#define LZSS_BUFFER_SIZE        256
-#define LZ78_DICT_SIZE          65536
-#define LZW_DICT_SIZE           65536
-#define HUFFMAN_BUFFER_SIZE     4096
+#define FSE_TABLE_LOG           11
+// LZ77/LZSS 的滑动窗口和前向缓冲区, LZ78/LZW 的词典大小, Huffman/FSE/LZH 的块大小, LZH 的窗口大小, 匹配深度, 解析方式和线程数见 ZXCompressorOptions
+// 前向缓冲区不大于滑动窗口, 一次移动的字节数不超出窗口
+
+// 分块清单(manifest): 标识 + 分块数(4 字节) + 原始长度(8 字节), 每个分块: SHA-256 + 长度(4 字节), 网络字节序
+static const char kManifestMagic[4] = {'Z', 'X', 'C', 'M'};
+#define MANIFEST_HEADER_SIZE    16
+#define MANIFEST_ENTRY_SIZE     36
+
+// 可随机访问(seekable)的文件: 标识 + 算法(1 字节), 独立压缩的块, 块索引, 尾部
+// 块索引: 每个块的原始偏移(8 字节) + 压缩后的偏移(8 字节), 尾部: 原始长度(8 字节) + 块数(4 字节) + 标识, 网络字节序
+static const char kSeekableMagic[4] = {'Z', 'X', 'C', 'S'};
+#define SEEKABLE_HEADER_SIZE    5
+#define SEEKABLE_ENTRY_SIZE     16
+#define SEEKABLE_FOOTER_SIZE    16
+#define SEEKABLE_BLOCK_SIZE     (1 << 20)
+
++ (NSError *)errorWithCode:(ZXCError)code {
+    NSString *description = nil;
+    switch (code) {
+        case kZXCErrorTruncated:
+            description = @"The compressed data is truncated";
+            break;
+        case kZXCErrorCorrupted:
+            description = @"The compressed data is corrupted";
+            break;
+        case kZXCErrorDictionaryMismatch:
+            description = @"The compressed data needs another dictionary";
+            break;
+        case kZXCErrorChecksum:
+            description = @"The decompressed data does not match the checksum";
+            break;
+        case kZXCErrorCompressFailed:
+            description = @"The data could not be compressed";
+            break;
+        default:
+            break;
+    }
+    return [NSError errorWithDomain:ZXCompressorErrorDomain code:code userInfo:description ? @{NSLocalizedDescriptionKey: description} : nil];
+}
+
+// 写入数据, NSFileHandle 写入失败时抛出异常, 转为 NSError
++ (BOOL)writeData:(NSData *)data toFileHandle:(NSFileHandle *)handle path:(NSString *)path error:(NSError **)error {
+    @try {
+        [handle writeData:data];
+    } @catch (NSException *exception) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:@{NSFilePathErrorKey: path, NSLocalizedFailureReasonErrorKey: exception.reason ?: exception.name}];
+        }
+        return NO;
+    }
+    return YES;
+}
+
+// 默认选项 + 窗口大小, 0 为默认窗口
++ (ZXCompressorOptions *)optionsWithWindowSize:(unsigned int)windowSize {
+    ZXCompressorOptions *options = [ZXCompressorOptions options];
+    if (windowSize > 0) {
+        options.windowSize = windowSize;
+    }
+    return options;
+}
+
++ (BOOL)algorithmSupportsDictionary:(ZXCAlgorithm)algorithm {
+    switch (algorithm) {
+        case kZXCAlgorithmLZ77:
+        case kZXCAlgorithmLZSS:
+        case kZXCAlgorithmLZ78:
+        case kZXCAlgorithmLZW:
+            return YES;
+        default:
+            return NO;
+    }
+}
 
 + (void)compressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm completion:(void(^)(NSData *data))completion {
+    [self compressData:data usingAlgorithm:algorithm dictionary:nil completion:completion];
+}
+
++ (void)compressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm dictionary:(ZXCDictionary *)dictionary completion:(void(^)(NSData *data))completion {
+    [self compressData:data usingAlgorithm:algorithm dictionary:dictionary options:nil completion:completion];
+}
+
++ (void)compressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm windowSize:(unsigned int)windowSize completion:(void(^)(NSData *data))completion {
+    [self compressData:data usingAlgorithm:algorithm dictionary:nil options:[self optionsWithWindowSize:windowSize] completion:completion];
+}
+
++ (void)compressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm options:(ZXCompressorOptions *)options completion:(void(^)(NSData *data))completion {
+    [self compressData:data usingAlgorithm:algorithm dictionary:nil options:options completion:completion];
+}
+
++ (void)compressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm dictionary:(ZXCDictionary *)dictionary options:(ZXCompressorOptions *)options completion:(void(^)(NSData *data))completion {
+    // 选项, nil 为默认值
+    if (!options) {
+        options = [ZXCompressorOptions options];
+    }
     // 输入数据
     const unsigned char *input = data.bytes;
-    unsigned int inputSize = (unsigned int)data.length;
+    unsigned long long inputSize = data.length;
     // 输出数据
     NSMutableData *output = [[NSMutableData alloc] init];
+    // 预置字典, 输出字典 ID(网络字节序)
+    if (![self algorithmSupportsDictionary:algorithm]) {
+        dictionary = nil;
+    } else if (dictionary) {
+        unsigned int identifier = NSSwapHostIntToBig(dictionary.identifier);
+        [output appendBytes:&identifier length:sizeof(identifier)];
+    }
     // 按不同算法处理数据
     switch (algorithm) {
         case kZXCAlgorithmLZ77:
         {
-            [ZXCompressor compressUsingLZ77:LZ77_WINDOW_SIZE
-                                 bufferSize:LZ77_BUFFER_SIZE
-                                 readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                                     unsigned int bufSize = MIN(length, inputSize - offset);
+            [ZXCompressor compressUsingLZ77:options.lz77WindowSize
+                                 bufferSize:MIN(options.lz77BufferSize, options.lz77WindowSize)
+                                 dictionary:dictionary
+                                 readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                                     unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                                      if (bufSize > 0) {
                                          memcpy(&buffer[0], &input[offset], bufSize);
                                      }
@@ -61,7 +165,7 @@
                                      [output appendBytes:buffer length:length];
                                  } completion:^{
 #ifdef DEBUG
-                                     NSLog(@"[LZ77] input: %d bytes, output: %d bytes, compression ratio %.f%%, saving %d bytes", (int)inputSize, (int)output.length, (output.length / (double)inputSize) * 100, (int)(inputSize - output.length));
+                                     NSLog(@"[LZ77] input: %llu bytes, output: %llu bytes, compression ratio %.f%%, saving %lld bytes", inputSize, (unsigned long long)output.length, (output.length / (double)inputSize) * 100, (long long)(inputSize - output.length));
 #endif
                                      if (completion) {
                                          completion([output copy]);
@@ -71,10 +175,11 @@
         }
         case kZXCAlgorithmLZSS:
         {
-            [ZXCompressor compressUsingLZSS:LZSS_WINDOW_SIZE
-                                 bufferSize:LZSS_BUFFER_SIZE
-                                 readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                                     unsigned int bufSize = MIN(length, inputSize - offset);
+            [ZXCompressor compressUsingLZSS:options.lzssWindowSize
+                                 bufferSize:MIN(options.lzssBufferSize, options.lzssWindowSize)
+                                 dictionary:dictionary
+                                 readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                                     unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                                      if (bufSize > 0) {
                                          memcpy(&buffer[0], &input[offset], bufSize);
                                      }
@@ -83,7 +188,7 @@
                                      [output appendBytes:buffer length:length];
                                  } completion:^{
 #ifdef DEBUG
-                                     NSLog(@"[LZSS] input: %d bytes, output: %d bytes, compression ratio %.f%%, saving %d bytes", (int)inputSize, (int)output.length, (output.length / (double)inputSize) * 100, (int)(inputSize - output.length));
+                                     NSLog(@"[LZSS] input: %llu bytes, output: %llu bytes, compression ratio %.f%%, saving %lld bytes", inputSize, (unsigned long long)output.length, (output.length / (double)inputSize) * 100, (long long)(inputSize - output.length));
 #endif
                                      if (completion) {
                                          completion([output copy]);
@@ -93,9 +198,11 @@
         }
         case kZXCAlgorithmLZ78:
         {
-            [ZXCompressor compressUsingLZ78:LZ78_DICT_SIZE
-                                 readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                                     unsigned int bufSize = MIN(length, inputSize - offset);
+            [ZXCompressor compressUsingLZ78:options.dictionarySize
+                                 dictionary:dictionary
+                                     policy:options.dictionaryPolicy
+                                 readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                                     unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                                      if (bufSize > 0) {
                                          memcpy(&buffer[0], &input[offset], bufSize);
                                      }
@@ -104,7 +211,7 @@
                                      [output appendBytes:buffer length:length];
                                  } completion:^{
 #ifdef DEBUG
-                                     NSLog(@"[LZ78] input: %d bytes, output: %d bytes, compression ratio %.f%%, saving %d bytes", (int)inputSize, (int)output.length, (output.length / (double)inputSize) * 100, (int)(inputSize - output.length));
+                                     NSLog(@"[LZ78] input: %llu bytes, output: %llu bytes, compression ratio %.f%%, saving %lld bytes", inputSize, (unsigned long long)output.length, (output.length / (double)inputSize) * 100, (long long)(inputSize - output.length));
 #endif
                                      if (completion) {
                                          completion([output copy]);
@@ -114,9 +221,11 @@
         }
         case kZXCAlgorithmLZW:
         {
-            [ZXCompressor compressUsingLZW:LZW_DICT_SIZE
-                                readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                                    unsigned int bufSize = MIN(length, inputSize - offset);
+            [ZXCompressor compressUsingLZW:options.dictionarySize
+                                dictionary:dictionary
+                                    policy:options.dictionaryPolicy
+                                readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                                    unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                                     if (bufSize > 0) {
                                         memcpy(&buffer[0], &input[offset], bufSize);
                                     }
@@ -125,7 +234,7 @@
                                     [output appendBytes:buffer length:length];
                                 } completion:^{
 #ifdef DEBUG
-                                    NSLog(@"[LZW] input: %d bytes, output: %d bytes, compression ratio %.f%%, saving %d bytes", (int)inputSize, (int)output.length, (output.length / (double)inputSize) * 100, (int)(inputSize - output.length));
+                                    NSLog(@"[LZW] input: %llu bytes, output: %llu bytes, compression ratio %.f%%, saving %lld bytes", inputSize, (unsigned long long)output.length, (output.length / (double)inputSize) * 100, (long long)(inputSize - output.length));
 #endif
                                     if (completion) {
                                         completion([output copy]);
@@ -135,24 +244,72 @@
         }
         case kZXCAlgorithmHuffman:
         {
-            [ZXCompressor compressUsingHuffman:HUFFMAN_BUFFER_SIZE
-                                     inputSize:inputSize
-                                    readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                                        unsigned int bufSize = MIN(length, inputSize - offset);
-                                        if (bufSize > 0) {
-                                            memcpy(&buffer[0], &input[offset], bufSize);
-                                        }
-                                        return bufSize;
-                                    } writeBuffer:^(const void *buffer, const unsigned int length) {
-                                        [output appendBytes:buffer length:length];
-                                    } completion:^{
-#ifdef DEBUG
-                                        NSLog(@"[Huffman] input: %d bytes, output: %d bytes, compression ratio %.f%%, saving %d bytes", (int)inputSize, (int)output.length, (output.length / (double)inputSize) * 100, (int)(inputSize - output.length));
-#endif
-                                        if (completion) {
-                                            completion([output copy]);
-                                        }
-                                    }];
+            [ZXCompressor compressUsingHuffmanBlock:options.blockSize
+                                         reuseTable:YES
+                                            streams:4
+                                         readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                                             unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
+                                             if (bufSize > 0) {
+                                                 memcpy(&buffer[0], &input[offset], bufSize);
+                                             }
+                                             return bufSize;
+                                         } writeBuffer:^(const void *buffer, const unsigned int length) {
+                                             [output appendBytes:buffer length:length];
+                                         } completion:^{
+#ifdef DEBUG
+                                             NSLog(@"[Huffman] input: %llu bytes, output: %llu bytes, compression ratio %.f%%, saving %lld bytes", inputSize, (unsigned long long)output.length, (output.length / (double)inputSize) * 100, (long long)(inputSize - output.length));
+#endif
+                                             if (completion) {
+                                                 completion([output copy]);
+                                             }
+                                         }];
+            break;
+        }
+        case kZXCAlgorithmFSE:
+        {
+            [ZXCompressor compressUsingFSE:options.blockSize
+                                  tableLog:FSE_TABLE_LOG
+                                readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                                    unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
+                                    if (bufSize > 0) {
+                                        memcpy(&buffer[0], &input[offset], bufSize);
+                                    }
+                                    return bufSize;
+                                } writeBuffer:^(const void *buffer, const unsigned int length) {
+                                    [output appendBytes:buffer length:length];
+                                } completion:^{
+#ifdef DEBUG
+                                    NSLog(@"[FSE] input: %llu bytes, output: %llu bytes, compression ratio %.f%%, saving %lld bytes", inputSize, (unsigned long long)output.length, (output.length / (double)inputSize) * 100, (long long)(inputSize - output.length));
+#endif
+                                    if (completion) {
+                                        completion([output copy]);
+                                    }
+                                }];
+            break;
+        }
+        case kZXCAlgorithmLZH:
+        {
+            [ZXCompressor compressUsingLZH:options.blockSize
+                                windowSize:options.windowSize
+                                     depth:options.depth
+                                     parse:options.parse
+                                   threads:options.threads
+                                readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                                    unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
+                                    if (bufSize > 0) {
+                                        memcpy(&buffer[0], &input[offset], bufSize);
+                                    }
+                                    return bufSize;
+                                } writeBuffer:^(const void *buffer, const unsigned int length) {
+                                    [output appendBytes:buffer length:length];
+                                } completion:^{
+#ifdef DEBUG
+                                    NSLog(@"[LZH] input: %llu bytes, output: %llu bytes, compression ratio %.f%%, saving %lld bytes", inputSize, (unsigned long long)output.length, (output.length / (double)inputSize) * 100, (long long)(inputSize - output.length));
+#endif
+                                    if (completion) {
+                                        completion([output copy]);
+                                    }
+                                }];
             break;
         }
         default:
@@ -162,11 +319,23 @@
 }
 
 + (void)compressFileAtPath:(NSString *)source toPath:(NSString *)target usingAlgorithm:(ZXCAlgorithm)algorithm completion:(void(^)(NSError *error))completion {
+    [self compressFileAtPath:source toPath:target usingAlgorithm:algorithm options:nil completion:completion];
+}
+
++ (void)compressFileAtPath:(NSString *)source toPath:(NSString *)target usingAlgorithm:(ZXCAlgorithm)algorithm windowSize:(unsigned int)windowSize completion:(void(^)(NSError *error))completion {
+    [self compressFileAtPath:source toPath:target usingAlgorithm:algorithm options:[self optionsWithWindowSize:windowSize] completion:completion];
+}
+
++ (void)compressFileAtPath:(NSString *)source toPath:(NSString *)target usingAlgorithm:(ZXCAlgorithm)algorithm options:(ZXCompressorOptions *)options completion:(void(^)(NSError *error))completion {
+    // 选项, nil 为默认值
+    if (!options) {
+        options = [ZXCompressorOptions options];
+    }
     // 错误信息
     NSError *error = nil;
     // 输入文件
     NSFileHandle *input = [NSFileHandle fileHandleForReadingFromURL:[NSURL fileURLWithPath:source] error:&error];
-    unsigned int inputSize = (unsigned int)[input seekToEndOfFile];
+    unsigned long long inputSize = [input seekToEndOfFile];
     if (error) {
         if (completion) {
             completion(error);
@@ -194,10 +363,11 @@
     switch (algorithm) {
         case kZXCAlgorithmLZ77:
         {
-            [self compressUsingLZ77:LZ77_WINDOW_SIZE
-                         bufferSize:LZ77_BUFFER_SIZE
-                         readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                             unsigned int bufSize = MIN(length, inputSize - offset);
+            [self compressUsingLZ77:options.lz77WindowSize
+                         bufferSize:MIN(options.lz77BufferSize, options.lz77WindowSize)
+                         dictionary:nil
+                         readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                             unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                              if (bufSize > 0) {
                                  [input seekToFileOffset:offset];
                                  NSData *data = [input readDataOfLength:bufSize];
@@ -208,8 +378,8 @@
                              [output writeData:[NSData dataWithBytes:buffer length:length]];
                          } completion:^{
 #ifdef DEBUG
-                             unsigned int outputSize = (unsigned int)[output seekToEndOfFile];
-                             NSLog(@"[LZ77] input: %d bytes, output: %d bytes, compression ratio %.f%%, saving %d bytes", (int)inputSize, (int)outputSize, (outputSize / (double)inputSize) * 100, (int)(inputSize - outputSize));
+                             unsigned long long outputSize = [output seekToEndOfFile];
+                             NSLog(@"[LZ77] input: %llu bytes, output: %llu bytes, compression ratio %.f%%, saving %lld bytes", inputSize, outputSize, (outputSize / (double)inputSize) * 100, (long long)(inputSize - outputSize));
 #endif
                              [input closeFile];
                              [output closeFile];
@@ -222,10 +392,11 @@
         }
         case kZXCAlgorithmLZSS:
         {
-            [self compressUsingLZSS:LZ77_WINDOW_SIZE
-                         bufferSize:LZ77_BUFFER_SIZE
-                         readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                             unsigned int bufSize = MIN(length, inputSize - offset);
+            [self compressUsingLZSS:options.lzssWindowSize
+                         bufferSize:MIN(options.lzssBufferSize, options.lzssWindowSize)
+                         dictionary:nil
+                         readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                             unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                              if (bufSize > 0) {
                                  [input seekToFileOffset:offset];
                                  NSData *data = [input readDataOfLength:bufSize];
@@ -236,8 +407,8 @@
                              [output writeData:[NSData dataWithBytes:buffer length:length]];
                          } completion:^{
 #ifdef DEBUG
-                             unsigned int outputSize = (unsigned int)[output seekToEndOfFile];
-                             NSLog(@"[LZSS] input: %d bytes, output: %d bytes, compression ratio %.f%%, saving %d bytes", (int)inputSize, (int)outputSize, (outputSize / (double)inputSize) * 100, (int)(inputSize - outputSize));
+                             unsigned long long outputSize = [output seekToEndOfFile];
+                             NSLog(@"[LZSS] input: %llu bytes, output: %llu bytes, compression ratio %.f%%, saving %lld bytes", inputSize, outputSize, (outputSize / (double)inputSize) * 100, (long long)(inputSize - outputSize));
 #endif
                              [input closeFile];
                              [output closeFile];
@@ -250,9 +421,11 @@
         }
         case kZXCAlgorithmLZ78:
         {
-            [self compressUsingLZ78:LZ78_DICT_SIZE
-                         readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                             unsigned int bufSize = MIN(length, inputSize - offset);
+            [self compressUsingLZ78:options.dictionarySize
+                         dictionary:nil
+                             policy:options.dictionaryPolicy
+                         readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                             unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                              if (bufSize > 0) {
                                  [input seekToFileOffset:offset];
                                  NSData *data = [input readDataOfLength:bufSize];
@@ -263,8 +436,8 @@
                              [output writeData:[NSData dataWithBytes:buffer length:length]];
                          } completion:^{
 #ifdef DEBUG
-                             unsigned int outputSize = (unsigned int)[output seekToEndOfFile];
-                             NSLog(@"[LZ78] input: %d bytes, output: %d bytes, compression ratio %.f%%, saving %d bytes", (int)inputSize, (int)outputSize, (outputSize / (double)inputSize) * 100, (int)(inputSize - outputSize));
+                             unsigned long long outputSize = [output seekToEndOfFile];
+                             NSLog(@"[LZ78] input: %llu bytes, output: %llu bytes, compression ratio %.f%%, saving %lld bytes", inputSize, outputSize, (outputSize / (double)inputSize) * 100, (long long)(inputSize - outputSize));
 #endif
                              [input closeFile];
                              [output closeFile];
@@ -277,9 +450,11 @@
         }
         case kZXCAlgorithmLZW:
         {
-            [self compressUsingLZW:LZW_DICT_SIZE
-                        readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                            unsigned int bufSize = MIN(length, inputSize - offset);
+            [self compressUsingLZW:options.dictionarySize
+                        dictionary:nil
+                            policy:options.dictionaryPolicy
+                        readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                            unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                             if (bufSize > 0) {
                                 [input seekToFileOffset:offset];
                                 NSData *data = [input readDataOfLength:bufSize];
@@ -290,8 +465,8 @@
                             [output writeData:[NSData dataWithBytes:buffer length:length]];
                         } completion:^{
 #ifdef DEBUG
-                            unsigned int outputSize = (unsigned int)[output seekToEndOfFile];
-                            NSLog(@"[LZW] input: %d bytes, output: %d bytes, compression ratio %.f%%, saving %d bytes", (int)inputSize, (int)outputSize, (outputSize / (double)inputSize) * 100, (int)(inputSize - outputSize));
+                            unsigned long long outputSize = [output seekToEndOfFile];
+                            NSLog(@"[LZW] input: %llu bytes, output: %llu bytes, compression ratio %.f%%, saving %lld bytes", inputSize, outputSize, (outputSize / (double)inputSize) * 100, (long long)(inputSize - outputSize));
 #endif
                             [input closeFile];
                             [output closeFile];
@@ -304,30 +479,90 @@
         }
         case kZXCAlgorithmHuffman:
         {
-            [self compressUsingHuffman:HUFFMAN_BUFFER_SIZE
-                             inputSize:inputSize
-                            readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                                unsigned int bufSize = MIN(length, inputSize - offset);
-                                if (bufSize > 0) {
-                                    [input seekToFileOffset:offset];
-                                    NSData *data = [input readDataOfLength:bufSize];
-                                    memcpy(buffer, data.bytes, bufSize);
-                                }
-                                return bufSize;
-                            } writeBuffer:^(const void *buffer, const unsigned int length) {
-                                [output writeData:[NSData dataWithBytes:buffer length:length]];
-                            } completion:^{
-#ifdef DEBUG
-                                unsigned int outputSize = (unsigned int)[output seekToEndOfFile];
-                                NSLog(@"[Huffman] input: %d bytes, output: %d bytes, compression ratio %.f%%, saving %d bytes", (int)inputSize, (int)outputSize, (outputSize / (double)inputSize) * 100, (int)(inputSize - outputSize));
-#endif
-                                [input closeFile];
-                                [output closeFile];
-                                //
-                                if (completion) {
-                                    completion(nil);
-                                }
-                            }];
+            [self compressUsingHuffmanBlock:options.blockSize
+                                 reuseTable:YES
+                                    streams:4
+                                 readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                                     unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
+                                     if (bufSize > 0) {
+                                         [input seekToFileOffset:offset];
+                                         NSData *data = [input readDataOfLength:bufSize];
+                                         memcpy(buffer, data.bytes, bufSize);
+                                     }
+                                     return bufSize;
+                                 } writeBuffer:^(const void *buffer, const unsigned int length) {
+                                     [output writeData:[NSData dataWithBytes:buffer length:length]];
+                                 } completion:^{
+#ifdef DEBUG
+                                     unsigned long long outputSize = [output seekToEndOfFile];
+                                     NSLog(@"[Huffman] input: %llu bytes, output: %llu bytes, compression ratio %.f%%, saving %lld bytes", inputSize, outputSize, (outputSize / (double)inputSize) * 100, (long long)(inputSize - outputSize));
+#endif
+                                     [input closeFile];
+                                     [output closeFile];
+                                     //
+                                     if (completion) {
+                                         completion(nil);
+                                     }
+                                 }];
+            break;
+        }
+        case kZXCAlgorithmFSE:
+        {
+            [self compressUsingFSE:options.blockSize
+                          tableLog:FSE_TABLE_LOG
+                        readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                            unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
+                            if (bufSize > 0) {
+                                [input seekToFileOffset:offset];
+                                NSData *data = [input readDataOfLength:bufSize];
+                                memcpy(buffer, data.bytes, bufSize);
+                            }
+                            return bufSize;
+                        } writeBuffer:^(const void *buffer, const unsigned int length) {
+                            [output writeData:[NSData dataWithBytes:buffer length:length]];
+                        } completion:^{
+#ifdef DEBUG
+                            unsigned long long outputSize = [output seekToEndOfFile];
+                            NSLog(@"[FSE] input: %llu bytes, output: %llu bytes, compression ratio %.f%%, saving %lld bytes", inputSize, outputSize, (outputSize / (double)inputSize) * 100, (long long)(inputSize - outputSize));
+#endif
+                            [input closeFile];
+                            [output closeFile];
+                            //
+                            if (completion) {
+                                completion(nil);
+                            }
+                        }];
+            break;
+        }
+        case kZXCAlgorithmLZH:
+        {
+            [self compressUsingLZH:options.blockSize
+                        windowSize:options.windowSize
+                             depth:options.depth
+                             parse:options.parse
+                           threads:options.threads
+                        readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                            unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
+                            if (bufSize > 0) {
+                                [input seekToFileOffset:offset];
+                                NSData *data = [input readDataOfLength:bufSize];
+                                memcpy(buffer, data.bytes, bufSize);
+                            }
+                            return bufSize;
+                        } writeBuffer:^(const void *buffer, const unsigned int length) {
+                            [output writeData:[NSData dataWithBytes:buffer length:length]];
+                        } completion:^{
+#ifdef DEBUG
+                            unsigned long long outputSize = [output seekToEndOfFile];
+                            NSLog(@"[LZH] input: %llu bytes, output: %llu bytes, compression ratio %.f%%, saving %lld bytes", inputSize, outputSize, (outputSize / (double)inputSize) * 100, (long long)(inputSize - outputSize));
+#endif
+                            [input closeFile];
+                            [output closeFile];
+                            //
+                            if (completion) {
+                                completion(nil);
+                            }
+                        }];
             break;
         }
         default:
@@ -337,118 +572,202 @@
 }
 
 + (void)decompressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm completion:(void(^)(NSData *data))completion {
+    [self decompressData:data usingAlgorithm:algorithm dictionary:nil completion:completion];
+}
+
++ (void)decompressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm dictionary:(ZXCDictionary *)dictionary completion:(void(^)(NSData *data))completion {
+    [self decompressData:data usingAlgorithm:algorithm dictionary:dictionary options:nil completion:completion];
+}
+
++ (void)decompressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm options:(ZXCompressorOptions *)options completion:(void(^)(NSData *data))completion {
+    [self decompressData:data usingAlgorithm:algorithm dictionary:nil options:options completion:completion];
+}
+
++ (void)decompressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm dictionary:(ZXCDictionary *)dictionary options:(ZXCompressorOptions *)options completion:(void(^)(NSData *data))completion {
+    // 选项, nil 为默认值
+    if (!options) {
+        options = [ZXCompressorOptions options];
+    }
     // 输入数据
     const unsigned char *input = data.bytes;
-    unsigned int inputSize = (unsigned int)data.length;
+    unsigned long long inputSize = data.length;
+    // 预置字典, 校验字典 ID(网络字节序)
+    if (![self algorithmSupportsDictionary:algorithm]) {
+        dictionary = nil;
+    } else if (dictionary) {
+        unsigned int identifier = 0;
+        if (inputSize >= sizeof(identifier)) {
+            memcpy(&identifier, input, sizeof(identifier));
+        }
+        if (inputSize < sizeof(identifier) || NSSwapBigIntToHost(identifier) != dictionary.identifier) {
+#ifdef DEBUG
+            NSLog(@"%s %@", __func__, [self errorWithCode:inputSize < sizeof(identifier) ? kZXCErrorTruncated : kZXCErrorDictionaryMismatch]);
+#endif
+            if (completion) {
+                completion(nil);
+            }
+            return;
+        }
+        input += sizeof(identifier);
+        inputSize -= sizeof(identifier);
+    }
     // 输出数据
     NSMutableData *output = [[NSMutableData alloc] init];
     // 开始处理数据
     switch (algorithm) {
         case kZXCAlgorithmLZ77:
         {
-            [self decompressUsingLZ77:LZ77_WINDOW_SIZE
-                           bufferSize:LZ77_BUFFER_SIZE
-                           readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                               unsigned int bufSize = MIN(length, inputSize - offset);
+            [self decompressUsingLZ77:options.lz77WindowSize
+                           bufferSize:MIN(options.lz77BufferSize, options.lz77WindowSize)
+                           dictionary:dictionary
+                           readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                               unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                                if (bufSize > 0) {
                                    memcpy(&buffer[0], &input[offset], bufSize);
                                }
                                return bufSize;
                            } writeBuffer:^(const void *buffer, const unsigned int length) {
                                [output appendBytes:buffer length:length];
-                           } completion:^{
+                           } completion:^(ZXCError errorCode) {
 #ifdef DEBUG
-                               NSLog(@"[LZ77] input: %d bytes, output: %d bytes", (int)inputSize, (int)output.length);
+                               NSLog(@"[LZ77] input: %llu bytes, output: %llu bytes", inputSize, (unsigned long long)output.length);
 #endif
                                if (completion) {
-                                   completion([output copy]);
+                                   completion(errorCode == kZXCErrorNone ? [output copy] : nil);
                                }
                            }];
             break;
         }
         case kZXCAlgorithmLZSS:
         {
-            [self decompressUsingLZSS:LZ77_WINDOW_SIZE
-                           bufferSize:LZ77_BUFFER_SIZE
-                           readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                               unsigned int bufSize = MIN(length, inputSize - offset);
+            [self decompressUsingLZSS:options.lzssWindowSize
+                           bufferSize:MIN(options.lzssBufferSize, options.lzssWindowSize)
+                           dictionary:dictionary
+                           readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                               unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                                if (bufSize > 0) {
                                    memcpy(&buffer[0], &input[offset], bufSize);
                                }
                                return bufSize;
                            } writeBuffer:^(const void *buffer, const unsigned int length) {
                                [output appendBytes:buffer length:length];
-                           } completion:^{
+                           } completion:^(ZXCError errorCode) {
 #ifdef DEBUG
-                               NSLog(@"[LZSS] input: %d bytes, output: %d bytes", (int)inputSize, (int)output.length);
+                               NSLog(@"[LZSS] input: %llu bytes, output: %llu bytes", inputSize, (unsigned long long)output.length);
 #endif
                                if (completion) {
-                                   completion([output copy]);
+                                   completion(errorCode == kZXCErrorNone ? [output copy] : nil);
                                }
                            }];
             break;
         }
         case kZXCAlgorithmLZ78:
         {
-            [self decompressUsingLZ78:LZ78_DICT_SIZE
-                           readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                               unsigned int bufSize = MIN(length, inputSize - offset);
+            [self decompressUsingLZ78:options.dictionarySize
+                           dictionary:dictionary
+                               policy:options.dictionaryPolicy
+                           readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                               unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                                if (bufSize > 0) {
                                    memcpy(&buffer[0], &input[offset], bufSize);
                                }
                                return bufSize;
                            } writeBuffer:^(const void *buffer, const unsigned int length) {
                                [output appendBytes:buffer length:length];
-                           } completion:^{
+                           } completion:^(ZXCError errorCode) {
 #ifdef DEBUG
-                               NSLog(@"[LZ78] input: %d bytes, output: %d bytes", (int)inputSize, (int)output.length);
+                               NSLog(@"[LZ78] input: %llu bytes, output: %llu bytes", inputSize, (unsigned long long)output.length);
 #endif
                                if (completion) {
-                                   completion([output copy]);
+                                   completion(errorCode == kZXCErrorNone ? [output copy] : nil);
                                }
                            }];
             break;
         }
         case kZXCAlgorithmLZW:
         {
-            [self decompressUsingLZW:LZW_DICT_SIZE
-                          readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                              unsigned int bufSize = MIN(length, inputSize - offset);
+            [self decompressUsingLZW:options.dictionarySize
+                          dictionary:dictionary
+                              policy:options.dictionaryPolicy
+                          readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                              unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                               if (bufSize > 0) {
                                   memcpy(&buffer[0], &input[offset], bufSize);
                               }
                               return bufSize;
                           } writeBuffer:^(const void *buffer, const unsigned int length) {
                               [output appendBytes:buffer length:length];
-                          } completion:^{
+                          } completion:^(ZXCError errorCode) {
 #ifdef DEBUG
-                              NSLog(@"[LZW] input: %d bytes, output: %d bytes", (int)inputSize, (int)output.length);
+                              NSLog(@"[LZW] input: %llu bytes, output: %llu bytes", inputSize, (unsigned long long)output.length);
 #endif
                               if (completion) {
-                                  completion([output copy]);
+                                  completion(errorCode == kZXCErrorNone ? [output copy] : nil);
                               }
                           }];
             break;
         }
         case kZXCAlgorithmHuffman:
         {
-            [self decompressUsingHuffman:HUFFMAN_BUFFER_SIZE
-                              readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                                  unsigned int bufSize = MIN(length, inputSize - offset);
-                                  if (bufSize > 0) {
-                                      memcpy(&buffer[0], &input[offset], bufSize);
-                                  }
-                                  return bufSize;
-                              } writeBuffer:^(const void *buffer, const unsigned int length) {
-                                  [output appendBytes:buffer length:length];
-                              } completion:^{
+            [self decompressUsingHuffmanBlock:options.blockSize
+                                   readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                                       unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
+                                       if (bufSize > 0) {
+                                           memcpy(&buffer[0], &input[offset], bufSize);
+                                       }
+                                       return bufSize;
+                                   } writeBuffer:^(const void *buffer, const unsigned int length) {
+                                       [output appendBytes:buffer length:length];
+                                   } completion:^(ZXCError errorCode) {
+#ifdef DEBUG
+                                       NSLog(@"[Huffman] input: %llu bytes, output: %llu bytes", inputSize, (unsigned long long)output.length);
+#endif
+                                       if (completion) {
+                                           completion(errorCode == kZXCErrorNone ? [output copy] : nil);
+                                       }
+                                   }];
+            break;
+        }
+        case kZXCAlgorithmFSE:
+        {
+            [self decompressUsingFSE:options.blockSize
+                          readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                              unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
+                              if (bufSize > 0) {
+                                  memcpy(&buffer[0], &input[offset], bufSize);
+                              }
+                              return bufSize;
+                          } writeBuffer:^(const void *buffer, const unsigned int length) {
+                              [output appendBytes:buffer length:length];
+                          } completion:^(ZXCError errorCode) {
 #ifdef DEBUG
-                                  NSLog(@"[Huffman] input: %d bytes, output: %d bytes", (int)inputSize, (int)output.length);
+                              NSLog(@"[FSE] input: %llu bytes, output: %llu bytes", inputSize, (unsigned long long)output.length);
 #endif
-                                  if (completion) {
-                                      completion([output copy]);
-                                  }
-                              }];
+                              if (completion) {
+                                  completion(errorCode == kZXCErrorNone ? [output copy] : nil);
+                              }
+                          }];
+            break;
+        }
+        case kZXCAlgorithmLZH:
+        {
+            [self decompressUsingLZH:options.blockSize
+                          readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                              unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
+                              if (bufSize > 0) {
+                                  memcpy(&buffer[0], &input[offset], bufSize);
+                              }
+                              return bufSize;
+                          } writeBuffer:^(const void *buffer, const unsigned int length) {
+                              [output appendBytes:buffer length:length];
+                          } completion:^(ZXCError errorCode) {
+#ifdef DEBUG
+                              NSLog(@"[LZH] input: %llu bytes, output: %llu bytes", inputSize, (unsigned long long)output.length);
+#endif
+                              if (completion) {
+                                  completion(errorCode == kZXCErrorNone ? [output copy] : nil);
+                              }
+                          }];
             break;
         }
         default:
@@ -458,11 +777,19 @@
 }
 
 + (void)decompressFileAtPath:(NSString *)source toPath:(NSString *)target usingAlgorithm:(ZXCAlgorithm)algorithm completion:(void(^)(NSError *error))completion {
+    [self decompressFileAtPath:source toPath:target usingAlgorithm:algorithm options:nil completion:completion];
+}
+
++ (void)decompressFileAtPath:(NSString *)source toPath:(NSString *)target usingAlgorithm:(ZXCAlgorithm)algorithm options:(ZXCompressorOptions *)options completion:(void(^)(NSError *error))completion {
+    // 选项, nil 为默认值
+    if (!options) {
+        options = [ZXCompressorOptions options];
+    }
     // 错误信息
     NSError *error = nil;
     // 输入文件
     NSFileHandle *input = [NSFileHandle fileHandleForReadingFromURL:[NSURL fileURLWithPath:source] error:&error];
-    unsigned int inputSize = (unsigned int)[input seekToEndOfFile];
+    unsigned long long inputSize = [input seekToEndOfFile];
     if (error) {
         if (completion) {
             completion(error);
@@ -490,11 +817,12 @@
     switch (algorithm) {
         case kZXCAlgorithmLZ77:
         {
-            [self decompressUsingLZ77:LZ77_WINDOW_SIZE
-                           bufferSize:LZ77_BUFFER_SIZE
-                           readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
+            [self decompressUsingLZ77:options.lz77WindowSize
+                           bufferSize:MIN(options.lz77BufferSize, options.lz77WindowSize)
+                           dictionary:nil
+                           readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
                                [input seekToFileOffset:offset];
-                               unsigned int bufSize = MIN(length, inputSize - offset);
+                               unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                                if (bufSize > 0) {
                                    NSData *data = [input readDataOfLength:bufSize];
                                    memcpy(buffer, data.bytes, bufSize);
@@ -502,26 +830,27 @@
                                return bufSize;
                            } writeBuffer:^(const void *buffer, const unsigned int length) {
                                [output writeData:[NSData dataWithBytes:buffer length:length]];
-                           } completion:^{
+                           } completion:^(ZXCError errorCode) {
 #ifdef DEBUG
-                               NSLog(@"[LZ77] input: %d bytes, output: %d bytes", (int)inputSize, (int)[output seekToEndOfFile]);
+                               NSLog(@"[LZ77] input: %llu bytes, output: %llu bytes", inputSize, [output seekToEndOfFile]);
 #endif
                                [input closeFile];
                                [output closeFile];
                                //
                                if (completion) {
-                                   completion(nil);
+                                   completion(errorCode == kZXCErrorNone ? nil : [self errorWithCode:errorCode]);
                                }
                            }];
             break;
         }
         case kZXCAlgorithmLZSS:
         {
-            [self decompressUsingLZSS:LZ77_WINDOW_SIZE
-                           bufferSize:LZ77_BUFFER_SIZE
-                           readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
+            [self decompressUsingLZSS:options.lzssWindowSize
+                           bufferSize:MIN(options.lzssBufferSize, options.lzssWindowSize)
+                           dictionary:nil
+                           readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
                                [input seekToFileOffset:offset];
-                               unsigned int bufSize = MIN(length, inputSize - offset);
+                               unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                                if (bufSize > 0) {
                                    NSData *data = [input readDataOfLength:bufSize];
                                    memcpy(buffer, data.bytes, bufSize);
@@ -529,25 +858,27 @@
                                return bufSize;
                            } writeBuffer:^(const void *buffer, const unsigned int length) {
                                [output writeData:[NSData dataWithBytes:buffer length:length]];
-                           } completion:^{
+                           } completion:^(ZXCError errorCode) {
 #ifdef DEBUG
-                               NSLog(@"[LZSS] input: %d bytes, output: %d bytes", (int)inputSize, (int)[output seekToEndOfFile]);
+                               NSLog(@"[LZSS] input: %llu bytes, output: %llu bytes", inputSize, [output seekToEndOfFile]);
 #endif
                                [input closeFile];
                                [output closeFile];
                                //
                                if (completion) {
-                                   completion(nil);
+                                   completion(errorCode == kZXCErrorNone ? nil : [self errorWithCode:errorCode]);
                                }
                            }];
             break;
         }
         case kZXCAlgorithmLZ78:
         {
-            [self decompressUsingLZ78:LZ78_DICT_SIZE
-                           readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
+            [self decompressUsingLZ78:options.dictionarySize
+                           dictionary:nil
+                               policy:options.dictionaryPolicy
+                           readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
                                [input seekToFileOffset:offset];
-                               unsigned int bufSize = MIN(length, inputSize - offset);
+                               unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                                if (bufSize > 0) {
                                    NSData *data = [input readDataOfLength:bufSize];
                                    memcpy(buffer, data.bytes, bufSize);
@@ -555,25 +886,27 @@
                                return bufSize;
                            } writeBuffer:^(const void *buffer, const unsigned int length) {
                                [output writeData:[NSData dataWithBytes:buffer length:length]];
-                           } completion:^{
+                           } completion:^(ZXCError errorCode) {
 #ifdef DEBUG
-                               NSLog(@"[LZ78] input: %d bytes, output: %d bytes", (int)inputSize, (int)[output seekToEndOfFile]);
+                               NSLog(@"[LZ78] input: %llu bytes, output: %llu bytes", inputSize, [output seekToEndOfFile]);
 #endif
                                [input closeFile];
                                [output closeFile];
                                //
                                if (completion) {
-                                   completion(nil);
+                                   completion(errorCode == kZXCErrorNone ? nil : [self errorWithCode:errorCode]);
                                }
                            }];
             break;
         }
         case kZXCAlgorithmLZW:
         {
-            [self decompressUsingLZW:LZW_DICT_SIZE
-                          readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
+            [self decompressUsingLZW:options.dictionarySize
+                          dictionary:nil
+                              policy:options.dictionaryPolicy
+                          readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
                               [input seekToFileOffset:offset];
-                              unsigned int bufSize = MIN(length, inputSize - offset);
+                              unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
                               if (bufSize > 0) {
                                   NSData *data = [input readDataOfLength:bufSize];
                                   memcpy(buffer, data.bytes, bufSize);
@@ -581,43 +914,95 @@
                               return bufSize;
                           } writeBuffer:^(const void *buffer, const unsigned int length) {
                               [output writeData:[NSData dataWithBytes:buffer length:length]];
-                          } completion:^{
+                          } completion:^(ZXCError errorCode) {
 #ifdef DEBUG
-                              NSLog(@"[LZW] input: %d bytes, output: %d bytes", (int)inputSize, (int)[output seekToEndOfFile]);
+                              NSLog(@"[LZW] input: %llu bytes, output: %llu bytes", inputSize, [output seekToEndOfFile]);
 #endif
                               [input closeFile];
                               [output closeFile];
                               //
                               if (completion) {
-                                  completion(nil);
+                                  completion(errorCode == kZXCErrorNone ? nil : [self errorWithCode:errorCode]);
                               }
                           }];
             break;
         }
         case kZXCAlgorithmHuffman:
         {
-            [self decompressUsingHuffman:HUFFMAN_BUFFER_SIZE
-                              readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned int offset) {
-                                  [input seekToFileOffset:offset];
-                                  unsigned int bufSize = MIN(length, inputSize - offset);
-                                  if (bufSize > 0) {
-                                      NSData *data = [input readDataOfLength:bufSize];
-                                      memcpy(buffer, data.bytes, bufSize);
-                                  }
-                                  return bufSize;
-                              } writeBuffer:^(const void *buffer, const unsigned int length) {
-                                  [output writeData:[NSData dataWithBytes:buffer length:length]];
-                              } completion:^{
-#ifdef DEBUG
-                                  NSLog(@"[Huffman] input: %d bytes, output: %d bytes", (int)inputSize, (int)[output seekToEndOfFile]);
-#endif
-                                  [input closeFile];
-                                  [output closeFile];
-                                  //
-                                  if (completion) {
-                                      completion(nil);
-                                  }
-                              }];
+            [self decompressUsingHuffmanBlock:options.blockSize
+                                   readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                                       [input seekToFileOffset:offset];
+                                       unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
+                                       if (bufSize > 0) {
+                                           NSData *data = [input readDataOfLength:bufSize];
+                                           memcpy(buffer, data.bytes, bufSize);
+                                       }
+                                       return bufSize;
+                                   } writeBuffer:^(const void *buffer, const unsigned int length) {
+                                       [output writeData:[NSData dataWithBytes:buffer length:length]];
+                                   } completion:^(ZXCError errorCode) {
+#ifdef DEBUG
+                                       NSLog(@"[Huffman] input: %llu bytes, output: %llu bytes", inputSize, [output seekToEndOfFile]);
+#endif
+                                       [input closeFile];
+                                       [output closeFile];
+                                       //
+                                       if (completion) {
+                                           completion(errorCode == kZXCErrorNone ? nil : [self errorWithCode:errorCode]);
+                                       }
+                                   }];
+            break;
+        }
+        case kZXCAlgorithmFSE:
+        {
+            [self decompressUsingFSE:options.blockSize
+                          readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                              [input seekToFileOffset:offset];
+                              unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
+                              if (bufSize > 0) {
+                                  NSData *data = [input readDataOfLength:bufSize];
+                                  memcpy(buffer, data.bytes, bufSize);
+                              }
+                              return bufSize;
+                          } writeBuffer:^(const void *buffer, const unsigned int length) {
+                              [output writeData:[NSData dataWithBytes:buffer length:length]];
+                          } completion:^(ZXCError errorCode) {
+#ifdef DEBUG
+                              NSLog(@"[FSE] input: %llu bytes, output: %llu bytes", inputSize, [output seekToEndOfFile]);
+#endif
+                              [input closeFile];
+                              [output closeFile];
+                              //
+                              if (completion) {
+                                  completion(errorCode == kZXCErrorNone ? nil : [self errorWithCode:errorCode]);
+                              }
+                          }];
+            break;
+        }
+        case kZXCAlgorithmLZH:
+        {
+            [self decompressUsingLZH:options.blockSize
+                          readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                              [input seekToFileOffset:offset];
+                              unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
+                              if (bufSize > 0) {
+                                  NSData *data = [input readDataOfLength:bufSize];
+                                  memcpy(buffer, data.bytes, bufSize);
+                              }
+                              return bufSize;
+                          } writeBuffer:^(const void *buffer, const unsigned int length) {
+                              [output writeData:[NSData dataWithBytes:buffer length:length]];
+                          } completion:^(ZXCError errorCode) {
+#ifdef DEBUG
+                              NSLog(@"[LZH] input: %llu bytes, output: %llu bytes", inputSize, [output seekToEndOfFile]);
+#endif
+                              [input closeFile];
+                              [output closeFile];
+                              //
+                              if (completion) {
+                                  completion(errorCode == kZXCErrorNone ? nil : [self errorWithCode:errorCode]);
+                              }
+                          }];
             break;
         }
         default:
@@ -626,6 +1011,381 @@
     }
 }
 
++ (void)compressFileAtPath:(NSString *)source toPath:(NSString *)target chunkStore:(ZXCChunkStore *)store completion:(void(^)(NSError *error))completion {
+    // 错误信息
+    NSError *error = nil;
+    // 输入文件(映射到内存)
+    NSData *input = [NSData dataWithContentsOfFile:source options:NSDataReadingMappedIfSafe error:&error];
+    if (!input) {
+        if (completion) {
+            completion(error);
+        }
+        return;
+    }
+    const unsigned char *bytes = input.bytes;
+    unsigned long long inputSize = input.length;
+    // 清单
+    NSMutableData *manifest = [NSMutableData dataWithCapacity:MANIFEST_HEADER_SIZE + (NSUInteger)(inputSize / CHUNK_AVG_SIZE + 1) * MANIFEST_ENTRY_SIZE];
+    [manifest appendBytes:kManifestMagic length:sizeof(kManifestMagic)];
+    [manifest increaseLengthBy:sizeof(unsigned int)];
+    unsigned long long size = NSSwapHostLongLongToBig(inputSize);
+    [manifest appendBytes:&size length:sizeof(size)];
+    // 按内容分块, 只压缩存储中没有的分块
+    chunker *contentChunker = malloc(sizeof(chunker));
+    chunker_init(contentChunker);
+    unsigned int count = 0;
+    for (unsigned long long offset = 0; offset < inputSize; count++) {
+        @autoreleasepool {
+            unsigned int length = chunker_next(contentChunker, &bytes[offset], inputSize - offset);
+            NSData *chunk = [NSData dataWithBytesNoCopy:(void *)&bytes[offset] length:length freeWhenDone:NO];
+            NSData *digest = [ZXCChunkStore digestOfChunk:chunk];
+            if (![store addChunk:chunk digest:digest error:&error]) {
+                break;
+            }
+            unsigned int length_n = NSSwapHostIntToBig(length);
+            [manifest appendData:digest];
+            [manifest appendBytes:&length_n length:sizeof(length_n)];
+            offset += length;
+        }
+    }
+    free(contentChunker);
+    unsigned int count_n = NSSwapHostIntToBig(count);
+    [manifest replaceBytesInRange:NSMakeRange(sizeof(kManifestMagic), sizeof(count_n)) withBytes:&count_n];
+    if (!error) {
+        [manifest writeToFile:target options:NSDataWritingAtomic error:&error];
+    }
+#ifdef DEBUG
+    NSLog(@"[Chunks] input: %llu bytes, chunks: %u, manifest: %llu bytes", inputSize, count, (unsigned long long)manifest.length);
+#endif
+    if (completion) {
+        completion(error);
+    }
+}
+
++ (void)decompressFileAtPath:(NSString *)source toPath:(NSString *)target chunkStore:(ZXCChunkStore *)store completion:(void(^)(NSError *error))completion {
+    // 错误信息
+    NSError *error = nil;
+    // 清单
+    NSData *manifest = [NSData dataWithContentsOfFile:source options:0 error:&error];
+    if (!manifest) {
+        if (completion) {
+            completion(error);
+        }
+        return;
+    }
+    const unsigned char *bytes = manifest.bytes;
+    unsigned int count = 0;
+    unsigned long long outputSize = 0;
+    if (manifest.length < MANIFEST_HEADER_SIZE) {
+        error = [self errorWithCode:kZXCErrorTruncated];
+    } else if (memcmp(bytes, kManifestMagic, sizeof(kManifestMagic)) != 0) {
+        error = [self errorWithCode:kZXCErrorCorrupted];
+    } else {
+        memcpy(&count, &bytes[4], sizeof(count));
+        memcpy(&outputSize, &bytes[8], sizeof(outputSize));
+        count = NSSwapBigIntToHost(count);
+        outputSize = NSSwapBigLongLongToHost(outputSize);
+        if (manifest.length < MANIFEST_HEADER_SIZE + (unsigned long long)count * MANIFEST_ENTRY_SIZE) {
+            error = [self errorWithCode:kZXCErrorTruncated];
+        } else if (manifest.length > MANIFEST_HEADER_SIZE + (unsigned long long)count * MANIFEST_ENTRY_SIZE) {
+            error = [self errorWithCode:kZXCErrorCorrupted];
+        }
+    }
+    if (error) {
+        if (completion) {
+            completion(error);
+        }
+        return;
+    }
+    // 输出文件
+    if (![[NSFileManager defaultManager] createFileAtPath:target contents:nil attributes:nil]) {
+        if (completion) {
+            completion([NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:@{NSFilePathErrorKey: target}]);
+        }
+        return;
+    }
+    NSFileHandle *output = [NSFileHandle fileHandleForWritingToURL:[NSURL fileURLWithPath:target] error:&error];
+    if (error) {
+        if (completion) {
+            completion(error);
+        }
+        return;
+    }
+    // 按顺序取出分块
+    unsigned long long length = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        @autoreleasepool {
+            const unsigned char *entry = &bytes[MANIFEST_HEADER_SIZE + (unsigned long long)i * MANIFEST_ENTRY_SIZE];
+            NSData *digest = [NSData dataWithBytes:entry length:CC_SHA256_DIGEST_LENGTH];
+            unsigned int chunkSize;
+            memcpy(&chunkSize, &entry[CC_SHA256_DIGEST_LENGTH], sizeof(chunkSize));
+            chunkSize = NSSwapBigIntToHost(chunkSize);
+            NSData *chunk = [store chunkWithDigest:digest error:&error];
+            if (!chunk) {
+                break;
+            }
+            if (chunk.length != chunkSize) {
+                error = [self errorWithCode:kZXCErrorCorrupted];
+                break;
+            }
+            [output writeData:chunk];
+            length += chunkSize;
+        }
+    }
+    if (!error && length != outputSize) {
+        error = [self errorWithCode:kZXCErrorCorrupted];
+    }
+    [output closeFile];
+#ifdef DEBUG
+    NSLog(@"[Chunks] chunks: %u, output: %llu bytes", count, length);
+#endif
+    if (completion) {
+        completion(error);
+    }
+}
+
++ (void)compressSeekableFileAtPath:(NSString *)source toPath:(NSString *)target usingAlgorithm:(ZXCAlgorithm)algorithm blockSize:(unsigned int)blockSize completion:(void(^)(NSError *error))completion {
+    [self compressSeekableFileAtPath:source toPath:target usingAlgorithm:algorithm blockSize:blockSize options:nil completion:completion];
+}
+
++ (void)compressSeekableFileAtPath:(NSString *)source toPath:(NSString *)target usingAlgorithm:(ZXCAlgorithm)algorithm blockSize:(unsigned int)blockSize options:(ZXCompressorOptions *)options completion:(void(^)(NSError *error))completion {
+    // 错误信息
+    NSError *error = nil;
+    // 输入文件(映射到内存)
+    NSData *input = [NSData dataWithContentsOfFile:source options:NSDataReadingMappedIfSafe error:&error];
+    if (!input) {
+        if (completion) {
+            completion(error);
+        }
+        return;
+    }
+    unsigned long long inputSize = input.length;
+    if (blockSize == 0) {
+        blockSize = SEEKABLE_BLOCK_SIZE;
+    }
+    // 输出文件
+    if (![[NSFileManager defaultManager] createFileAtPath:target contents:nil attributes:nil]) {
+        if (completion) {
+            completion([NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:@{NSFilePathErrorKey: target}]);
+        }
+        return;
+    }
+    NSFileHandle *output = [NSFileHandle fileHandleForWritingToURL:[NSURL fileURLWithPath:target] error:&error];
+    if (error) {
+        if (completion) {
+            completion(error);
+        }
+        return;
+    }
+    unsigned char header[SEEKABLE_HEADER_SIZE];
+    memcpy(header, kSeekableMagic, sizeof(kSeekableMagic));
+    header[4] = (unsigned char)algorithm;
+    [self writeData:[NSData dataWithBytes:header length:sizeof(header)] toFileHandle:output path:target error:&error];
+    unsigned long long outputSize = sizeof(header);
+    // 块相互独立, 每批按处理器个数并行压缩, 按顺序写入
+    unsigned int blocks = (unsigned int)((inputSize + blockSize - 1) / blockSize);
+    NSUInteger batch = MAX(1, [NSProcessInfo processInfo].activeProcessorCount);
+    NSMutableData *index = [NSMutableData dataWithCapacity:(NSUInteger)blocks * SEEKABLE_ENTRY_SIZE + SEEKABLE_FOOTER_SIZE];
+    for (unsigned int first = 0; first < blocks && !error; first += batch) {
+        @autoreleasepool {
+            unsigned int count = (unsigned int)MIN(batch, blocks - first);
+            NSMutableArray *results = [NSMutableArray arrayWithCapacity:count];
+            for (unsigned int i = 0; i < count; i++) {
+                [results addObject:[NSNull null]];
+            }
+            dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+                unsigned long long offset = (unsigned long long)(first + i) * blockSize;
+                NSData *block = [input subdataWithRange:NSMakeRange((NSUInteger)offset, (NSUInteger)MIN(blockSize, inputSize - offset))];
+                [self compressData:block usingAlgorithm:algorithm options:options completion:^(NSData *data) {
+                    if (data) {
+                        @synchronized (results) {
+                            results[i] = data;
+                        }
+                    }
+                }];
+            });
+            for (unsigned int i = 0; i < count; i++) {
+                // 块压缩失败(不支持的算法), 不写入无法解压的文件
+                NSData *data = results[i];
+                if (![data isKindOfClass:[NSData class]]) {
+                    error = [self errorWithCode:kZXCErrorCompressFailed];
+                    break;
+                }
+                unsigned long long entry[2] = {
+                    NSSwapHostLongLongToBig((unsigned long long)(first + i) * blockSize),
+                    NSSwapHostLongLongToBig(outputSize)
+                };
+                [index appendBytes:entry length:sizeof(entry)];
+                if (![self writeData:data toFileHandle:output path:target error:&error]) {
+                    break;
+                }
+                outputSize += data.length;
+            }
+        }
+    }
+    // 块索引 + 尾部
+    if (!error) {
+        unsigned long long size = NSSwapHostLongLongToBig(inputSize);
+        unsigned int blocks_n = NSSwapHostIntToBig(blocks);
+        [index appendBytes:&size length:sizeof(size)];
+        [index appendBytes:&blocks_n length:sizeof(blocks_n)];
+        [index appendBytes:kSeekableMagic length:sizeof(kSeekableMagic)];
+        [self writeData:index toFileHandle:output path:target error:&error];
+    }
+    [output closeFile];
+    if (error) {
+        // 不完整的文件
+        [[NSFileManager defaultManager] removeItemAtPath:target error:nil];
+    }
+#ifdef DEBUG
+    NSLog(@"[Seekable] input: %llu bytes, blocks: %u, output: %llu bytes, error: %@", inputSize, blocks, outputSize + (unsigned long long)index.length, error);
+#endif
+    if (completion) {
+        completion(error);
+    }
+}
+
++ (void)decompressRange:(NSRange)range ofSeekableFileAtPath:(NSString *)source completion:(void(^)(NSData *data, NSError *error))completion {
+    [self decompressRange:range ofSeekableFileAtPath:source options:nil completion:completion];
+}
+
++ (void)decompressRange:(NSRange)range ofSeekableFileAtPath:(NSString *)source options:(ZXCompressorOptions *)options completion:(void(^)(NSData *data, NSError *error))completion {
+    // 错误信息
+    NSError *error = nil;
+    // 输入文件(映射到内存, 只读取覆盖范围的块)
+    NSData *input = [NSData dataWithContentsOfFile:source options:NSDataReadingMappedIfSafe error:&error];
+    if (!input) {
+        if (completion) {
+            completion(nil, error);
+        }
+        return;
+    }
+    const unsigned char *bytes = input.bytes;
+    unsigned long long inputSize = input.length;
+    // 尾部
+    unsigned long long outputSize = 0;
+    unsigned int blocks = 0;
+    unsigned long long indexOffset = 0;
+    if (inputSize < SEEKABLE_HEADER_SIZE + SEEKABLE_FOOTER_SIZE) {
+        error = [self errorWithCode:kZXCErrorTruncated];
+    } else if (memcmp(bytes, kSeekableMagic, sizeof(kSeekableMagic)) != 0 || memcmp(&bytes[inputSize - sizeof(kSeekableMagic)], kSeekableMagic, sizeof(kSeekableMagic)) != 0) {
+        error = [self errorWithCode:kZXCErrorCorrupted];
+    } else {
+        memcpy(&outputSize, &bytes[inputSize - SEEKABLE_FOOTER_SIZE], sizeof(outputSize));
+        memcpy(&blocks, &bytes[inputSize - SEEKABLE_FOOTER_SIZE + 8], sizeof(blocks));
+        outputSize = NSSwapBigLongLongToHost(outputSize);
+        blocks = NSSwapBigIntToHost(blocks);
+        unsigned long long indexSize = (unsigned long long)blocks * SEEKABLE_ENTRY_SIZE;
+        if (indexSize > inputSize - SEEKABLE_HEADER_SIZE - SEEKABLE_FOOTER_SIZE) {
+            error = [self errorWithCode:kZXCErrorCorrupted];
+        } else {
+            indexOffset = inputSize - SEEKABLE_FOOTER_SIZE - indexSize;
+        }
+    }
+    if (error) {
+        if (completion) {
+            completion(nil, error);
+        }
+        return;
+    }
+    ZXCAlgorithm algorithm = (ZXCAlgorithm)bytes[4];
+    // 块的原始偏移和压缩后的偏移
+    unsigned long long (^entryAt)(unsigned int, unsigned int) = ^unsigned long long(unsigned int block, unsigned int field) {
+        unsigned long long value;
+        memcpy(&value, &bytes[indexOffset + (unsigned long long)block * SEEKABLE_ENTRY_SIZE + field * 8], sizeof(value));
+        return NSSwapBigLongLongToHost(value);
+    };
+    // 索引来自文件, 二分查找和拼接都依赖它: 原始偏移从 0 开始不递减且不超过原始长度, 压缩偏移不递减且在块数据之内
+    for (unsigned int block = 0; block < blocks; block++) {
+        unsigned long long offset = entryAt(block, 0), start = entryAt(block, 1);
+        if (offset > outputSize || start < SEEKABLE_HEADER_SIZE || start > indexOffset ||
+            (block == 0 ? offset != 0 : offset < entryAt(block - 1, 0) || start < entryAt(block - 1, 1))) {
+            error = [self errorWithCode:kZXCErrorCorrupted];
+            break;
+        }
+    }
+    if (error) {
+        if (completion) {
+            completion(nil, error);
+        }
+        return;
+    }
+    // 裁剪到原始长度
+    unsigned long long location = MIN(range.location, outputSize);
+    unsigned long long end = location + MIN(range.length, outputSize - location);
+    if (location >= end) {
+        if (completion) {
+            completion([NSData data], nil);
+        }
+        return;
+    }
+    // 二分查找覆盖范围的第一个块和最后一个块
+    unsigned int low = 0, high = blocks;
+    while (high - low > 1) {
+        unsigned int middle = low + (high - low) / 2;
+        if (entryAt(middle, 0) <= location) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    unsigned int first = low;
+    high = blocks;
+    while (high - low > 1) {
+        unsigned int middle = low + (high - low) / 2;
+        if (entryAt(middle, 0) < end) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    unsigned int count = blocks > 0 ? low - first + 1 : 0;
+    // 并行解压覆盖范围的块
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:count];
+    for (unsigned int i = 0; i < count; i++) {
+        [results addObject:[NSNull null]];
+    }
+    dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        unsigned int block = first + (unsigned int)i;
+        unsigned long long start = entryAt(block, 1);
+        unsigned long long stop = block + 1 < blocks ? entryAt(block + 1, 1) : indexOffset;
+        if (start < SEEKABLE_HEADER_SIZE || start > stop || stop > indexOffset) {
+            return;
+        }
+        [self decompressData:[input subdataWithRange:NSMakeRange((NSUInteger)start, (NSUInteger)(stop - start))] usingAlgorithm:algorithm options:options completion:^(NSData *data) {
+            if (data) {
+                @synchronized (results) {
+                    results[i] = data;
+                }
+            }
+        }];
+    });
+    // 拼接, 去掉范围之外的字节
+    NSMutableData *output = [NSMutableData dataWithCapacity:(NSUInteger)(end - location)];
+    for (unsigned int i = 0; i < count && !error; i++) {
+        NSData *data = results[i];
+        unsigned long long offset = entryAt(first + i, 0);
+        unsigned long long length = first + i + 1 < blocks ? entryAt(first + i + 1, 0) - offset : outputSize - offset;
+        if (![data isKindOfClass:[NSData class]] || data.length != length) {
+            error = [self errorWithCode:kZXCErrorCorrupted];
+            break;
+        }
+        unsigned long long from = MAX(location, offset) - offset;
+        unsigned long long to = MIN(end, offset + length) - offset;
+        if (from > to) {
+            error = [self errorWithCode:kZXCErrorCorrupted];
+            break;
+        }
+        [output appendBytes:(const unsigned char *)data.bytes + from length:(NSUInteger)(to - from)];
+    }
+    if (!error && output.length != end - location) {
+        error = [self errorWithCode:kZXCErrorCorrupted];
+    }
+    if (completion) {
+        completion(error ? nil : output, error);
+    }
+}
+
 @end
 
 
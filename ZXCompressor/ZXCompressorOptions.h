@@ -0,0 +1,114 @@
+//
+// ZXCompressorOptions.h
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#import "ZXCompressor.h"
+
+/* The compression levels */
+#define kZXCLevelFastest        1
+#define kZXCLevelDefault        5
+#define kZXCLevelSmallest       9
+
+/**
+ ZXCompressorOptions
+ 
+ The tuning of the compression, a level preset (speed/ratio) with explicit overrides, accepted by every ZXCompressor method,
+ the chunk store and the streams. The level sets the window size, depth and parse of kZXCAlgorithmLZH and the sizes
+ of kZXCAlgorithmLZ77/LZSS/LZ78/LZW, set a property after the level to override it. kZXCAlgorithmLZH reads its window
+ size from the stream, the other sizes, the block size and the dictionary policy are not stored in the data,
+ pass the same options (or nil for both) to the decompressor. Levels 1 ~ 5 keep the LZ77/LZSS/LZ78/LZW sizes of the methods without options
+ 
+ level | LZH window | depth | parse  | LZ77 window/buffer | LZSS window/buffer | LZ78/LZW dictionary
+ 1     | 64 KB      | 1     | greedy | 256 / 256          | 4 KB / 256         | 64 K codes
+ 2     | 64 KB      | 2     | greedy | 256 / 256          | 4 KB / 256         | 64 K codes
+ 3     | 64 KB      | 4     | greedy | 256 / 256          | 4 KB / 256         | 64 K codes
+ 4     | 64 KB      | 8     | greedy | 256 / 256          | 4 KB / 256         | 64 K codes
+ 5     | 64 KB      | 16    | greedy | 256 / 256          | 4 KB / 256         | 64 K codes (the default, the same output as the methods without options)
+ 6     | 64 KB      | 16    | lazy   | 1 KB / 256         | 4 KB / 256         | 64 K codes
+ 7     | 1 MB       | 32    | lazy   | 4 KB / 1 KB        | 16 KB / 1 KB       | 256 K codes
+ 8     | 8 MB       | 64    | lazy   | 16 KB / 4 KB       | 32 KB / 4 KB       | 512 K codes
+ 9     | 64 MB      | 128   | lazy   | 32 KB / 4 KB       | 32 KB / 4 KB       | 1 M codes
+ */
+@interface ZXCompressorOptions : NSObject <NSCopying>
+
+/** The level, kZXCLevelFastest ~ kZXCLevelSmallest */
+@property (nonatomic, readonly) int level;
+
+/** The sliding window size of kZXCAlgorithmLZH, rounded up to a power of two in [1 KB, 1 GB], both sides hold the window in memory */
+@property (nonatomic, assign) unsigned int windowSize;
+
+/** The max candidates compared per match search of kZXCAlgorithmLZH */
+@property (nonatomic, assign) unsigned int depth;
+
+/** The parse of kZXCAlgorithmLZH, see ZXCParse */
+@property (nonatomic, assign) ZXCParse parse;
+
+/** The block size of kZXCAlgorithmHuffman/FSE/LZH and the streams, 128 KB by default, clamped to [kZXCBlockSizeMin, kZXCBlockSizeMax] (1 KB ~ 64 MB), the decompressor must use the same */
+@property (nonatomic, assign) unsigned int blockSize;
+
+/** The sliding window size of kZXCAlgorithmLZ77, clamped to [16, 64 KB], it sets the offset field size, the decompressor must use the same */
+@property (nonatomic, assign) unsigned int lz77WindowSize;
+
+/** The look ahead buffer size (longest phrase) of kZXCAlgorithmLZ77, clamped to [16, 64 KB] and to the window size when used, it sets the length field size, the decompressor must use the same */
+@property (nonatomic, assign) unsigned int lz77BufferSize;
+
+/** The sliding window size of kZXCAlgorithmLZSS, clamped to [16, 64 KB], it sets the offset field size, the decompressor must use the same */
+@property (nonatomic, assign) unsigned int lzssWindowSize;
+
+/** The look ahead buffer size (longest match) of kZXCAlgorithmLZSS, clamped to [16, 64 KB] and to the window size when used, it sets the length field size, the decompressor must use the same */
+@property (nonatomic, assign) unsigned int lzssBufferSize;
+
+/** The code dictionary size of kZXCAlgorithmLZ78/LZW, clamped to [4 K, 4 M] codes, it sets the code size, the decompressor must use the same */
+@property (nonatomic, assign) unsigned int dictionarySize;
+
+/** The threads searching the matches of a kZXCAlgorithmLZH block, 0 (the default) for the active processors, the output does not depend on it */
+@property (nonatomic, assign) unsigned int threads;
+
+/** What kZXCAlgorithmLZ78/LZW do when the code dictionary is full, kZXCDictionaryPolicyReset by default, the decompressor must use the same */
+@property (nonatomic, assign) ZXCDictionaryPolicy dictionaryPolicy;
+
+/**
+ The default options (kZXCLevelDefault)
+
+ @return The options
+ */
++ (instancetype)options;
+
+/**
+ The options of a level
+
+ @param level The level, clamped to kZXCLevelFastest ~ kZXCLevelSmallest
+ @return The options
+ */
++ (instancetype)optionsWithLevel:(int)level;
+
+/**
+ Init the options of a level
+
+ @param level The level, clamped to kZXCLevelFastest ~ kZXCLevelSmallest
+ @return The options
+ */
+- (instancetype)initWithLevel:(int)level NS_DESIGNATED_INITIALIZER;
+
+@end
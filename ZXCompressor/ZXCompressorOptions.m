@@ -0,0 +1,134 @@
+//
+// ZXCompressorOptions.m
+//
+// Copyright (c) 2019 Zhao Xin (https://github.com/xinyzhao)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#import "ZXCompressorOptions.h"
+
+// 块大小, 与不带选项的方法相同
+#define OPTIONS_BLOCK_SIZE      131072
+// LZ77/LZSS 滑动窗口和前向缓冲区的范围, 决定偏移和长度的字节数
+#define OPTIONS_LZ_SIZE_MIN     16
+#define OPTIONS_LZ_SIZE_MAX     65536
+// LZ78/LZW 词典大小的范围, 决定编码的字节数, 两端的词典各占 (9 + 16) * 词典大小 字节
+#define OPTIONS_DICT_SIZE_MIN   4096
+#define OPTIONS_DICT_SIZE_MAX   (1 << 22)
+
+// 各级别 kZXCAlgorithmLZH 的窗口大小, 匹配深度和解析方式, LZ77/LZSS 的滑动窗口和前向缓冲区, LZ78/LZW 的词典大小
+// 1 ~ 5 级的 LZ77/LZSS/LZ78/LZW 与不带选项的方法相同
+static const struct {
+    unsigned int windowSize;
+    unsigned int depth;
+    ZXCParse parse;
+    unsigned int lz77WindowSize;
+    unsigned int lz77BufferSize;
+    unsigned int lzssWindowSize;
+    unsigned int lzssBufferSize;
+    unsigned int dictionarySize;
+} kLevels[kZXCLevelSmallest] = {
+    {1 << 16, 1, kZXCParseGreedy, 256, 256, 4096, 256, 1 << 16},
+    {1 << 16, 2, kZXCParseGreedy, 256, 256, 4096, 256, 1 << 16},
+    {1 << 16, 4, kZXCParseGreedy, 256, 256, 4096, 256, 1 << 16},
+    {1 << 16, 8, kZXCParseGreedy, 256, 256, 4096, 256, 1 << 16},
+    {1 << 16, 16, kZXCParseGreedy, 256, 256, 4096, 256, 1 << 16},
+    {1 << 16, 16, kZXCParseLazy, 1024, 256, 4096, 256, 1 << 16},
+    {1 << 20, 32, kZXCParseLazy, 4096, 1024, 16384, 1024, 1 << 18},
+    {1 << 23, 64, kZXCParseLazy, 16384, 4096, 32768, 4096, 1 << 19},
+    {1 << 26, 128, kZXCParseLazy, 32768, 4096, 32768, 4096, 1 << 20},
+};
+
+@implementation ZXCompressorOptions
+
++ (instancetype)options {
+    return [[self alloc] init];
+}
+
++ (instancetype)optionsWithLevel:(int)level {
+    return [[self alloc] initWithLevel:level];
+}
+
+- (instancetype)init {
+    return [self initWithLevel:kZXCLevelDefault];
+}
+
+- (instancetype)initWithLevel:(int)level {
+    self = [super init];
+    if (self) {
+        _level = MIN(MAX(level, kZXCLevelFastest), kZXCLevelSmallest);
+        _windowSize = kLevels[_level - 1].windowSize;
+        _depth = kLevels[_level - 1].depth;
+        _parse = kLevels[_level - 1].parse;
+        _blockSize = OPTIONS_BLOCK_SIZE;
+        _lz77WindowSize = kLevels[_level - 1].lz77WindowSize;
+        _lz77BufferSize = kLevels[_level - 1].lz77BufferSize;
+        _lzssWindowSize = kLevels[_level - 1].lzssWindowSize;
+        _lzssBufferSize = kLevels[_level - 1].lzssBufferSize;
+        _dictionarySize = kLevels[_level - 1].dictionarySize;
+        _threads = 0;
+        _dictionaryPolicy = kZXCDictionaryPolicyReset;
+    }
+    return self;
+}
+
+// 块大小为 0 时编码器不读入数据, 太大时缓冲区大小的计算溢出
+- (void)setBlockSize:(unsigned int)blockSize {
+    _blockSize = MIN(MAX(blockSize, kZXCBlockSizeMin), kZXCBlockSizeMax);
+}
+
+- (void)setLz77WindowSize:(unsigned int)lz77WindowSize {
+    _lz77WindowSize = MIN(MAX(lz77WindowSize, OPTIONS_LZ_SIZE_MIN), OPTIONS_LZ_SIZE_MAX);
+}
+
+- (void)setLz77BufferSize:(unsigned int)lz77BufferSize {
+    _lz77BufferSize = MIN(MAX(lz77BufferSize, OPTIONS_LZ_SIZE_MIN), OPTIONS_LZ_SIZE_MAX);
+}
+
+- (void)setLzssWindowSize:(unsigned int)lzssWindowSize {
+    _lzssWindowSize = MIN(MAX(lzssWindowSize, OPTIONS_LZ_SIZE_MIN), OPTIONS_LZ_SIZE_MAX);
+}
+
+- (void)setLzssBufferSize:(unsigned int)lzssBufferSize {
+    _lzssBufferSize = MIN(MAX(lzssBufferSize, OPTIONS_LZ_SIZE_MIN), OPTIONS_LZ_SIZE_MAX);
+}
+
+- (void)setDictionarySize:(unsigned int)dictionarySize {
+    _dictionarySize = MIN(MAX(dictionarySize, OPTIONS_DICT_SIZE_MIN), OPTIONS_DICT_SIZE_MAX);
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    ZXCompressorOptions *options = [[[self class] allocWithZone:zone] initWithLevel:_level];
+    options.windowSize = _windowSize;
+    options.depth = _depth;
+    options.parse = _parse;
+    options.blockSize = _blockSize;
+    options.lz77WindowSize = _lz77WindowSize;
+    options.lz77BufferSize = _lz77BufferSize;
+    options.lzssWindowSize = _lzssWindowSize;
+    options.lzssBufferSize = _lzssBufferSize;
+    options.dictionarySize = _dictionarySize;
+    options.threads = _threads;
+    options.dictionaryPolicy = _dictionaryPolicy;
+    return options;
+}
+
+@end
@@ -8,12 +8,36 @@
 
 #import <XCTest/XCTest.h>
 #import "ZXCompressor.h"
+#import "ZXCDictionary.h"
+#import "ZXCChunkStore.h"
+#import "ZXCStream.h"
+#import "ZXCompressorOptions.h"
+#import "ZXCompressor+Huffman.h"
+#import "ZXCompressor+LZH.h"
+#import "ZXCompressor+LZ78.h"
+#import "ZXCompressor+LZW.h"
+#import "ZXCompressor+Segment.h"
+#import "bitbyte.h"
+#import "codetable.h"
+#import "cpu.h"
+#import "crc32c.h"
+#import "hash.h"
+#import "hashtable.h"
+#import "histogram.h"
 #import "huffman.h"
 
 @interface ZXCompressorDemoTests : XCTestCase
 
 @end
 
+/* Sample data patterns */
+typedef enum {
+    kSamplePatternZero = 0, // all zero bytes
+    kSamplePatternText, // repetitive words, like logs/text
+    kSamplePatternRandom, // incompressible random bytes
+    kSamplePatternCount,
+} SamplePattern;
+
 @implementation ZXCompressorDemoTests
 
 - (void)setUp {
@@ -95,11 +119,1527 @@
     }
 }
 
-- (void)testPerformanceExample {
-    // This is an example of a performance test case.
+#pragma mark Helpers
+
+- (NSArray *)implementedAlgorithms {
+    return @[@(kZXCAlgorithmLZ77), @(kZXCAlgorithmLZSS), @(kZXCAlgorithmLZ78), @(kZXCAlgorithmLZW), @(kZXCAlgorithmHuffman), @(kZXCAlgorithmFSE), @(kZXCAlgorithmLZH)];
+}
+
+- (NSData *)compressData:(NSData *)data usingLZH:(unsigned int)blockSize threads:(unsigned int)threads {
+    NSMutableData *compressed = [NSMutableData data];
+    [ZXCompressor compressUsingLZH:blockSize
+                        windowSize:65536
+                             depth:16
+                           threads:threads
+                        readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                            unsigned int bufSize = offset < data.length ? (unsigned int)MIN(length, data.length - offset) : 0;
+                            memcpy(buffer, (const unsigned char *)data.bytes + offset, bufSize);
+                            return bufSize;
+                        } writeBuffer:^(const void *buffer, const unsigned int length) {
+                            [compressed appendBytes:buffer length:length];
+                        } completion:nil];
+    return compressed;
+}
+
+- (NSData *)compressData:(NSData *)data usingSegments:(ZXCAlgorithm)algorithm segmentSize:(unsigned int)segmentSize threads:(unsigned int)threads {
+    NSMutableData *compressed = [NSMutableData data];
+    const unsigned int (^readBuffer)(void *, const unsigned int, const unsigned long long) = ^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+        unsigned int bufSize = offset < data.length ? (unsigned int)MIN(length, data.length - offset) : 0;
+        memcpy(buffer, (const unsigned char *)data.bytes + offset, bufSize);
+        return bufSize;
+    };
+    void (^writeBuffer)(const void *, const unsigned int) = ^(const void *buffer, const unsigned int length) {
+        [compressed appendBytes:buffer length:length];
+    };
+    if (algorithm == kZXCAlgorithmLZ78) {
+        [ZXCompressor compressUsingLZ78:65536 dictionary:nil segmentSize:segmentSize threads:threads readBuffer:readBuffer writeBuffer:writeBuffer completion:nil];
+    } else {
+        [ZXCompressor compressUsingLZW:65536 dictionary:nil segmentSize:segmentSize threads:threads readBuffer:readBuffer writeBuffer:writeBuffer completion:nil];
+    }
+    return compressed;
+}
+
+- (NSData *)decompressData:(NSData *)data usingSegments:(ZXCAlgorithm)algorithm threads:(unsigned int)threads error:(ZXCError *)error {
+    NSMutableData *decompressed = [NSMutableData data];
+    __block ZXCError errorCode = kZXCErrorNone;
+    const unsigned int (^readBuffer)(void *, const unsigned int, const unsigned long long) = ^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+        unsigned int bufSize = offset < data.length ? (unsigned int)MIN(length, data.length - offset) : 0;
+        memcpy(buffer, (const unsigned char *)data.bytes + offset, bufSize);
+        return bufSize;
+    };
+    void (^writeBuffer)(const void *, const unsigned int) = ^(const void *buffer, const unsigned int length) {
+        [decompressed appendBytes:buffer length:length];
+    };
+    void (^completion)(ZXCError) = ^(ZXCError e) {
+        errorCode = e;
+    };
+    if (algorithm == kZXCAlgorithmLZ78) {
+        [ZXCompressor decompressUsingLZ78:65536 dictionary:nil threads:threads readBuffer:readBuffer writeBuffer:writeBuffer completion:completion];
+    } else {
+        [ZXCompressor decompressUsingLZW:65536 dictionary:nil threads:threads readBuffer:readBuffer writeBuffer:writeBuffer completion:completion];
+    }
+    if (error) {
+        *error = errorCode;
+    }
+    return errorCode == kZXCErrorNone ? decompressed : nil;
+}
+
+- (NSData *)compressData:(NSData *)data usingDictionaryCoder:(ZXCAlgorithm)algorithm tableSize:(unsigned int)tableSize dictionary:(ZXCDictionary *)dictionary policy:(ZXCDictionaryPolicy)policy {
+    NSMutableData *compressed = [NSMutableData data];
+    const unsigned int (^readBuffer)(void *, const unsigned int, const unsigned long long) = ^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+        unsigned int bufSize = offset < data.length ? (unsigned int)MIN(length, data.length - offset) : 0;
+        memcpy(buffer, (const unsigned char *)data.bytes + offset, bufSize);
+        return bufSize;
+    };
+    void (^writeBuffer)(const void *, const unsigned int) = ^(const void *buffer, const unsigned int length) {
+        [compressed appendBytes:buffer length:length];
+    };
+    if (algorithm == kZXCAlgorithmLZ78) {
+        [ZXCompressor compressUsingLZ78:tableSize dictionary:dictionary policy:policy readBuffer:readBuffer writeBuffer:writeBuffer completion:nil];
+    } else {
+        [ZXCompressor compressUsingLZW:tableSize dictionary:dictionary policy:policy readBuffer:readBuffer writeBuffer:writeBuffer completion:nil];
+    }
+    return compressed;
+}
+
+- (NSData *)decompressData:(NSData *)data usingDictionaryCoder:(ZXCAlgorithm)algorithm tableSize:(unsigned int)tableSize dictionary:(ZXCDictionary *)dictionary policy:(ZXCDictionaryPolicy)policy {
+    NSMutableData *decompressed = [NSMutableData data];
+    __block ZXCError errorCode = kZXCErrorNone;
+    const unsigned int (^readBuffer)(void *, const unsigned int, const unsigned long long) = ^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+        unsigned int bufSize = offset < data.length ? (unsigned int)MIN(length, data.length - offset) : 0;
+        memcpy(buffer, (const unsigned char *)data.bytes + offset, bufSize);
+        return bufSize;
+    };
+    void (^writeBuffer)(const void *, const unsigned int) = ^(const void *buffer, const unsigned int length) {
+        [decompressed appendBytes:buffer length:length];
+    };
+    void (^completion)(ZXCError) = ^(ZXCError e) {
+        errorCode = e;
+    };
+    if (algorithm == kZXCAlgorithmLZ78) {
+        [ZXCompressor decompressUsingLZ78:tableSize dictionary:dictionary policy:policy readBuffer:readBuffer writeBuffer:writeBuffer completion:completion];
+    } else {
+        [ZXCompressor decompressUsingLZW:tableSize dictionary:dictionary policy:policy readBuffer:readBuffer writeBuffer:writeBuffer completion:completion];
+    }
+    return errorCode == kZXCErrorNone ? decompressed : nil;
+}
+
+- (NSString *)nameOfAlgorithm:(ZXCAlgorithm)algorithm {
+    switch (algorithm) {
+        case kZXCAlgorithmLZ77: return @"LZ77";
+        case kZXCAlgorithmLZSS: return @"LZSS";
+        case kZXCAlgorithmLZ78: return @"LZ78";
+        case kZXCAlgorithmLZW: return @"LZW";
+        case kZXCAlgorithmHuffman: return @"Huffman";
+        case kZXCAlgorithmFSE: return @"FSE";
+        case kZXCAlgorithmLZH: return @"LZH";
+        default: return [NSString stringWithFormat:@"%d", algorithm];
+    }
+}
+
+// The brute-force LZ search is O(window) per byte, keep the largest samples affordable
+- (NSUInteger)maxSampleSizeOfAlgorithm:(ZXCAlgorithm)algorithm {
+    switch (algorithm) {
+        case kZXCAlgorithmLZSS: return 1 << 20;
+        default: return 4 << 20;
+    }
+}
+
+- (NSData *)sampleDataOfSize:(NSUInteger)size pattern:(SamplePattern)pattern seed:(unsigned int)seed {
+    static const char *words[] = {"GET ", "POST ", "/index.html ", "200 ", "404 ", "user=", "zhao ", "xin ", "\n", "{\"id\":", "\"name\":", "}, "};
+    const int count = sizeof(words) / sizeof(words[0]);
+    NSMutableData *data = [NSMutableData dataWithLength:size];
+    unsigned char *bytes = data.mutableBytes;
+    srand(seed);
+    switch (pattern) {
+        case kSamplePatternText:
+        {
+            for (NSUInteger i = 0; i < size; ) {
+                const char *word = words[rand() % count];
+                size_t length = MIN(strlen(word), size - i);
+                memcpy(&bytes[i], word, length);
+                i += length;
+            }
+            break;
+        }
+        case kSamplePatternRandom:
+        {
+            for (NSUInteger i = 0; i < size; i++) {
+                bytes[i] = (unsigned char)rand();
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return data;
+}
+
+- (NSData *)compressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm {
+    __block NSData *output = nil;
+    [ZXCompressor compressData:data usingAlgorithm:algorithm completion:^(NSData *data) {
+        output = data;
+    }];
+    return output;
+}
+
+- (NSData *)decompressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm {
+    __block NSData *output = nil;
+    [ZXCompressor decompressData:data usingAlgorithm:algorithm completion:^(NSData *data) {
+        output = data;
+    }];
+    return output;
+}
+
+- (void)assertRoundTrip:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm {
+    NSString *name = [self nameOfAlgorithm:algorithm];
+    NSData *compressed = [self compressData:data usingAlgorithm:algorithm];
+    XCTAssertNotNil(compressed, @"[%@] compress %d bytes", name, (int)data.length);
+    NSData *decompressed = [self decompressData:compressed usingAlgorithm:algorithm];
+    XCTAssertNotNil(decompressed, @"[%@] decompress %d bytes", name, (int)data.length);
+    XCTAssertEqual(decompressed.length, data.length, @"[%@] length mismatch", name);
+    XCTAssertTrue([decompressed isEqualToData:data], @"[%@] round trip of %d bytes", name, (int)data.length);
+}
+
+- (void)assertRoundTripUsingAlgorithm:(ZXCAlgorithm)algorithm {
+    const NSUInteger sizes[] = {0, 1, 2, 3, 7, 255, 256, 257, 4095, 4096, 4097, 65535, 65536, 65537, 1 << 20, 4 << 20};
+    const NSUInteger maxSize = [self maxSampleSizeOfAlgorithm:algorithm];
+    for (int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if (sizes[i] > maxSize) {
+            continue;
+        }
+        for (int pattern = 0; pattern < kSamplePatternCount; pattern++) {
+            NSData *data = [self sampleDataOfSize:sizes[i] pattern:pattern seed:i];
+            [self assertRoundTrip:data usingAlgorithm:algorithm];
+        }
+    }
+}
+
+#pragma mark Round trip
+
+- (void)testRoundTripLZ77 {
+    [self assertRoundTripUsingAlgorithm:kZXCAlgorithmLZ77];
+}
+
+- (void)testRoundTripLZSS {
+    [self assertRoundTripUsingAlgorithm:kZXCAlgorithmLZSS];
+}
+
+- (void)testRoundTripLZ78 {
+    [self assertRoundTripUsingAlgorithm:kZXCAlgorithmLZ78];
+}
+
+- (void)testRoundTripLZW {
+    [self assertRoundTripUsingAlgorithm:kZXCAlgorithmLZW];
+}
+
+- (void)testRoundTripHuffman {
+    [self assertRoundTripUsingAlgorithm:kZXCAlgorithmHuffman];
+}
+
+- (void)testRoundTripFSE {
+    [self assertRoundTripUsingAlgorithm:kZXCAlgorithmFSE];
+}
+
+- (void)testRoundTripLZH {
+    [self assertRoundTripUsingAlgorithm:kZXCAlgorithmLZH];
+}
+
+- (void)testRoundTripLZHWindow {
+    // matches across the blocks (block 4 KB, window 64 KB) and overlapped matches (runs)
+    NSMutableData *data = [NSMutableData data];
+    NSData *text = [self sampleDataOfSize:20000 pattern:kSamplePatternText seed:3];
+    [data appendData:text];
+    [data appendData:[self sampleDataOfSize:20000 pattern:kSamplePatternRandom seed:4]];
+    [data appendData:text];
+    [data appendData:[NSMutableData dataWithLength:10000]];
+    NSData *compressed = [self compressData:data usingLZH:4096 threads:0];
+    __block NSMutableData *decompressed = [NSMutableData data];
+    __block ZXCError error = kZXCErrorCorrupted;
+    [ZXCompressor decompressUsingLZH:4096
+                          readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                              unsigned int bufSize = offset < compressed.length ? (unsigned int)MIN(length, compressed.length - offset) : 0;
+                              memcpy(buffer, (const unsigned char *)compressed.bytes + offset, bufSize);
+                              return bufSize;
+                          } writeBuffer:^(const void *buffer, const unsigned int length) {
+                              [decompressed appendBytes:buffer length:length];
+                          } completion:^(ZXCError errorCode) {
+                              error = errorCode;
+                          }];
+    XCTAssertEqual(error, kZXCErrorNone);
+    XCTAssertEqualObjects(decompressed, data);
+    // the repeated text is matched from the window, not coded again
+    XCTAssertLessThan(compressed.length, data.length / 2);
+}
+
+- (void)testLZHLongDistance {
+    // a 1 MB repeat 3 MB apart, beyond the default window
+    NSData *random = [self sampleDataOfSize:1 << 20 pattern:kSamplePatternRandom seed:7];
+    NSMutableData *data = [random mutableCopy];
+    [data appendData:[self sampleDataOfSize:2 << 20 pattern:kSamplePatternRandom seed:8]];
+    [data appendData:random];
+    __block NSData *near = nil;
+    __block NSData *far = nil;
+    [ZXCompressor compressData:data usingAlgorithm:kZXCAlgorithmLZH completion:^(NSData *data) {
+        near = data;
+    }];
+    [ZXCompressor compressData:data usingAlgorithm:kZXCAlgorithmLZH windowSize:8 << 20 completion:^(NSData *data) {
+        far = data;
+    }];
+    XCTAssertGreaterThan(near.length, data.length);
+    XCTAssertLessThan(far.length, data.length - (1 << 20) + 4096);
+    // the window size is read from the stream
+    XCTAssertEqualObjects([self decompressData:far usingAlgorithm:kZXCAlgorithmLZH], data);
+}
+
+- (void)testLZHThreads {
+    // the segments do not depend on the threads, neither does the output
+    NSMutableData *data = [NSMutableData data];
+    [data appendData:[self sampleDataOfSize:400000 pattern:kSamplePatternText seed:5]];
+    [data appendData:[self sampleDataOfSize:100000 pattern:kSamplePatternRandom seed:6]];
+    NSData *single = [self compressData:data usingLZH:262144 threads:1];
+    for (unsigned int threads = 2; threads <= 8; threads *= 2) {
+        XCTAssertEqualObjects([self compressData:data usingLZH:262144 threads:threads], single, @"%u threads", threads);
+    }
+}
+
+- (void)testAutoAlgorithm {
+    // text, noise, a small alphabet without repeats and zeros
+    NSData *text = [self sampleDataOfSize:300000 pattern:kSamplePatternText seed:1];
+    NSData *random = [self sampleDataOfSize:300000 pattern:kSamplePatternRandom seed:2];
+    NSMutableData *letters = [NSMutableData dataWithLength:300000];
+    unsigned char *bytes = letters.mutableBytes;
+    srand(3);
+    for (NSUInteger i = 0; i < letters.length; i++) {
+        bytes[i] = "etaoinshrdlucmfw"[rand() % 16];
+    }
+    NSMutableData *data = [NSMutableData data];
+    [data appendData:text];
+    [data appendData:random];
+    [data appendData:letters];
+    [data appendData:[NSMutableData dataWithLength:300000]];
+    NSData *compressed = [self compressData:data usingAlgorithm:kZXCAlgorithmAuto];
+    XCTAssertEqualObjects([self decompressData:compressed usingAlgorithm:kZXCAlgorithmAuto], data);
+    // the letters are coded as literals alone (4 bits), the noise is stored
+    NSData *textOnly = [self compressData:text usingAlgorithm:kZXCAlgorithmAuto];
+    XCTAssertLessThan([self compressData:letters usingAlgorithm:kZXCAlgorithmAuto].length, letters.length / 2 + 1024);
+    XCTAssertLessThan([self compressData:random usingAlgorithm:kZXCAlgorithmAuto].length, random.length + 256);
+    // every part costs about what it costs alone, the blocks across two parts cost a little more
+    XCTAssertLessThan(compressed.length, textOnly.length + random.length + letters.length / 2 + 32768);
+    // a blind pick of a dictionary coder expands the noise
+    XCTAssertGreaterThan([self compressData:random usingAlgorithm:kZXCAlgorithmLZ77].length, random.length);
+}
+
+- (NSData *)compressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm options:(ZXCompressorOptions *)options {
+    __block NSData *output = nil;
+    [ZXCompressor compressData:data usingAlgorithm:algorithm options:options completion:^(NSData *data) {
+        output = data;
+    }];
+    return output;
+}
+
+- (NSData *)decompressData:(NSData *)data usingAlgorithm:(ZXCAlgorithm)algorithm options:(ZXCompressorOptions *)options {
+    __block NSData *output = nil;
+    [ZXCompressor decompressData:data usingAlgorithm:algorithm options:options completion:^(NSData *data) {
+        output = data;
+    }];
+    return output;
+}
+
+- (void)testCompressorOptions {
+    NSMutableData *data = [[self sampleDataOfSize:600000 pattern:kSamplePatternText seed:1] mutableCopy];
+    [data appendData:[self sampleDataOfSize:50000 pattern:kSamplePatternRandom seed:2]];
+    // the levels are clamped, the default level is the output of the methods without options
+    XCTAssertEqual([ZXCompressorOptions optionsWithLevel:0].level, kZXCLevelFastest);
+    XCTAssertEqual([ZXCompressorOptions optionsWithLevel:100].level, kZXCLevelSmallest);
+    XCTAssertEqual([ZXCompressorOptions options].level, kZXCLevelDefault);
+    NSData *plain = [self compressData:data usingAlgorithm:kZXCAlgorithmLZH];
+    XCTAssertEqualObjects([self compressData:data usingAlgorithm:kZXCAlgorithmLZH options:[ZXCompressorOptions optionsWithLevel:kZXCLevelDefault]], plain);
+    XCTAssertEqualObjects([self compressData:data usingAlgorithm:kZXCAlgorithmLZH options:nil], plain);
+    // every level is read back without options, a higher level is slower and smaller
+    NSMutableArray<NSNumber *> *sizes = [NSMutableArray array];
+    for (int level = kZXCLevelFastest; level <= kZXCLevelSmallest; level++) {
+        NSData *compressed = [self compressData:data usingAlgorithm:kZXCAlgorithmLZH options:[ZXCompressorOptions optionsWithLevel:level]];
+        XCTAssertEqualObjects([self decompressData:compressed usingAlgorithm:kZXCAlgorithmLZH], data, @"level %d", level);
+        [sizes addObject:@(compressed.length)];
+    }
+    XCTAssertLessThan(plain.length, sizes[kZXCLevelFastest - 1].unsignedIntegerValue);
+    XCTAssertLessThan(sizes[kZXCLevelSmallest - 1].unsignedIntegerValue, plain.length);
+    // an override after the level, the threads do not change the output
+    ZXCompressorOptions *options = [ZXCompressorOptions optionsWithLevel:kZXCLevelFastest];
+    options.depth = 16;
+    XCTAssertEqualObjects([self compressData:data usingAlgorithm:kZXCAlgorithmLZH options:options], plain);
+    options.threads = 1;
+    XCTAssertEqualObjects([self compressData:data usingAlgorithm:kZXCAlgorithmLZH options:options], plain);
+    ZXCompressorOptions *copy = [options copy];
+    XCTAssertEqual(copy.level, options.level);
+    XCTAssertEqual(copy.depth, options.depth);
+    XCTAssertEqual(copy.threads, options.threads);
+    // the block size and the dictionary policy are needed by the decompressor
+    ZXCompressorOptions *format = [ZXCompressorOptions options];
+    format.blockSize = 262144;
+    format.dictionaryPolicy = kZXCDictionaryPolicyMonitor;
+    for (NSNumber *number in @[@(kZXCAlgorithmLZ78), @(kZXCAlgorithmLZW), @(kZXCAlgorithmHuffman), @(kZXCAlgorithmFSE), @(kZXCAlgorithmLZH)]) {
+        ZXCAlgorithm algorithm = (ZXCAlgorithm)number.intValue;
+        NSData *compressed = [self compressData:data usingAlgorithm:algorithm options:format];
+        XCTAssertEqualObjects([self decompressData:compressed usingAlgorithm:algorithm options:format], data, @"[%@]", [self nameOfAlgorithm:algorithm]);
+    }
+    XCTAssertNil([self decompressData:[self compressData:data usingAlgorithm:kZXCAlgorithmLZH options:format] usingAlgorithm:kZXCAlgorithmLZH]);
+}
+
+- (void)testCompressorOptionsSizes {
+    NSData *data = [self sampleDataOfSize:200000 pattern:kSamplePatternText seed:4];
+    // the block size is clamped, a block size of 0 does not drop the input
+    ZXCompressorOptions *options = [ZXCompressorOptions options];
+    options.blockSize = 0;
+    XCTAssertEqual(options.blockSize, kZXCBlockSizeMin);
+    options.blockSize = UINT_MAX;
+    XCTAssertEqual(options.blockSize, kZXCBlockSizeMax);
+    options.blockSize = 0;
+    for (NSNumber *number in @[@(kZXCAlgorithmHuffman), @(kZXCAlgorithmFSE), @(kZXCAlgorithmLZH)]) {
+        ZXCAlgorithm algorithm = (ZXCAlgorithm)number.intValue;
+        NSData *compressed = [self compressData:data usingAlgorithm:algorithm options:options];
+        XCTAssertEqualObjects([self decompressData:compressed usingAlgorithm:algorithm options:options], data, @"[%@]", [self nameOfAlgorithm:algorithm]);
+    }
+    // the coders reject a block size out of range, nothing is written
+    NSMutableData *compressed = [NSMutableData data];
+    [ZXCompressor compressUsingLZH:0 windowSize:65536 depth:16 threads:0 readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+        unsigned int bufSize = offset < data.length ? (unsigned int)MIN(length, data.length - offset) : 0;
+        memcpy(buffer, (const unsigned char *)data.bytes + offset, bufSize);
+        return bufSize;
+    } writeBuffer:^(const void *buffer, const unsigned int length) {
+        [compressed appendBytes:buffer length:length];
+    } completion:nil];
+    XCTAssertEqual(compressed.length, 0);
+    __block ZXCError error = kZXCErrorNone;
+    [ZXCompressor decompressUsingLZH:0 readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+        return 0;
+    } writeBuffer:nil completion:^(ZXCError errorCode) {
+        error = errorCode;
+    }];
+    XCTAssertEqual(error, kZXCErrorCorrupted);
+    // the LZ77/LZSS/LZ78/LZW sizes follow the level, levels 1 ~ 5 keep the output of the methods without options
+    for (NSNumber *number in @[@(kZXCAlgorithmLZ77), @(kZXCAlgorithmLZSS), @(kZXCAlgorithmLZ78), @(kZXCAlgorithmLZW)]) {
+        ZXCAlgorithm algorithm = (ZXCAlgorithm)number.intValue;
+        NSString *name = [self nameOfAlgorithm:algorithm];
+        NSData *plain = [self compressData:data usingAlgorithm:algorithm];
+        XCTAssertEqualObjects([self compressData:data usingAlgorithm:algorithm options:[ZXCompressorOptions optionsWithLevel:kZXCLevelFastest]], plain, @"[%@]", name);
+        ZXCompressorOptions *smallest = [ZXCompressorOptions optionsWithLevel:kZXCLevelSmallest];
+        NSData *small = [self compressData:data usingAlgorithm:algorithm options:smallest];
+        XCTAssertEqualObjects([self decompressData:small usingAlgorithm:algorithm options:smallest], data, @"[%@]", name);
+        XCTAssertLessThanOrEqual(small.length, plain.length, @"[%@]", name);
+    }
+    // the sizes are clamped, the buffer is not larger than the window when used
+    options.lz77WindowSize = 0;
+    options.lz77BufferSize = UINT_MAX;
+    options.lzssWindowSize = 64;
+    options.lzssBufferSize = 4096;
+    options.dictionarySize = 0;
+    XCTAssertEqual(options.lz77WindowSize, 16);
+    XCTAssertEqual(options.lz77BufferSize, 65536);
+    XCTAssertEqual(options.dictionarySize, 4096);
+    ZXCompressorOptions *copy = [options copy];
+    XCTAssertEqual(copy.lzssBufferSize, options.lzssBufferSize);
+    for (NSNumber *number in @[@(kZXCAlgorithmLZ77), @(kZXCAlgorithmLZSS), @(kZXCAlgorithmLZ78), @(kZXCAlgorithmLZW)]) {
+        ZXCAlgorithm algorithm = (ZXCAlgorithm)number.intValue;
+        NSData *compressed = [self compressData:data usingAlgorithm:algorithm options:options];
+        XCTAssertEqualObjects([self decompressData:compressed usingAlgorithm:algorithm options:options], data, @"[%@]", [self nameOfAlgorithm:algorithm]);
+    }
+}
+
+- (void)testCompressorOptionsAPIs {
+    NSString *directory = NSTemporaryDirectory();
+    NSString *source = [directory stringByAppendingPathComponent:@"zxc_options.bin"];
+    NSString *target = [source stringByAppendingPathExtension:@"zxc"];
+    NSString *restored = [source stringByAppendingPathExtension:@"out"];
+    NSData *data = [self sampleDataOfSize:400000 pattern:kSamplePatternText seed:3];
+    XCTAssertTrue([data writeToFile:source atomically:YES]);
+    ZXCompressorOptions *options = [ZXCompressorOptions optionsWithLevel:kZXCLevelSmallest];
+    options.blockSize = 65536;
+    NSData *compressed = [self compressData:data usingAlgorithm:kZXCAlgorithmLZH options:options];
+    // file
+    __block NSError *error = nil;
+    [ZXCompressor compressFileAtPath:source toPath:target usingAlgorithm:kZXCAlgorithmLZH options:options completion:^(NSError *e) {
+        error = e;
+    }];
+    XCTAssertNil(error, @"%@", error.localizedDescription);
+    XCTAssertEqualObjects([NSData dataWithContentsOfFile:target], compressed);
+    [ZXCompressor decompressFileAtPath:target toPath:restored usingAlgorithm:kZXCAlgorithmLZH options:options completion:^(NSError *e) {
+        error = e;
+    }];
+    XCTAssertNil(error, @"%@", error.localizedDescription);
+    XCTAssertEqualObjects([NSData dataWithContentsOfFile:restored], data);
+    // seekable
+    [ZXCompressor compressSeekableFileAtPath:source toPath:target usingAlgorithm:kZXCAlgorithmLZH blockSize:100000 options:options completion:^(NSError *e) {
+        error = e;
+    }];
+    XCTAssertNil(error, @"%@", error.localizedDescription);
+    [ZXCompressor decompressRange:NSMakeRange(90000, 200000) ofSeekableFileAtPath:target options:options completion:^(NSData *d, NSError *e) {
+        XCTAssertEqualObjects(d, [data subdataWithRange:NSMakeRange(90000, 200000)]);
+        error = e;
+    }];
+    XCTAssertNil(error, @"%@", error.localizedDescription);
+    // stream, the same blocks as compressData
+    NSMutableData *streamed = [NSMutableData data];
+    ZXCStreamCompressor *compressor = [[ZXCStreamCompressor alloc] initWithOptions:options writeBuffer:^(const void *buffer, const unsigned int length) {
+        [streamed appendBytes:buffer length:length];
+    }];
+    [compressor updateWithData:data];
+    [compressor finish];
+    XCTAssertEqualObjects(streamed, compressed);
+    NSMutableData *output = [NSMutableData data];
+    ZXCStreamDecompressor *decompressor = [[ZXCStreamDecompressor alloc] initWithOptions:options writeBuffer:^(const void *buffer, const unsigned int length) {
+        [output appendBytes:buffer length:length];
+    }];
+    XCTAssertEqual([decompressor updateWithData:streamed], kZXCErrorNone);
+    XCTAssertEqual([decompressor finish], kZXCErrorNone);
+    XCTAssertEqualObjects(output, data);
+    // chunk store, the options are copied
+    NSString *storePath = [directory stringByAppendingPathComponent:@"zxc_options_chunks"];
+    [[NSFileManager defaultManager] removeItemAtPath:storePath error:nil];
+    ZXCChunkStore *store = [[ZXCChunkStore alloc] initWithPath:storePath algorithm:kZXCAlgorithmLZW options:options];
+    options.dictionaryPolicy = kZXCDictionaryPolicyMonitor;
+    XCTAssertEqual(store.options.dictionaryPolicy, kZXCDictionaryPolicyReset);
+    [ZXCompressor compressFileAtPath:source toPath:target chunkStore:store completion:^(NSError *e) {
+        error = e;
+    }];
+    XCTAssertNil(error, @"%@", error.localizedDescription);
+    [ZXCompressor decompressFileAtPath:target toPath:restored chunkStore:store completion:^(NSError *e) {
+        error = e;
+    }];
+    XCTAssertNil(error, @"%@", error.localizedDescription);
+    XCTAssertEqualObjects([NSData dataWithContentsOfFile:restored], data);
+    [[NSFileManager defaultManager] removeItemAtPath:storePath error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:source error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:target error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:restored error:nil];
+}
+
+- (void)testSegmentedDictionaryCoders {
+    NSMutableData *data = [NSMutableData data];
+    [data appendData:[self sampleDataOfSize:300000 pattern:kSamplePatternText seed:1]];
+    [data appendData:[self sampleDataOfSize:50000 pattern:kSamplePatternRandom seed:2]];
+    for (NSNumber *number in @[@(kZXCAlgorithmLZ78), @(kZXCAlgorithmLZW)]) {
+        ZXCAlgorithm algorithm = (ZXCAlgorithm)number.intValue;
+        NSString *name = [self nameOfAlgorithm:algorithm];
+        // the segments do not depend on the threads, neither does the output
+        NSData *single = [self compressData:data usingSegments:algorithm segmentSize:65536 threads:1];
+        for (unsigned int threads = 2; threads <= 8; threads *= 2) {
+            XCTAssertEqualObjects([self compressData:data usingSegments:algorithm segmentSize:65536 threads:threads], single, @"[%@] %u threads", name, threads);
+        }
+        ZXCError error;
+        for (unsigned int threads = 1; threads <= 8; threads *= 2) {
+            XCTAssertEqualObjects([self decompressData:single usingSegments:algorithm threads:threads error:&error], data, @"[%@] %u threads", name, threads);
+        }
+        // a segment size multiple, empty data
+        NSData *even = [data subdataWithRange:NSMakeRange(0, 4 * 65536)];
+        XCTAssertEqualObjects([self decompressData:[self compressData:even usingSegments:algorithm segmentSize:65536 threads:0] usingSegments:algorithm threads:0 error:&error], even, @"[%@]", name);
+        XCTAssertEqualObjects([self decompressData:[self compressData:[NSData data] usingSegments:algorithm segmentSize:0 threads:0] usingSegments:algorithm threads:0 error:&error], [NSData data], @"[%@]", name);
+        // truncated in a segment, missing the end of stream
+        XCTAssertNil([self decompressData:[single subdataWithRange:NSMakeRange(0, single.length / 2)] usingSegments:algorithm threads:0 error:&error], @"[%@]", name);
+        XCTAssertEqual(error, kZXCErrorTruncated, @"[%@]", name);
+        XCTAssertNil([self decompressData:[single subdataWithRange:NSMakeRange(0, single.length - 4)] usingSegments:algorithm threads:0 error:&error], @"[%@]", name);
+        XCTAssertEqual(error, kZXCErrorTruncated, @"[%@]", name);
+        // the header names the algorithm
+        ZXCAlgorithm other = algorithm == kZXCAlgorithmLZW ? kZXCAlgorithmLZ78 : kZXCAlgorithmLZW;
+        XCTAssertNil([self decompressData:single usingSegments:other threads:0 error:&error], @"[%@]", name);
+        XCTAssertEqual(error, kZXCErrorCorrupted, @"[%@]", name);
+    }
+}
+
+- (void)testSegmentedCoderFailure {
+    NSData *data = [self sampleDataOfSize:10 * 4096 + 100 pattern:kSamplePatternText seed:1];
+    for (unsigned int threads = 1; threads <= 4; threads *= 2) {
+        NSMutableData *compressed = [NSMutableData data];
+        __block int segments = 0;
+        __block ZXCError error = kZXCErrorNone;
+        // the 6th segment fails to encode, its batch and the end mark are not written
+        [ZXCompressor compressSegmentsUsing:kZXCAlgorithmLZW segmentSize:4096 threads:threads readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+            unsigned int bufSize = offset < data.length ? (unsigned int)MIN(length, data.length - offset) : 0;
+            memcpy(buffer, (const unsigned char *)data.bytes + offset, bufSize);
+            return bufSize;
+        } writeBuffer:^(const void *buffer, const unsigned int length) {
+            [compressed appendBytes:buffer length:length];
+        } coder:^ZXCError(const unsigned int (^segmentRead)(void *, const unsigned int, const unsigned long long), void (^segmentWrite)(const void *, const unsigned int)) {
+            unsigned char head[64];
+            segmentRead(head, sizeof(head), 0);
+            segmentWrite(head, 1);
+            @synchronized (data) {
+                segments++;
+            }
+            return memcmp(head, (const unsigned char *)data.bytes + 5 * 4096, sizeof(head)) == 0 ? kZXCErrorCompressFailed : kZXCErrorNone;
+        } completion:^(ZXCError errorCode) {
+            error = errorCode;
+        }];
+        XCTAssertEqual(error, kZXCErrorCompressFailed, @"%u threads", threads);
+        // header (6 bytes) + the batches before the failed one, 5 bytes per segment
+        XCTAssertEqual(compressed.length % 5, 1, @"%u threads", threads);
+        XCTAssertLessThanOrEqual(compressed.length, 6 + 5 * 5, @"%u threads", threads);
+        XCTAssertLessThanOrEqual(segments, 6 + (int)threads, @"%u threads", threads);
+        ZXCError decodeError;
+        XCTAssertNil([self decompressData:compressed usingSegments:kZXCAlgorithmLZW threads:0 error:&decodeError], @"%u threads", threads);
+    }
+}
+
+- (void)testDictionaryPolicy {
+    // text, noise, text again: a kept dictionary has to be dropped after the noise
+    NSMutableData *data = [NSMutableData data];
+    [data appendData:[self sampleDataOfSize:200000 pattern:kSamplePatternText seed:1]];
+    [data appendData:[self sampleDataOfSize:50000 pattern:kSamplePatternRandom seed:2]];
+    [data appendData:[self sampleDataOfSize:200000 pattern:kSamplePatternText seed:3]];
+    ZXCDictionary *dictionary = [ZXCDictionary dictionaryWithSamples:[self dictionarySamples] size:4096];
+    for (NSNumber *number in @[@(kZXCAlgorithmLZ78), @(kZXCAlgorithmLZW)]) {
+        ZXCAlgorithm algorithm = (ZXCAlgorithm)number.intValue;
+        NSString *name = [self nameOfAlgorithm:algorithm];
+        // the small table fills up many times
+        for (NSNumber *size in @[@4096, @65536]) {
+            unsigned int tableSize = size.unsignedIntValue;
+            for (int primed = 0; primed < 2; primed++) {
+                ZXCDictionary *d = primed ? dictionary : nil;
+                NSData *reset = [self compressData:data usingDictionaryCoder:algorithm tableSize:tableSize dictionary:d policy:kZXCDictionaryPolicyReset];
+                NSData *monitor = [self compressData:data usingDictionaryCoder:algorithm tableSize:tableSize dictionary:d policy:kZXCDictionaryPolicyMonitor];
+                XCTAssertEqualObjects([self decompressData:reset usingDictionaryCoder:algorithm tableSize:tableSize dictionary:d policy:kZXCDictionaryPolicyReset], data, @"[%@] %u reset", name, tableSize);
+                XCTAssertEqualObjects([self decompressData:monitor usingDictionaryCoder:algorithm tableSize:tableSize dictionary:d policy:kZXCDictionaryPolicyMonitor], data, @"[%@] %u monitor", name, tableSize);
+                NSLog(@"[%@] %u codes%@: %d bytes, reset %d bytes, monitor %d bytes", name, tableSize, d ? @" with dictionary" : @"", (int)data.length, (int)reset.length, (int)monitor.length);
+            }
+            // the reset policy is the original format
+            NSData *original = [self compressData:data usingDictionaryCoder:algorithm tableSize:tableSize dictionary:nil policy:kZXCDictionaryPolicyReset];
+            NSMutableData *compressed = [NSMutableData data];
+            const unsigned int (^readBuffer)(void *, const unsigned int, const unsigned long long) = ^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                unsigned int bufSize = offset < data.length ? (unsigned int)MIN(length, data.length - offset) : 0;
+                memcpy(buffer, (const unsigned char *)data.bytes + offset, bufSize);
+                return bufSize;
+            };
+            void (^writeBuffer)(const void *, const unsigned int) = ^(const void *buffer, const unsigned int length) {
+                [compressed appendBytes:buffer length:length];
+            };
+            if (algorithm == kZXCAlgorithmLZ78) {
+                [ZXCompressor compressUsingLZ78:tableSize dictionary:nil readBuffer:readBuffer writeBuffer:writeBuffer completion:nil];
+            } else {
+                [ZXCompressor compressUsingLZW:tableSize dictionary:nil readBuffer:readBuffer writeBuffer:writeBuffer completion:nil];
+            }
+            XCTAssertEqualObjects(compressed, original, @"[%@] %u", name, tableSize);
+        }
+    }
+}
+
+- (void)testRoundTripHuffmanBlocks {
+    // blocks of different statistics: new tables, repeated tables and raw blocks
+    NSMutableData *data = [NSMutableData data];
+    [data appendData:[self sampleDataOfSize:300000 pattern:kSamplePatternText seed:1]];
+    [data appendData:[self sampleDataOfSize:200000 pattern:kSamplePatternRandom seed:2]];
+    [data appendData:[self sampleDataOfSize:200000 pattern:kSamplePatternZero seed:3]];
+    [data appendData:[self sampleDataOfSize:300000 pattern:kSamplePatternText seed:4]];
+    [self assertRoundTrip:data usingAlgorithm:kZXCAlgorithmHuffman];
+    // a block size multiple
+    [self assertRoundTrip:[self sampleDataOfSize:4 << 17 pattern:kSamplePatternText seed:5] usingAlgorithm:kZXCAlgorithmHuffman];
+}
+
+- (void)testRoundTripHuffmanFormats {
+    NSData *data = [self sampleDataOfSize:300000 pattern:kSamplePatternText seed:6];
+    const unsigned char *input = data.bytes;
+    const unsigned long long inputSize = data.length;
+    // format 1 and 2 (4 streams), with and without table reuse
+    for (unsigned int streams = 1; streams <= 4; streams += 3) {
+        for (int reuse = 0; reuse < 2; reuse++) {
+            NSMutableData *compressed = [NSMutableData data];
+            NSMutableData *decompressed = [NSMutableData data];
+            __block ZXCError error = kZXCErrorCorrupted;
+            [ZXCompressor compressUsingHuffmanBlock:65536 reuseTable:reuse streams:streams readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                unsigned int bufSize = offset < inputSize ? (unsigned int)MIN(length, inputSize - offset) : 0;
+                memcpy(buffer, &input[offset], bufSize);
+                return bufSize;
+            } writeBuffer:^(const void *buffer, const unsigned int length) {
+                [compressed appendBytes:buffer length:length];
+            } completion:nil];
+            [ZXCompressor decompressUsingHuffmanBlock:65536 readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                unsigned int bufSize = offset < compressed.length ? (unsigned int)MIN(length, compressed.length - offset) : 0;
+                memcpy(buffer, &((const unsigned char *)compressed.bytes)[offset], bufSize);
+                return bufSize;
+            } writeBuffer:^(const void *buffer, const unsigned int length) {
+                [decompressed appendBytes:buffer length:length];
+            } completion:^(ZXCError errorCode) {
+                error = errorCode;
+            }];
+            XCTAssertEqual(error, kZXCErrorNone, @"streams %u, reuse %d", streams, reuse);
+            XCTAssertEqualObjects(decompressed, data, @"streams %u, reuse %d", streams, reuse);
+        }
+    }
+}
+
+- (void)testRoundTripFile {
+    NSString *directory = NSTemporaryDirectory();
+    NSData *data = [self sampleDataOfSize:100000 pattern:kSamplePatternText seed:1];
+    NSString *source = [directory stringByAppendingPathComponent:@"zxc_source.bin"];
+    XCTAssertTrue([data writeToFile:source atomically:YES]);
+    for (NSNumber *number in [self implementedAlgorithms]) {
+        ZXCAlgorithm algorithm = (ZXCAlgorithm)number.intValue;
+        NSString *name = [self nameOfAlgorithm:algorithm];
+        NSString *file1 = [directory stringByAppendingPathComponent:[NSString stringWithFormat:@"zxc_%@+.bin", name]];
+        NSString *file2 = [directory stringByAppendingPathComponent:[NSString stringWithFormat:@"zxc_%@-.bin", name]];
+        __block NSError *error = nil;
+        [ZXCompressor compressFileAtPath:source toPath:file1 usingAlgorithm:algorithm completion:^(NSError *e) {
+            error = e;
+        }];
+        XCTAssertNil(error, @"[%@] %@", name, error.localizedDescription);
+        [ZXCompressor decompressFileAtPath:file1 toPath:file2 usingAlgorithm:algorithm completion:^(NSError *e) {
+            error = e;
+        }];
+        XCTAssertNil(error, @"[%@] %@", name, error.localizedDescription);
+        XCTAssertTrue([[NSData dataWithContentsOfFile:file2] isEqualToData:data], @"[%@] file round trip", name);
+        [[NSFileManager defaultManager] removeItemAtPath:file1 error:nil];
+        [[NSFileManager defaultManager] removeItemAtPath:file2 error:nil];
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:source error:nil];
+}
+
+- (NSUInteger)numberOfFilesAtPath:(NSString *)path {
+    NSUInteger count = 0;
+    NSDirectoryEnumerator *enumerator = [[NSFileManager defaultManager] enumeratorAtPath:path];
+    while ([enumerator nextObject]) {
+        count += [enumerator.fileAttributes.fileType isEqualToString:NSFileTypeRegular];
+    }
+    return count;
+}
+
+- (void)testChunkStore {
+    NSString *directory = NSTemporaryDirectory();
+    NSString *storePath = [directory stringByAppendingPathComponent:@"zxc_chunks"];
+    [[NSFileManager defaultManager] removeItemAtPath:storePath error:nil];
+    ZXCChunkStore *store = [[ZXCChunkStore alloc] initWithPath:storePath];
+    // the second version: 100 bytes inserted in the middle
+    NSData *data1 = [self sampleDataOfSize:1 << 20 pattern:kSamplePatternRandom seed:9];
+    NSMutableData *data2 = [[data1 subdataWithRange:NSMakeRange(0, 500000)] mutableCopy];
+    [data2 appendData:[self sampleDataOfSize:100 pattern:kSamplePatternText seed:10]];
+    [data2 appendData:[data1 subdataWithRange:NSMakeRange(500000, data1.length - 500000)]];
+    NSArray<NSData *> *versions = @[data1, data2];
+    NSUInteger chunks[2] = {0, 0};
+    for (NSUInteger i = 0; i < versions.count; i++) {
+        NSString *source = [directory stringByAppendingPathComponent:[NSString stringWithFormat:@"zxc_version%lu.bin", (unsigned long)i]];
+        NSString *manifest = [source stringByAppendingPathExtension:@"manifest"];
+        XCTAssertTrue([versions[i] writeToFile:source atomically:YES]);
+        __block NSError *error = nil;
+        [ZXCompressor compressFileAtPath:source toPath:manifest chunkStore:store completion:^(NSError *e) {
+            error = e;
+        }];
+        XCTAssertNil(error, @"%@", error.localizedDescription);
+        chunks[i] = [self numberOfFilesAtPath:storePath];
+        [ZXCompressor decompressFileAtPath:manifest toPath:source chunkStore:store completion:^(NSError *e) {
+            error = e;
+        }];
+        XCTAssertNil(error, @"%@", error.localizedDescription);
+        XCTAssertEqualObjects([NSData dataWithContentsOfFile:source], versions[i]);
+        [[NSFileManager defaultManager] removeItemAtPath:source error:nil];
+    }
+    // 8 KB chunks on average, only the chunks around the insertion are new
+    XCTAssertGreaterThan(chunks[0], 64);
+    XCTAssertLessThanOrEqual(chunks[1] - chunks[0], 3);
+    // a damaged chunk is detected by its digest
+    NSString *manifest = [directory stringByAppendingPathComponent:@"zxc_version0.bin.manifest"];
+    NSData *first = [[NSData dataWithContentsOfFile:manifest] subdataWithRange:NSMakeRange(16, 32)];
+    const unsigned char *bytes = first.bytes;
+    NSMutableString *name = [NSMutableString string];
+    for (NSUInteger i = 0; i < first.length; i++) {
+        [name appendFormat:@"%02x", bytes[i]];
+    }
+    NSString *chunkPath = [[storePath stringByAppendingPathComponent:[name substringToIndex:2]] stringByAppendingPathComponent:name];
+    XCTAssertTrue([store containsChunkWithDigest:first]);
+    NSMutableData *damaged = [[NSData dataWithContentsOfFile:chunkPath] mutableCopy];
+    ((unsigned char *)damaged.mutableBytes)[damaged.length / 2] ^= 0xFF;
+    [damaged writeToFile:chunkPath atomically:YES];
+    __block NSError *error = nil;
+    NSString *target = [directory stringByAppendingPathComponent:@"zxc_damaged.bin"];
+    [ZXCompressor decompressFileAtPath:manifest toPath:target chunkStore:store completion:^(NSError *e) {
+        error = e;
+    }];
+    XCTAssertNotNil(error);
+    [[NSFileManager defaultManager] removeItemAtPath:target error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:manifest error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:[directory stringByAppendingPathComponent:@"zxc_version1.bin.manifest"] error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:storePath error:nil];
+}
+
+- (void)testSeekableRange {
+    NSString *directory = NSTemporaryDirectory();
+    NSString *source = [directory stringByAppendingPathComponent:@"zxc_seekable.bin"];
+    NSString *target = [source stringByAppendingPathExtension:@"zxcs"];
+    NSMutableData *data = [[self sampleDataOfSize:300000 pattern:kSamplePatternText seed:11] mutableCopy];
+    [data appendData:[self sampleDataOfSize:123457 pattern:kSamplePatternRandom seed:12]];
+    XCTAssertTrue([data writeToFile:source atomically:YES]);
+    __block NSError *error = nil;
+    [ZXCompressor compressSeekableFileAtPath:source toPath:target usingAlgorithm:kZXCAlgorithmLZH blockSize:65536 completion:^(NSError *e) {
+        error = e;
+    }];
+    XCTAssertNil(error, @"%@", error.localizedDescription);
+    // inside a block, across blocks, the tail, past the end, empty
+    NSRange ranges[] = {{100, 1000}, {65000, 200000}, {0, data.length}, {400000, 100000}, {data.length + 10, 10}, {5000, 0}};
+    for (NSUInteger i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++) {
+        __block NSData *output = nil;
+        [ZXCompressor decompressRange:ranges[i] ofSeekableFileAtPath:target completion:^(NSData *d, NSError *e) {
+            output = d;
+            error = e;
+        }];
+        XCTAssertNil(error, @"%@", error.localizedDescription);
+        NSRange clipped = NSIntersectionRange(ranges[i], NSMakeRange(0, data.length));
+        XCTAssertEqualObjects(output, clipped.length ? [data subdataWithRange:clipped] : [NSData data]);
+    }
+    // a damaged footer is reported
+    NSMutableData *damaged = [[NSData dataWithContentsOfFile:target] mutableCopy];
+    ((unsigned char *)damaged.mutableBytes)[damaged.length - 8] ^= 0xFF;
+    [damaged writeToFile:target atomically:YES];
+    [ZXCompressor decompressRange:NSMakeRange(0, 10) ofSeekableFileAtPath:target completion:^(NSData *d, NSError *e) {
+        error = e;
+    }];
+    XCTAssertNotNil(error);
+    [[NSFileManager defaultManager] removeItemAtPath:source error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:target error:nil];
+}
+
+- (void)testSeekableTamperedIndex {
+    NSString *directory = NSTemporaryDirectory();
+    NSString *source = [directory stringByAppendingPathComponent:@"zxc_seekable_index.bin"];
+    NSString *target = [source stringByAppendingPathExtension:@"zxcs"];
+    NSData *data = [self sampleDataOfSize:300000 pattern:kSamplePatternText seed:17];
+    XCTAssertTrue([data writeToFile:source atomically:YES]);
+    __block NSError *error = nil;
+    // a block that fails to compress (unsupported algorithm) is reported, no file is left
+    [ZXCompressor compressSeekableFileAtPath:source toPath:target usingAlgorithm:kZXCAlgorithmBWT blockSize:65536 completion:^(NSError *e) {
+        error = e;
+    }];
+    XCTAssertEqualObjects(error.domain, ZXCompressorErrorDomain);
+    XCTAssertEqual(error.code, kZXCErrorCompressFailed);
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:target]);
+    error = nil;
+    [ZXCompressor compressSeekableFileAtPath:source toPath:target usingAlgorithm:kZXCAlgorithmLZH blockSize:65536 completion:^(NSError *e) {
+        error = e;
+    }];
+    XCTAssertNil(error, @"%@", error.localizedDescription);
+    NSData *seekable = [NSData dataWithContentsOfFile:target];
+    // 5 blocks, the index (uncompressed offset, compressed offset per block) before the 16-byte footer
+    const NSUInteger blocks = 5, indexOffset = seekable.length - 16 - blocks * 16;
+    void (^setEntry)(NSMutableData *, NSUInteger, NSUInteger, unsigned long long) = ^(NSMutableData *file, NSUInteger block, NSUInteger field, unsigned long long value) {
+        unsigned long long value_n = NSSwapHostLongLongToBig(value);
+        [file replaceBytesInRange:NSMakeRange(indexOffset + block * 16 + field * 8, 8) withBytes:&value_n];
+    };
+    // an uncompressed offset past the next one (past the range), past the end, not from 0; a compressed offset going back, past the index
+    NSArray<NSArray<NSNumber *> *> *tampers = @[@[@2, @0, @250000], @[@4, @0, @400000], @[@0, @0, @10], @[@3, @1, @5], @[@1, @1, @(seekable.length)]];
+    for (NSArray<NSNumber *> *tamper in tampers) {
+        NSMutableData *file = [seekable mutableCopy];
+        setEntry(file, tamper[0].unsignedIntegerValue, tamper[1].unsignedIntegerValue, tamper[2].unsignedLongLongValue);
+        XCTAssertTrue([file writeToFile:target atomically:YES]);
+        __block NSData *output = nil;
+        error = nil;
+        [ZXCompressor decompressRange:NSMakeRange(100000, 50000) ofSeekableFileAtPath:target completion:^(NSData *d, NSError *e) {
+            output = d;
+            error = e;
+        }];
+        XCTAssertNil(output, @"%@", tamper);
+        XCTAssertEqual(error.code, kZXCErrorCorrupted, @"%@", tamper);
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:source error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:target error:nil];
+}
+
+- (void)testStream {
+    NSMutableData *data = [[self sampleDataOfSize:400000 pattern:kSamplePatternText seed:13] mutableCopy];
+    [data appendData:[self sampleDataOfSize:50000 pattern:kSamplePatternRandom seed:14]];
+    NSMutableData *compressed = [NSMutableData data];
+    ZXCStreamCompressor *compressor = [[ZXCStreamCompressor alloc] initWithWriteBuffer:^(const void *buffer, const unsigned int length) {
+        [compressed appendBytes:buffer length:length];
+    }];
+    // pieces of any size, a flush writes the pending input at once
+    srand(15);
+    for (NSUInteger offset = 0; offset < data.length; ) {
+        NSUInteger length = MIN((NSUInteger)(rand() % 20000 + 1), data.length - offset);
+        [compressor updateWithBytes:(const unsigned char *)data.bytes + offset length:length];
+        offset += length;
+        // 128 KB blocks, nothing is pending at a block boundary
+        if (rand() % 4 == 0 && offset % 131072 != 0) {
+            NSUInteger before = compressed.length;
+            [compressor flush];
+            XCTAssertGreaterThan(compressed.length, before);
+        }
+    }
+    [compressor finish];
+    XCTAssertLessThan(compressed.length, data.length);
+    // the stream is a kZXCAlgorithmLZH stream
+    [ZXCompressor decompressData:compressed usingAlgorithm:kZXCAlgorithmLZH completion:^(NSData *output) {
+        XCTAssertEqualObjects(output, data);
+    }];
+    // pushed in small pieces
+    NSMutableData *output = [NSMutableData data];
+    ZXCStreamDecompressor *decompressor = [[ZXCStreamDecompressor alloc] initWithWriteBuffer:^(const void *buffer, const unsigned int length) {
+        [output appendBytes:buffer length:length];
+    }];
+    for (NSUInteger offset = 0; offset < compressed.length; ) {
+        NSUInteger length = MIN((NSUInteger)(rand() % 3000 + 1), compressed.length - offset);
+        XCTAssertEqual([decompressor updateWithBytes:(const unsigned char *)compressed.bytes + offset length:length], kZXCErrorNone);
+        offset += length;
+    }
+    XCTAssertEqual([decompressor finish], kZXCErrorNone);
+    XCTAssertTrue(decompressor.isFinished);
+    XCTAssertEqualObjects(output, data);
+    // the end of the stream is missing
+    ZXCStreamDecompressor *truncated = [[ZXCStreamDecompressor alloc] initWithWriteBuffer:nil];
+    XCTAssertEqual([truncated updateWithData:[compressed subdataWithRange:NSMakeRange(0, compressed.length - 1)]], kZXCErrorNone);
+    XCTAssertEqual([truncated finish], kZXCErrorTruncated);
+}
+
+- (void)testStreamSyncFlush {
+    // small messages of a feed, each flushed at once, decoded as soon as its bytes arrive
+    NSData *feed = [self sampleDataOfSize:60000 pattern:kSamplePatternText seed:16];
+    NSMutableData *compressed = [NSMutableData data];
+    ZXCStreamCompressor *compressor = [[ZXCStreamCompressor alloc] initWithWriteBuffer:^(const void *buffer, const unsigned int length) {
+        [compressed appendBytes:buffer length:length];
+    }];
+    NSMutableData *output = [NSMutableData data];
+    ZXCStreamDecompressor *decompressor = [[ZXCStreamDecompressor alloc] initWithWriteBuffer:^(const void *buffer, const unsigned int length) {
+        [output appendBytes:buffer length:length];
+    }];
+    __block NSUInteger independent = 0;
+    const NSUInteger messageSize = 300;
+    for (NSUInteger offset = 0; offset < feed.length; offset += messageSize) {
+        NSData *message = [feed subdataWithRange:NSMakeRange(offset, MIN(messageSize, feed.length - offset))];
+        [ZXCompressor compressData:message usingAlgorithm:kZXCAlgorithmLZH completion:^(NSData *data) {
+            independent += data.length;
+        }];
+        NSUInteger sent = compressed.length;
+        [compressor updateWithData:message];
+        [compressor flush];
+        XCTAssertEqual([decompressor updateWithData:[compressed subdataWithRange:NSMakeRange(sent, compressed.length - sent)]], kZXCErrorNone);
+        XCTAssertEqual(output.length, offset + message.length);
+    }
+    [compressor finish];
+    XCTAssertEqualObjects(output, feed);
+    // the shared window and the repeated tables beat compressing the messages one by one
+    XCTAssertLessThan(compressed.length, independent);
+}
+
+- (void)testStreamSyncFlushStoredBlocks {
+    // random and low-entropy messages of 100 ~ 400 bytes, a flushed block not smaller than its bytes is stored raw,
+    // the tables of a stored block must not be reused by the next blocks
+    for (unsigned int seed = 0; seed < 60; seed++) {
+        // messages around 100, 200, 300 or 400 bytes
+        unsigned int band = seed / 2 % 4;
+        NSMutableData *feed = [NSMutableData dataWithLength:40000];
+        unsigned char *bytes = feed.mutableBytes;
+        srand(seed);
+        for (NSUInteger i = 0; i < feed.length; i++) {
+            bytes[i] = seed % 2 ? (unsigned char)rand() : (unsigned char)"etaoinshrdlu"[rand() % 12];
+        }
+        NSMutableData *compressed = [NSMutableData data];
+        ZXCStreamCompressor *compressor = [[ZXCStreamCompressor alloc] initWithWriteBuffer:^(const void *buffer, const unsigned int length) {
+            [compressed appendBytes:buffer length:length];
+        }];
+        NSMutableData *output = [NSMutableData data];
+        ZXCStreamDecompressor *decompressor = [[ZXCStreamDecompressor alloc] initWithWriteBuffer:^(const void *buffer, const unsigned int length) {
+            [output appendBytes:buffer length:length];
+        }];
+        for (NSUInteger offset = 0; offset < feed.length; ) {
+            NSUInteger length = MIN((NSUInteger)(100 + band * 100 + rand() % 51 - (band ? 50 : 0)), feed.length - offset);
+            NSUInteger sent = compressed.length;
+            [compressor updateWithBytes:&bytes[offset] length:length];
+            [compressor flush];
+            offset += length;
+            XCTAssertEqual([decompressor updateWithData:[compressed subdataWithRange:NSMakeRange(sent, compressed.length - sent)]], kZXCErrorNone, @"seed %u", seed);
+            XCTAssertEqual(output.length, offset, @"seed %u", seed);
+        }
+        NSUInteger sent = compressed.length;
+        [compressor finish];
+        XCTAssertEqual([decompressor updateWithData:[compressed subdataWithRange:NSMakeRange(sent, compressed.length - sent)]], kZXCErrorNone, @"seed %u", seed);
+        XCTAssertEqual([decompressor finish], kZXCErrorNone, @"seed %u", seed);
+        XCTAssertEqualObjects(output, feed, @"seed %u", seed);
+    }
+}
+
+// Dictionary coders allocate from a per-call arena, concurrent calls must not share any state
+- (void)testConcurrentDictionaryCoders {
+    const ZXCAlgorithm algorithms[] = {kZXCAlgorithmLZ78, kZXCAlgorithmLZW, kZXCAlgorithmHuffman};
+    const size_t jobs = 12;
+    NSMutableArray<NSData *> *inputs = [NSMutableArray array];
+    for (size_t i = 0; i < jobs; i++) {
+        [inputs addObject:[self sampleDataOfSize:(256 << 10) + i pattern:(SamplePattern)(i % kSamplePatternCount) seed:(unsigned int)i]];
+    }
+    BOOL *matched = calloc(jobs, sizeof(BOOL));
+    dispatch_apply(jobs, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        const ZXCAlgorithm algorithm = algorithms[i % 3];
+        NSData *decompressed = [self decompressData:[self compressData:inputs[i] usingAlgorithm:algorithm] usingAlgorithm:algorithm];
+        matched[i] = [decompressed isEqualToData:inputs[i]];
+    });
+    for (size_t i = 0; i < jobs; i++) {
+        XCTAssertTrue(matched[i], @"[%@] job %d", [self nameOfAlgorithm:algorithms[i % 3]], (int)i);
+    }
+    free(matched);
+}
+
+// Streams a file larger than 4 GB through the 64-bit file API, it takes minutes, set ZXC_LARGE_FILE_TEST=1 to run it
+- (void)testRoundTripLargeFile {
+    if (![[NSProcessInfo processInfo].environment[@"ZXC_LARGE_FILE_TEST"] boolValue]) {
+        return;
+    }
+    NSString *directory = NSTemporaryDirectory();
+    NSString *source = [directory stringByAppendingPathComponent:@"zxc_large.bin"];
+    NSString *file1 = [directory stringByAppendingPathComponent:@"zxc_large+.bin"];
+    NSString *file2 = [directory stringByAppendingPathComponent:@"zxc_large-.bin"];
+    NSData *chunk = [self sampleDataOfSize:1 << 20 pattern:kSamplePatternText seed:0];
+    const unsigned long long chunks = 4097; // 4 GB + 1 MB
+    [[NSFileManager defaultManager] createFileAtPath:source contents:nil attributes:nil];
+    NSFileHandle *handle = [NSFileHandle fileHandleForWritingAtPath:source];
+    for (unsigned long long i = 0; i < chunks; i++) {
+        @autoreleasepool {
+            [handle writeData:chunk];
+        }
+    }
+    [handle closeFile];
+    __block NSError *error = nil;
+    [ZXCompressor compressFileAtPath:source toPath:file1 usingAlgorithm:kZXCAlgorithmHuffman completion:^(NSError *e) {
+        error = e;
+    }];
+    XCTAssertNil(error);
+    [ZXCompressor decompressFileAtPath:file1 toPath:file2 usingAlgorithm:kZXCAlgorithmHuffman completion:^(NSError *e) {
+        error = e;
+    }];
+    XCTAssertNil(error);
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:file2 error:nil];
+    XCTAssertEqual([attributes fileSize], chunk.length * chunks);
+    handle = [NSFileHandle fileHandleForReadingAtPath:file2];
+    for (unsigned long long i = 0; i < chunks; i++) {
+        @autoreleasepool {
+            XCTAssertTrue([[handle readDataOfLength:chunk.length] isEqualToData:chunk], @"chunk %llu", i);
+        }
+    }
+    [handle closeFile];
+    [[NSFileManager defaultManager] removeItemAtPath:source error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:file1 error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:file2 error:nil];
+}
+
+#pragma mark Fuzzing
+
+// libFuzzer style: mutate valid streams (flip, overwrite, insert, erase, truncate) and feed them to the decoders,
+// the decoders must neither crash nor hang, whatever they output.
+- (NSData *)mutateData:(NSData *)data {
+    NSMutableData *mutated = [data mutableCopy];
+    int mutations = 1 + rand() % 8;
+    for (int i = 0; i < mutations; i++) {
+        NSUInteger length = mutated.length;
+        unsigned char *bytes = mutated.mutableBytes;
+        switch (rand() % 5) {
+            case 0: // flip bit
+                if (length > 0) {
+                    bytes[rand() % length] ^= 1 << (rand() % 8);
+                }
+                break;
+            case 1: // overwrite byte
+                if (length > 0) {
+                    bytes[rand() % length] = (unsigned char)rand();
+                }
+                break;
+            case 2: // insert byte
+            {
+                unsigned char byte = (unsigned char)rand();
+                [mutated replaceBytesInRange:NSMakeRange(length > 0 ? rand() % length : 0, 0) withBytes:&byte length:1];
+                break;
+            }
+            case 3: // erase bytes
+                if (length > 0) {
+                    NSUInteger location = rand() % length;
+                    [mutated replaceBytesInRange:NSMakeRange(location, MIN(length - location, 1 + rand() % 16)) withBytes:NULL length:0];
+                }
+                break;
+            default: // truncate
+                if (length > 0) {
+                    mutated.length = rand() % length;
+                }
+                break;
+        }
+    }
+    return mutated;
+}
+
+- (void)testDecompressFuzz {
+    const int iterations = 500;
+    for (NSNumber *number in [self implementedAlgorithms]) {
+        ZXCAlgorithm algorithm = (ZXCAlgorithm)number.intValue;
+        NSMutableArray *corpus = [NSMutableArray array];
+        for (int pattern = 0; pattern < kSamplePatternCount; pattern++) {
+            NSData *data = [self sampleDataOfSize:3000 pattern:pattern seed:pattern];
+            [corpus addObject:[self compressData:data usingAlgorithm:algorithm]];
+        }
+        srand(algorithm);
+        for (int i = 0; i < iterations; i++) {
+            NSData *input = nil;
+            if (i % 10 == 0) {
+                input = [self sampleDataOfSize:rand() % 2048 pattern:kSamplePatternRandom seed:rand()];
+            } else {
+                input = [self mutateData:corpus[i % corpus.count]];
+            }
+            @autoreleasepool {
+                [self decompressData:input usingAlgorithm:algorithm];
+            }
+        }
+    }
+}
+
+- (void)testDecompressTruncated {
+    NSData *data = [self sampleDataOfSize:3000 pattern:kSamplePatternText seed:0];
+    // fixed-size phrases/codes, cutting one byte always leaves a partial one
+    for (NSNumber *number in @[@(kZXCAlgorithmLZ77), @(kZXCAlgorithmLZW)]) {
+        ZXCAlgorithm algorithm = (ZXCAlgorithm)number.intValue;
+        NSData *compressed = [self compressData:data usingAlgorithm:algorithm];
+        NSData *truncated = [compressed subdataWithRange:NSMakeRange(0, compressed.length - 1)];
+        XCTAssertNil([self decompressData:truncated usingAlgorithm:algorithm], @"[%@]", [self nameOfAlgorithm:algorithm]);
+    }
+    // block streams end with an end-of-stream block
+    for (NSNumber *number in @[@(kZXCAlgorithmHuffman), @(kZXCAlgorithmFSE), @(kZXCAlgorithmLZH)]) {
+        ZXCAlgorithm algorithm = (ZXCAlgorithm)number.intValue;
+        NSData *compressed = [self compressData:data usingAlgorithm:algorithm];
+        NSData *truncated = [compressed subdataWithRange:NSMakeRange(0, compressed.length / 2)];
+        XCTAssertNil([self decompressData:truncated usingAlgorithm:algorithm], @"[%@]", [self nameOfAlgorithm:algorithm]);
+        XCTAssertNil([self decompressData:[NSData data] usingAlgorithm:algorithm], @"[%@]", [self nameOfAlgorithm:algorithm]);
+    }
+}
+
+- (void)testDecompressCorrupted {
+    // LZ77: offset 0, length 5
+    const unsigned char lz77[] = {0x00, 0x05, 'a'};
+    XCTAssertNil([self decompressData:[NSData dataWithBytes:lz77 length:sizeof(lz77)] usingAlgorithm:kZXCAlgorithmLZ77]);
+    // LZSS: a phrase with offset 0, length 3
+    const unsigned char lzss[] = {0x00, 0x00, 0x00, 0x03};
+    XCTAssertNil([self decompressData:[NSData dataWithBytes:lzss length:sizeof(lzss)] usingAlgorithm:kZXCAlgorithmLZSS]);
+    // LZ78: code 5 is not in the dictionary yet
+    const unsigned char lz78[] = {0x00, 0x05, 'a'};
+    XCTAssertNil([self decompressData:[NSData dataWithBytes:lz78 length:sizeof(lz78)] usingAlgorithm:kZXCAlgorithmLZ78]);
+    // LZW: the first code must be a single byte
+    const unsigned char lzw[] = {0x12, 0x34};
+    XCTAssertNil([self decompressData:[NSData dataWithBytes:lzw length:sizeof(lzw)] usingAlgorithm:kZXCAlgorithmLZW]);
+    // Huffman: unknown stream format
+    NSData *data = [self sampleDataOfSize:3000 pattern:kSamplePatternText seed:0];
+    NSMutableData *huffman = [[self compressData:data usingAlgorithm:kZXCAlgorithmHuffman] mutableCopy];
+    ((unsigned char *)huffman.mutableBytes)[0] ^= 1;
+    XCTAssertNil([self decompressData:huffman usingAlgorithm:kZXCAlgorithmHuffman]);
+    // File API
+    NSString *source = [NSTemporaryDirectory() stringByAppendingPathComponent:@"zxc_corrupted.bin"];
+    NSString *target = [NSTemporaryDirectory() stringByAppendingPathComponent:@"zxc_corrupted.txt"];
+    [[NSData dataWithBytes:lz77 length:sizeof(lz77)] writeToFile:source atomically:YES];
+    __block NSError *error = nil;
+    [ZXCompressor decompressFileAtPath:source toPath:target usingAlgorithm:kZXCAlgorithmLZ77 completion:^(NSError *e) {
+        error = e;
+    }];
+    XCTAssertEqualObjects(error.domain, ZXCompressorErrorDomain);
+    XCTAssertEqual(error.code, kZXCErrorCorrupted);
+    [[NSFileManager defaultManager] removeItemAtPath:source error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:target error:nil];
+}
+
+- (void)testDecompressChecksum {
+    NSData *data = [self sampleDataOfSize:30000 pattern:kSamplePatternText seed:5];
+    NSMutableData *compressed = [[self compressData:data usingLZH:4096 threads:0] mutableCopy];
+    // the stream ends with the CRC-32C of the data, a flipped bit there decodes fine but does not match
+    ((unsigned char *)compressed.mutableBytes)[compressed.length - 2] ^= 0x01;
+    __block ZXCError error = kZXCErrorNone;
+    [ZXCompressor decompressUsingLZH:4096
+                          readBuffer:^const unsigned int(void *buffer, const unsigned int length, const unsigned long long offset) {
+                              unsigned int bufSize = offset < compressed.length ? (unsigned int)MIN(length, compressed.length - offset) : 0;
+                              memcpy(buffer, (const unsigned char *)compressed.bytes + offset, bufSize);
+                              return bufSize;
+                          } writeBuffer:^(const void *buffer, const unsigned int length) {
+                          } completion:^(ZXCError errorCode) {
+                              error = errorCode;
+                          }];
+    XCTAssertEqual(error, kZXCErrorChecksum);
+}
+
+#pragma mark Utils
+
+- (void)testMatchLength {
+    unsigned char a[256], b[256];
+    srand(0);
+    for (int i = 0; i < sizeof(a); i++) {
+        a[i] = b[i] = (unsigned char)rand();
+    }
+    // every mismatch position and every limit, crosses the 8/16/32 bytes boundaries
+    for (unsigned int mismatch = 0; mismatch <= sizeof(a); mismatch++) {
+        if (mismatch < sizeof(b)) {
+            b[mismatch] ^= 0x10;
+        }
+        for (unsigned int limit = 0; limit <= sizeof(a); limit++) {
+            XCTAssertEqual(match_length(a, b, limit), MIN(mismatch, limit), @"mismatch %u, limit %u", mismatch, limit);
+        }
+        if (mismatch < sizeof(b)) {
+            b[mismatch] ^= 0x10;
+        }
+    }
+}
+
+static int CPUTestKernelA(void) { return 'A'; }
+static int CPUTestKernelB(void) { return 'B'; }
+static int CPUTestKernelC(void) { return 'C'; }
+
+// fails for kernel A only
+static int CPUTestSelfTest(cpu_func func) {
+    return ((int (*)(void))func)() != 'A';
+}
+
+- (void)testCPUFeatures {
+    XCTAssertEqual(cpu_features_parse("sse2, AVX2,bmi2"), CPU_SSE2 | CPU_AVX2 | CPU_BMI2);
+    XCTAssertEqual(cpu_features_parse("sse4.2 avx512bw neon"), CPU_SSE42 | CPU_AVX512 | CPU_NEON);
+    XCTAssertEqual(cpu_features_parse("none"), 0);
+    XCTAssertEqual(cpu_features_parse(""), 0);
+    XCTAssertEqual(strcmp(cpu_feature_name(CPU_SSE42), "sse4.2"), 0);
+    XCTAssertTrue(cpu_supports(0));
+    XCTAssertTrue(cpu_supports(cpu_features()));
+    // the first supported kernel passing the self-test, the portable one is the fallback
+    const cpu_kernel kernels[] = {
+        {"a", 0, (cpu_func)CPUTestKernelA},
+        {"b", 0, (cpu_func)CPUTestKernelB},
+        {"c", 0, (cpu_func)CPUTestKernelC},
+    };
+    XCTAssertEqual(cpu_kernel_select(kernels, 3, CPUTestSelfTest), &kernels[1]);
+    XCTAssertEqual(cpu_kernel_select(kernels, 3, NULL), &kernels[0]);
+    XCTAssertEqual(cpu_kernel_select(&kernels[2], 1, CPUTestSelfTest), &kernels[2]);
+}
+
+// bit by bit reference
+static unsigned int CRC32CReference(unsigned int crc, const unsigned char *data, size_t length) {
+    crc = ~crc;
+    while (length--) {
+        crc ^= *data++;
+        for (int k = 0; k < 8; k++) {
+            crc = crc & 1 ? (crc >> 1) ^ 0x82F63B78 : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+- (void)testCRC32C {
+    XCTAssertEqual(crc32c_update(0, "123456789", 9), 0xE3069283);
+    XCTAssertEqual(crc32c_update(0, NULL, 0), 0);
+    NSData *data = [self sampleDataOfSize:100000 pattern:kSamplePatternRandom seed:9];
+    const unsigned char *bytes = data.bytes;
+    // chained updates equal one update over the whole data
+    unsigned int crc = 0;
+    for (size_t offset = 0; offset < data.length; offset += 777) {
+        crc = crc32c_update(crc, &bytes[offset], MIN(777, data.length - offset));
+    }
+    XCTAssertEqual(crc, crc32c_update(0, bytes, data.length));
+    XCTAssertEqual(crc, CRC32CReference(0, bytes, data.length));
+    // every alignment and the lengths around the 8 bytes and interleaved (3 x 256, 3 x 8192) steps
+    for (size_t offset = 0; offset < 16; offset++) {
+        for (size_t length = 0; length < 64; length++) {
+            XCTAssertEqual(crc32c_update(1, &bytes[offset], length), CRC32CReference(1, &bytes[offset], length));
+        }
+        for (NSNumber *length in @[@767, @768, @769, @24575, @24576, @24577, @50000]) {
+            XCTAssertEqual(crc32c_update(2, &bytes[offset], length.intValue), CRC32CReference(2, &bytes[offset], length.intValue));
+        }
+    }
+}
+
+- (void)testCodeTable {
+    code_table *table = code_table_new(8, CODE_TABLE_RESET);
+    XCTAssertTrue(table != NULL);
+    // the roots 'a', 'b', then "ab", "abb"
+    code_table_set(table, 0, CODE_TABLE_NONE, 'a', 1);
+    code_table_set(table, 1, CODE_TABLE_NONE, 'b', 1);
+    code_table_seal(table, 2);
+    XCTAssertEqual(code_table_find(table, 0, 'b'), CODE_TABLE_NONE);
+    code_table_add(table, 0, 'b');
+    code_table_add(table, 2, 'b');
+    XCTAssertEqual(code_table_find(table, 0, 'b'), 2);
+    XCTAssertEqual(code_table_find(table, 2, 'b'), 3);
+    XCTAssertEqual(table->length[3], 3);
+    unsigned char string[4];
+    code_table_string(table, 3, string);
+    XCTAssertEqual(memcmp(string, "abb", 3), 0);
+    // a reset drops the added codes only
+    for (int i = 0; i < 4; i++) {
+        code_table_add(table, 3 + i, 'a');
+    }
+    XCTAssertEqual(table->next, 8);
+    XCTAssertTrue(code_table_full(table));
+    code_table_reset(table);
+    XCTAssertEqual(table->next, 2);
+    XCTAssertEqual(code_table_find(table, 0, 'b'), CODE_TABLE_NONE);
+    code_table_add(table, 1, 'a');
+    XCTAssertEqual(code_table_find(table, 1, 'a'), 2);
+    code_table_free(table);
+    // a copy of a sealed table finds the primed codes, and the copies are independent
+    table = code_table_new(8, CODE_TABLE_RESET);
+    code_table_set(table, 0, CODE_TABLE_NONE, 'a', 1);
+    code_table_set(table, 1, CODE_TABLE_NONE, 'b', 1);
+    code_table_set(table, 2, 0, 'b', 2);
+    code_table_seal(table, 3);
+    code_table *copy = code_table_copy(table);
+    XCTAssertEqual(copy->next, 3);
+    XCTAssertEqual(code_table_find(copy, 0, 'b'), 2);
+    code_table_add(copy, 2, 'a');
+    XCTAssertEqual(code_table_find(copy, 2, 'a'), 3);
+    XCTAssertEqual(code_table_find(table, 2, 'a'), CODE_TABLE_NONE);
+    code_table_reset(copy);
+    XCTAssertEqual(code_table_find(copy, 0, 'b'), 2);
+    XCTAssertEqual(code_table_find(copy, 2, 'a'), CODE_TABLE_NONE);
+    code_table_free(copy);
+    code_table_free(table);
+    // the monitor keeps the table while the ratio rises, both sides count the same
+    table = code_table_new(1024, CODE_TABLE_MONITOR);
+    code_table_seal(table, 0);
+    XCTAssertFalse(code_table_full(table));
+    code_table_count(table, table->gap, table->gap / 2);
+    XCTAssertFalse(code_table_full(table));
+    code_table_count(table, table->gap, table->gap / 8);
+    XCTAssertFalse(code_table_full(table));
+    code_table_count(table, table->gap, table->gap * 2);
+    XCTAssertTrue(code_table_full(table));
+    code_table_free(table);
+}
+
+- (void)testRollingHash {
+    unsigned char bytes[64];
+    srand(0);
+    for (int i = 0; i < sizeof(bytes); i++) {
+        bytes[i] = (unsigned char)rand();
+    }
+    // the 4-byte steps of hash_bytes equal the byte by byte rolling
+    unsigned int hash = 0;
+    for (unsigned int length = 0; length <= sizeof(bytes); length++) {
+        XCTAssertEqual(hash_bytes(bytes, length), hash, @"%u bytes", length);
+        if (length < sizeof(bytes)) {
+            hash = hash_roll(hash, bytes[length]);
+        }
+    }
+    // leading zeros count
+    XCTAssertNotEqual(hash_bytes("\0", 1), hash_bytes("\0\0", 2));
+    XCTAssertEqual(hash_index(hash, 0), 0);
+    XCTAssertLessThan(hash_index(hash, 12), 1 << 12);
+    // the table finds the keys by the rolling hash of a growing prefix
+    hashtable *table = hashtable_new(100);
+    XCTAssertEqual(table->bits, 7);
+    hash = 0;
+    for (int i = 0; i < 50; i++) {
+        hash = hash_roll(hash, bytes[i]);
+        hashtable_set_node_hash(table, bytes, i + 1, hash, &i, sizeof(i));
+    }
+    for (int i = 0; i < 50; i++) {
+        hashnode *node = hashtable_get_node(table, bytes, i + 1);
+        XCTAssertTrue(node && *(int *)node->value->data == i);
+    }
+    XCTAssertEqual(table->used, 50);
+    hashtable_free(table);
+}
+
+// the average probes of a lookup in a table of 1 << bits buckets with as many keys, ~1.5 for a uniform hash
+static double HashProbes(unsigned int (^hash)(const void *key, unsigned int length), const unsigned int bits, const unsigned char *keys, const unsigned int keySize) {
+    const unsigned int size = 1 << bits;
+    unsigned int *counts = calloc(size, sizeof(unsigned int));
+    for (unsigned int i = 0; i < size; i++) {
+        counts[hash(&keys[i * keySize], keySize) & (size - 1)]++;
+    }
+    double probes = 0;
+    for (unsigned int i = 0; i < size; i++) {
+        probes += counts[i] * (counts[i] + 1) / 2.0;
+    }
+    free(counts);
+    return probes / size;
+}
+
+// The sequential codes of the LZW/LZ78 decoders are the worst keys for simple_hash with a power-of-two mask
+- (void)testHashCollisions {
+    const unsigned int bits = 16, keySize = 2;
+    unsigned char *codes = malloc((1 << bits) * keySize);
+    for (unsigned int i = 0; i < 1 << bits; i++) {
+        memcpy(&codes[i * keySize], &i, keySize);
+    }
+    double simple = HashProbes(^unsigned int(const void *key, unsigned int length) {
+        return simple_hash(key, length);
+    }, bits, codes, keySize);
+    double rolling = HashProbes(^unsigned int(const void *key, unsigned int length) {
+        return hash_index(hash_bytes(key, length), bits);
+    }, bits, codes, keySize);
+    NSLog(@"probes of %u codes: simple_hash %.3f, hash_bytes %.3f", 1 << bits, simple, rolling);
+    XCTAssertLessThan(rolling, 1.6);
+    XCTAssertLessThan(rolling, simple);
+    free(codes);
+}
+
+- (void)testPerformanceSimpleHash {
+    NSData *data = [self sampleDataOfSize:1 << 20 pattern:kSamplePatternText seed:0];
+    __block unsigned int sum = 0;
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i + 8 <= data.length; i += 8) {
+            sum += simple_hash((const char *)data.bytes + i, 8);
+        }
+    }];
+}
+
+- (void)testPerformanceRollingHash {
+    NSData *data = [self sampleDataOfSize:1 << 20 pattern:kSamplePatternText seed:0];
+    __block unsigned int sum = 0;
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i + 8 <= data.length; i += 8) {
+            sum += hash_bytes((const char *)data.bytes + i, 8);
+        }
+    }];
+}
+
+- (void)testHistogram {
+    for (int pattern = 0; pattern < kSamplePatternCount; pattern++) {
+        for (NSUInteger size = 0; size < 4096; size = size * 2 + 1) {
+            NSData *data = [self sampleDataOfSize:size pattern:pattern seed:(unsigned int)size];
+            const unsigned char *bytes = data.bytes;
+            unsigned int counts[HISTOGRAM_SIZE], expected[HISTOGRAM_SIZE] = {0};
+            for (NSUInteger i = 0; i < size; i++) {
+                expected[bytes[i]]++;
+            }
+            histogram_count(bytes, (unsigned int)size, counts);
+            XCTAssertEqual(memcmp(counts, expected, sizeof(counts)), 0, @"%d bytes", (int)size);
+        }
+    }
+}
+
+- (void)testHuffmanCodeLengths {
+    unsigned int weights[256] = {0};
+    unsigned char lengths[256];
+    // Fibonacci weights make the deepest tree, the lengths are limited
+    for (int i = 0, a = 1, b = 1; i < 30; i++, b = a + b, a = b - a) {
+        weights[i] = a;
+    }
+    XCTAssertEqual(huffman_code_lengths(weights, lengths, 256, HUFFMAN_MAX_BITS), HUFFMAN_MAX_BITS);
+    unsigned int kraft = 0;
+    for (int i = 0; i < 256; i++) {
+        XCTAssertEqual(lengths[i] > 0, weights[i] > 0);
+        kraft += lengths[i] ? 1 << (HUFFMAN_MAX_BITS - lengths[i]) : 0;
+    }
+    XCTAssertEqual(kraft, 1 << HUFFMAN_MAX_BITS);
+    // one symbol, no symbol
+    memset(weights, 0, sizeof(weights));
+    XCTAssertEqual(huffman_code_lengths(weights, lengths, 256, HUFFMAN_MAX_BITS), 0);
+    weights['a'] = 10;
+    XCTAssertEqual(huffman_code_lengths(weights, lengths, 256, HUFFMAN_MAX_BITS), 1);
+    XCTAssertEqual(lengths['a'], 1);
+}
+
+- (void)testPerformanceHuffmanCodeLengths {
+    unsigned int weights[256];
+    unsigned char lengths[256];
+    srand(0);
+    for (int i = 0; i < 256; i++) {
+        weights[i] = 1 + rand() % 65536;
+    }
     [self measureBlock:^{
-        // Put the code you want to measure the time of here.
+        for (int i = 0; i < 10000; i++) {
+            huffman_code_lengths(weights, lengths, 256, HUFFMAN_MAX_BITS);
+        }
     }];
 }
 
+#pragma mark Dictionary
+
+- (NSArray<NSData *> *)dictionarySamples {
+    NSMutableArray *samples = [NSMutableArray array];
+    for (unsigned int i = 0; i < 64; i++) {
+        [samples addObject:[self sampleDataOfSize:512 + i * 8 pattern:kSamplePatternText seed:1000 + i]];
+    }
+    return samples;
+}
+
+- (void)testDictionary {
+    ZXCDictionary *dictionary = [ZXCDictionary dictionaryWithSamples:[self dictionarySamples] size:4096];
+    XCTAssertNotNil(dictionary);
+    XCTAssertTrue(dictionary.data.length > 0 && dictionary.data.length <= 4096);
+    XCTAssertNotEqual(dictionary.identifier, 0);
+    XCTAssertNil([ZXCDictionary dictionaryWithSamples:@[] size:4096]);
+    // smaller than one segment, the last bytes of the samples are used
+    for (NSNumber *size in @[@1, @32, @63, @64]) {
+        ZXCDictionary *small = [ZXCDictionary dictionaryWithSamples:@[[self sampleDataOfSize:100 pattern:kSamplePatternText seed:1], [self sampleDataOfSize:100 pattern:kSamplePatternText seed:2]] size:size.unsignedIntegerValue];
+        XCTAssertNotNil(small, @"size %@", size);
+        XCTAssertTrue(small.data.length > 0 && small.data.length <= size.unsignedIntegerValue, @"size %@", size);
+    }
+    ZXCDictionary *other = [[ZXCDictionary alloc] initWithData:dictionary.data identifier:dictionary.identifier + 1];
+    const NSUInteger sizes[] = {0, 1, 100, 1000, 4096, 65536};
+    for (NSNumber *number in [self implementedAlgorithms]) {
+        ZXCAlgorithm algorithm = (ZXCAlgorithm)number.intValue;
+        NSString *name = [self nameOfAlgorithm:algorithm];
+        for (int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            for (int pattern = 0; pattern < kSamplePatternCount; pattern++) {
+                NSData *data = [self sampleDataOfSize:sizes[i] pattern:pattern seed:i];
+                __block NSData *compressed = nil;
+                __block NSData *decompressed = nil;
+                [ZXCompressor compressData:data usingAlgorithm:algorithm dictionary:dictionary completion:^(NSData *data) {
+                    compressed = data;
+                }];
+                // the same dictionary is reused, the primed table snapshot is shared
+                [ZXCompressor decompressData:compressed usingAlgorithm:algorithm dictionary:dictionary completion:^(NSData *data) {
+                    decompressed = data;
+                }];
+                XCTAssertTrue([decompressed isEqualToData:data], @"[%@] round trip of %d bytes", name, (int)data.length);
+                // another dictionary, or no dictionary
+                if (algorithm != kZXCAlgorithmHuffman && algorithm != kZXCAlgorithmFSE && algorithm != kZXCAlgorithmLZH) {
+                    [ZXCompressor decompressData:compressed usingAlgorithm:algorithm dictionary:other completion:^(NSData *data) {
+                        decompressed = data;
+                    }];
+                    XCTAssertNil(decompressed, @"[%@] dictionary mismatch", name);
+                }
+            }
+        }
+    }
+}
+
+- (void)testDictionaryRatio {
+    ZXCDictionary *dictionary = [ZXCDictionary dictionaryWithSamples:[self dictionarySamples] size:4096];
+    NSData *data = [self sampleDataOfSize:1024 pattern:kSamplePatternText seed:0];
+    for (NSNumber *number in @[@(kZXCAlgorithmLZ77), @(kZXCAlgorithmLZSS), @(kZXCAlgorithmLZ78), @(kZXCAlgorithmLZW)]) {
+        ZXCAlgorithm algorithm = (ZXCAlgorithm)number.intValue;
+        __block NSData *compressed = nil;
+        [ZXCompressor compressData:data usingAlgorithm:algorithm dictionary:dictionary completion:^(NSData *data) {
+            compressed = data;
+        }];
+        NSData *plain = [self compressData:data usingAlgorithm:algorithm];
+        NSLog(@"[%@] %d bytes -> %d bytes, %d bytes with dictionary", [self nameOfAlgorithm:algorithm], (int)data.length, (int)plain.length, (int)compressed.length);
+        XCTAssertLessThan(compressed.length, plain.length, @"[%@]", [self nameOfAlgorithm:algorithm]);
+    }
+}
+
+#pragma mark Performance
+
+- (void)measureAlgorithm:(ZXCAlgorithm)algorithm {
+    NSData *data = [self sampleDataOfSize:1 << 20 pattern:kSamplePatternText seed:0];
+    [self measureBlock:^{
+        NSDate *date = [NSDate date];
+        NSData *compressed = [self compressData:data usingAlgorithm:algorithm];
+        NSTimeInterval compressTime = -[date timeIntervalSinceNow];
+        date = [NSDate date];
+        [self decompressData:compressed usingAlgorithm:algorithm];
+        NSTimeInterval decompressTime = -[date timeIntervalSinceNow];
+        NSLog(@"[%@] %d -> %d bytes, compress %.1f MB/s, decompress %.1f MB/s", [self nameOfAlgorithm:algorithm], (int)data.length, (int)compressed.length, data.length / compressTime / 1e6, data.length / decompressTime / 1e6);
+    }];
+}
+
+- (void)testPerformanceLZ77 {
+    [self measureAlgorithm:kZXCAlgorithmLZ77];
+}
+
+- (void)testPerformanceLZSS {
+    [self measureAlgorithm:kZXCAlgorithmLZSS];
+}
+
+- (void)testPerformanceLZ78 {
+    [self measureAlgorithm:kZXCAlgorithmLZ78];
+}
+
+- (void)testPerformanceLZW {
+    [self measureAlgorithm:kZXCAlgorithmLZW];
+}
+
+- (void)testPerformanceHuffman {
+    [self measureAlgorithm:kZXCAlgorithmHuffman];
+}
+
+- (void)testPerformanceFSE {
+    [self measureAlgorithm:kZXCAlgorithmFSE];
+}
+
+- (void)testPerformanceLZH {
+    [self measureAlgorithm:kZXCAlgorithmLZH];
+}
+
 @end